@@ -0,0 +1,81 @@
+//
+// Renderer Benchmark - Times OpenGLRenderer's CPU side against the null GL backend
+// Needs no window or GPU, so it runs on headless CI workers
+//
+// Usage: RendererBenchmark [objects] [frames] [batch]
+//   batch: enable dynamic batching
+//
+
+#include "../GraphicsEngine.h"
+#include "../Engine/Rendering/Core/gl_recorder.h"
+#include <chrono>
+#include <cstdlib>
+
+int main(int argc, char** argv)
+{
+    int objectCount = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int frameCount = argc > 2 ? std::atoi(argv[2]) : 100;
+    bool dynamicBatching = argc > 3 && std::string(argv[3]) == "batch";
+
+    GLRecorder recorder;
+    recorder.install();
+
+    OpenGLRenderer renderer;
+    if (!renderer.initialize())
+    {
+        std::cerr << "Failed to initialize renderer!" << std::endl;
+        return 1;
+    }
+    renderer.setDynamicBatching(dynamicBatching);
+
+    // A few meshes and materials so batching has something to sort
+    std::vector<std::shared_ptr<Mesh>> meshes = {
+        Mesh::createCube(1.0f), Mesh::createSphere(0.5f, 2), Mesh::createPlane(1.0f, 1.0f)
+    };
+    std::vector<std::shared_ptr<Material>> materials = {
+        BuiltinMaterials::createStandard(), BuiltinMaterials::createUnlit(), BuiltinMaterials::createStandardSpecular()
+    };
+
+    std::vector<mat4> models;
+    models.reserve(objectCount);
+    for (int i = 0; i < objectCount; i++)
+        models.push_back(mat4::translation(vec3((i % 100) * 2.0f, 0.0f, -(i / 100) * 2.0f)));
+
+    Camera camera(vec3(0, 10, 20), vec3(0, 0, 0));
+    std::vector<Light> lights = { Light::directional(vec3(-1, -1, -1), color(1, 1, 1), 0.8f) };
+
+    // Warm-up frame uploads the meshes, so the timed frames measure steady state
+    auto renderFrame = [&]() {
+        renderer.beginFrame(camera, lights);
+        for (int i = 0; i < objectCount; i++)
+            renderer.submit(*meshes[i % meshes.size()], models[i], materials[(i / 7) % materials.size()].get());
+        renderer.flush();
+    };
+    renderFrame();
+    recorder.resetCounters();
+
+    double flushMs = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < frameCount; frame++)
+    {
+        renderer.beginFrame(camera, lights);
+        for (int i = 0; i < objectCount; i++)
+            renderer.submit(*meshes[i % meshes.size()], models[i], materials[(i / 7) % materials.size()].get());
+
+        auto flushStart = std::chrono::high_resolution_clock::now();
+        renderer.flush();
+        flushMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - flushStart).count();
+    }
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "\n" << objectCount << " objects, " << frameCount << " frames"
+              << (dynamicBatching ? ", dynamic batching" : "") << std::endl;
+    std::cout << "  frame: " << totalMs / frameCount << " ms, flush: " << flushMs / frameCount << " ms" << std::endl;
+    std::cout << "  per frame: " << recorder.getTotalCalls() / frameCount << " GL calls, "
+              << recorder.getDrawCallCount() / frameCount << " draws, "
+              << recorder.getRedundantCount() / frameCount << " redundant" << std::endl;
+    std::cout << "\n" << recorder.getSummary();
+
+    renderer.cleanup();
+    return 0;
+}
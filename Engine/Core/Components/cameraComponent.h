@@ -4,6 +4,7 @@
 #include "behaviour.h"
 #include "../../Math/vec3.h"
 #include "../../Math/mat4.h"
+#include "../../Math/bounds.h"
 #include "../../Rendering/camera.h"
 #include <memory>
 
@@ -170,6 +171,19 @@ public:
         return vec3(worldX, worldY, worldZ);
     }
 
+    /**
+     * @brief Ray from the near plane through a screen point
+     * @param screenX, screenY Pixel coordinates ((0,0) is top-left)
+     * @param screenWidth, screenHeight Viewport size in pixels
+     * @return Ray with a normalized direction, starting on the near plane
+     */
+    Ray screenPointToRay(float screenX, float screenY, float screenWidth, float screenHeight) const
+    {
+        vec3 nearPoint = screenToWorldPoint(vec3(screenX, screenY, 0.0f), screenWidth, screenHeight);
+        vec3 farPoint = screenToWorldPoint(vec3(screenX, screenY, 1.0f), screenWidth, screenHeight);
+        return Ray(nearPoint, (farPoint - nearPoint).normalized());
+    }
+
     /**
      * @brief Convert world coordinates to screen space
      * @param worldPoint World space position
@@ -0,0 +1,127 @@
+#ifndef ENGINE_LIGHT_COMPONENT_H
+#define ENGINE_LIGHT_COMPONENT_H
+
+#include "behaviour.h"
+#include "../gameObject.h"
+#include "../../Math/vec3.h"
+#include "../../Math/bounds.h"
+#include "../../Rendering/light.h"
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @class LightComponent
+ * @brief Light attached to a GameObject
+ *
+ * Point and spot lights sit at the transform's world position and spot and
+ * directional lights shine along its forward axis. The scene keeps local
+ * lights in a spatial index (Scene::updateSpatialIndex), so each renderer
+ * is only lit by the few lights that reach it (Scene::getObjectLights).
+ *
+ * Example:
+ * @code
+ * auto* lamp = scene.createGameObject("Lamp");
+ * lamp->transform.setLocalPosition(vec3(0, 3, 0));
+ * auto* light = lamp->addComponent<LightComponent>();
+ * light->setType(Light::Type::Point);
+ * light->setRange(8.0f);
+ * @endcode
+ */
+class LightComponent : public Behaviour
+{
+    friend class Scene;  // Assigns sceneIndex
+
+private:
+    Light::Type type;
+    color lightColor;
+    float intensity;
+    float range;
+    float spotAngle;            // Full cone angle in radians
+    uint64_t settingsVersion;   // Bumped by the setters
+    int sceneIndex;             // Position in the scene's light list (-1 = not registered)
+
+public:
+    LightComponent()
+        : Behaviour(),
+          type(Light::Type::Point),
+          lightColor(1, 1, 1),
+          intensity(1.0f),
+          range(10.0f),
+          spotAngle(45.0f * 3.14159f / 180.0f),
+          settingsVersion(0),
+          sceneIndex(-1)
+    {
+    }
+
+    // Setters
+
+    void setType(Light::Type value) { type = value; settingsVersion++; }
+    void setColor(const color& value) { lightColor = value; settingsVersion++; }
+    void setIntensity(float value) { intensity = value; settingsVersion++; }
+    void setRange(float value) { range = std::max(value, 0.0f); settingsVersion++; }
+
+    /**
+     * Set the full cone angle of a spot light, in degrees
+     */
+    void setSpotAngle(float degrees) { spotAngle = degrees * 3.14159f / 180.0f; settingsVersion++; }
+
+    // Getters
+
+    Light::Type getType() const { return type; }
+    const color& getColor() const { return lightColor; }
+    float getIntensity() const { return intensity; }
+    float getRange() const { return range; }
+    float getSpotAngle() const { return spotAngle; }  // Radians
+
+    /**
+     * Whether the light only reaches objects within its range
+     */
+    bool isLocal() const { return type != Light::Type::Directional; }
+
+    /**
+     * Whether the light currently shines (enabled on an active GameObject)
+     */
+    bool isLit() const { return enabled && gameObject && gameObject->isActive(); }
+
+    /**
+     * @brief Change counter: bumped when the settings or the transform change
+     */
+    uint64_t getVersion() const
+    {
+        return settingsVersion + (gameObject ? gameObject->transform.getVersion() : 0);
+    }
+
+    /**
+     * @brief World-space light for rendering
+     */
+    Light getLight() const
+    {
+        Light light;
+        light.type = type;
+        light.position = gameObject ? gameObject->transform.getWorldPosition() : vec3::zero;
+        light.direction = gameObject ? gameObject->transform.forward() : vec3(0, 0, 1);
+        light.color = lightColor;
+        light.intensity = intensity;
+        light.range = range;
+        light.spotAngle = spotAngle;
+        return light;
+    }
+
+    /**
+     * @brief Box around everything the light reaches (invalid for directional lights)
+     */
+    AABB getInfluenceBounds() const
+    {
+        if (!isLocal())
+            return AABB();
+        vec3 position = gameObject ? gameObject->transform.getWorldPosition() : vec3::zero;
+        return AABB::fromCenterExtents(position, vec3(range, range, range));
+    }
+
+    /**
+     * @brief Index into the scene's component lights (-1 while not registered)
+     */
+    int getSceneIndex() const { return sceneIndex; }
+};
+
+#endif //ENGINE_LIGHT_COMPONENT_H
@@ -4,7 +4,16 @@
 #include "component.h"
 #include "meshFilter.h"
 #include "../../Rendering/Materials/material.h"
+#include "../../Rendering/Materials/materialPropertyBlock.h"
+#include "../../Rendering/Primitives/meshSimplifier.h"
+#include "../../Rendering/camera.h"
+#include "../../Rendering/light.h"
+#include "../../Math/bounds.h"
+#include <cmath>
 #include <memory>
+#include <vector>
+
+class LightComponent;
 
 /**
  * @class MeshRenderer
@@ -15,18 +24,55 @@
  */
 class MeshRenderer : public Component
 {
+public:
+    /**
+     * @brief One level of detail: used while the object covers at least
+     * screenHeight of the viewport height (levels go finest to coarsest)
+     */
+    struct LODLevel
+    {
+        std::shared_ptr<Mesh> mesh;
+        float screenHeight;
+    };
+
+    /**
+     * @brief Lights picked for this renderer by Scene::getObjectLights
+     * Kept until the object moves or a light near it changes.
+     */
+    struct LightCache
+    {
+        const LightComponent* lights[LightSet::MAX_LIGHTS] = {};
+        int count = 0;
+        int capacity = -1;            // Lights the pick was made for (-1 = never picked)
+        AABB bounds;                  // World bounds the pick was made for
+        uint64_t transformVersion = 0;
+        uint64_t meshID = 0;
+        uint64_t meshVersion = 0;
+        uint64_t lightVersion = 0;    // Scene::getLightVersion() at the last check
+    };
+
 private:
     std::shared_ptr<Material> materialInstance;
+    std::shared_ptr<const MaterialPropertyBlock> propertyBlock;  // Immutable; replaced on set
     bool castShadows;
     bool receiveShadows;
     bool enabled;
+    bool occluder;
+    std::shared_ptr<Mesh> occluderMesh;
+    std::vector<LODLevel> lods;
+    float lodHysteresis;
+    size_t currentLOD;
+    LightCache lightCache;
 
 public:
     MeshRenderer()
         : materialInstance(nullptr),
           castShadows(true),
           receiveShadows(true),
-          enabled(true)
+          enabled(true),
+          occluder(false),
+          lodHysteresis(0.1f),
+          currentLOD(0)
     {
     }
 
@@ -62,6 +108,45 @@ public:
         return materialInstance != nullptr;
     }
 
+    /**
+     * Override material values for this renderer only (the block is copied)
+     * The material stays shared, so this keeps batching where clone() breaks it.
+     * An empty block removes the overrides.
+     */
+    void setPropertyBlock(const MaterialPropertyBlock& block)
+    {
+        if (block.isEmpty())
+            propertyBlock.reset();
+        else
+            propertyBlock = std::make_shared<const MaterialPropertyBlock>(block);
+    }
+
+    /**
+     * Current overrides (nullptr if none); safe to hold across frames
+     */
+    std::shared_ptr<const MaterialPropertyBlock> getPropertyBlock() const
+    {
+        return propertyBlock;
+    }
+
+    /**
+     * Get raw property block pointer (for rendering; nullptr if none)
+     */
+    const MaterialPropertyBlock* getPropertyBlockPtr() const
+    {
+        return propertyBlock.get();
+    }
+
+    bool hasPropertyBlock() const
+    {
+        return propertyBlock != nullptr;
+    }
+
+    void clearPropertyBlock()
+    {
+        propertyBlock.reset();
+    }
+
     /**
      * Enable/disable rendering
      */
@@ -101,6 +186,126 @@ public:
         return receiveShadows;
     }
 
+    /**
+     * Mark this object as an occluder for software occlusion culling
+     * @param value Whether it hides objects behind it
+     * @param proxy Optional simplified mesh (must lie inside the rendered
+     *        mesh); the rendered mesh is used when null
+     */
+    void setOccluder(bool value, std::shared_ptr<Mesh> proxy = nullptr)
+    {
+        occluder = value;
+        occluderMesh = proxy;
+    }
+
+    bool isOccluder() const
+    {
+        return occluder;
+    }
+
+    /**
+     * Get the mesh to rasterize as an occluder (nullptr if none)
+     */
+    const Mesh* getOccluderMesh() const
+    {
+        if (occluderMesh)
+            return occluderMesh.get();
+        auto meshFilter = gameObject ? gameObject->getComponent<MeshFilter>() : nullptr;
+        return meshFilter ? meshFilter->getMeshPtr() : nullptr;
+    }
+
+    /**
+     * Set the LOD chain (finest first, screenHeight thresholds descending)
+     * An empty list renders the MeshFilter mesh at all distances.
+     */
+    void setLODs(const std::vector<LODLevel>& levels)
+    {
+        lods = levels;
+        currentLOD = 0;
+    }
+
+    const std::vector<LODLevel>& getLODs() const
+    {
+        return lods;
+    }
+
+    /**
+     * Build LODs from the MeshFilter mesh with MeshSimplifier
+     * Level i is used down to 0.5^(i+1) of the screen height; the coarsest
+     * level has no lower limit.
+     * @param levelCount Maximum number of levels including the original
+     * @param reduction Triangle ratio between consecutive levels
+     */
+    void generateLODs(int levelCount = 4, float reduction = 0.5f)
+    {
+        auto meshFilter = gameObject ? gameObject->getComponent<MeshFilter>() : nullptr;
+        if (!meshFilter || !meshFilter->hasMesh())
+            return;
+
+        auto chain = MeshSimplifier::buildLODChain(meshFilter->getMesh(), levelCount, reduction);
+        std::vector<LODLevel> levels;
+        float threshold = 0.5f;
+        for (size_t i = 0; i < chain.size(); i++)
+        {
+            levels.push_back({ chain[i], i + 1 < chain.size() ? threshold : 0.0f });
+            threshold *= 0.5f;
+        }
+        setLODs(levels);
+    }
+
+    /**
+     * Relative band around each threshold where the current LOD is kept,
+     * so objects hovering at a switch distance don't pop every frame
+     */
+    void setLODHysteresis(float value)
+    {
+        lodHysteresis = value;
+    }
+
+    size_t getCurrentLOD() const
+    {
+        return currentLOD;
+    }
+
+    /**
+     * Pick the mesh to draw for a camera from the projected screen height
+     * of the world bounding sphere (updates the current LOD)
+     * @return Mesh to render (the MeshFilter mesh if there are no LODs)
+     */
+    std::shared_ptr<Mesh> selectLOD(const Camera& camera)
+    {
+        if (lods.empty())
+        {
+            auto meshFilter = gameObject ? gameObject->getComponent<MeshFilter>() : nullptr;
+            return meshFilter ? meshFilter->getMesh() : nullptr;
+        }
+
+        float screenHeight = FLT_MAX;
+        BoundingSphere sphere = getWorldBoundingSphere();
+        if (sphere.isValid())
+        {
+            float distance = (sphere.center - camera.position).length();
+            float halfHeight = distance * std::tan(camera.fieldOfView * 0.5f);
+            if (halfHeight > 1e-6f)
+                screenHeight = sphere.radius / halfHeight;
+        }
+
+        currentLOD = std::min(currentLOD, lods.size() - 1);
+        while (currentLOD > 0 && screenHeight >= lods[currentLOD - 1].screenHeight * (1.0f + lodHysteresis))
+            currentLOD--;
+        while (currentLOD + 1 < lods.size() && screenHeight < lods[currentLOD].screenHeight * (1.0f - lodHysteresis))
+            currentLOD++;
+        return lods[currentLOD].mesh;
+    }
+
+    /**
+     * Light selection cache, maintained by Scene::getObjectLights
+     */
+    LightCache& getLightCache()
+    {
+        return lightCache;
+    }
+
     /**
      * Check if this renderer can render
      * (has MeshFilter with mesh and is enabled)
@@ -113,6 +318,37 @@ public:
         auto meshFilter = gameObject->getComponent<MeshFilter>();
         return meshFilter && meshFilter->hasMesh();
     }
+
+    /**
+     * Get world-space AABB (mesh bounds transformed by the GameObject's transform)
+     * Invalid (empty) if there is no mesh to render.
+     */
+    AABB getWorldBounds() const
+    {
+        if (!gameObject)
+            return AABB();
+
+        auto meshFilter = gameObject->getComponent<MeshFilter>();
+        if (!meshFilter || !meshFilter->hasMesh())
+            return AABB();
+
+        return meshFilter->getMeshPtr()->getBounds().transformed(gameObject->transform.getWorldMatrix());
+    }
+
+    /**
+     * Get world-space bounding sphere
+     */
+    BoundingSphere getWorldBoundingSphere() const
+    {
+        if (!gameObject)
+            return BoundingSphere();
+
+        auto meshFilter = gameObject->getComponent<MeshFilter>();
+        if (!meshFilter || !meshFilter->hasMesh())
+            return BoundingSphere();
+
+        return meshFilter->getMeshPtr()->getBoundingSphere().transformed(gameObject->transform.getWorldMatrix());
+    }
 };
 
 #endif //MESHRENDERER_H
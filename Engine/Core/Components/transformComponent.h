@@ -4,6 +4,7 @@
 #include "component.h"
 #include "../../Math/vec3.h"
 #include "../../Math/mat4.h"
+#include <cstdint>
 #include <vector>
 #include <algorithm>
 
@@ -33,16 +34,16 @@ private:
     mutable vec3 cachedWorldScale;
     mutable mat4 cachedWorldMatrix;
     mutable bool worldCacheDirty;
+    uint64_t version;  // Bumped on every change to this or an ancestor transform
 
     void markDirty()
     {
         isDirty = true;
         worldCacheDirty = true;
-        // Propagate dirty flag to all children
+        version++;
+        // Propagate to the whole subtree so every descendant's version moves
         for (auto* child : children) {
-            if (!child->isDirty) {  // Only propagate if child isn't already dirty
-                child->markDirty();
-            }
+            child->markDirty();
         }
     }
 
@@ -93,7 +94,8 @@ public:
           worldCacheDirty(true),
           localPosition(vec3::zero),
           localRotation(vec3::zero),
-          localScale(vec3::one)
+          localScale(vec3::one),
+          version(0)
     {
     }
 
@@ -103,7 +105,8 @@ public:
           worldCacheDirty(true),
           localPosition(pos),
           localRotation(rot),
-          localScale(scl)
+          localScale(scl),
+          version(0)
     {
     }
 
@@ -242,6 +245,12 @@ public:
 
     // Convenience Methods
 
+    /**
+     * @brief Change counter, incremented whenever this transform or an ancestor changes
+     * Lets caches (e.g. the scene's spatial index) detect movement cheaply.
+     */
+    uint64_t getVersion() const { return version; }
+
     /**
      * @brief Get model matrix (for rendering)
      */
@@ -0,0 +1,617 @@
+#ifndef DYNAMIC_BVH_H
+#define DYNAMIC_BVH_H
+
+#include "../../Math/vec3.h"
+#include "../../Math/bounds.h"
+#include "../../Math/frustum.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <queue>
+#include <utility>
+#include <vector>
+
+/**
+ * @class DynamicBVH
+ * @brief Incrementally updated AABB tree for spatial queries
+ *
+ * Every proxy is a leaf holding a "fat" box (the tight box grown by a
+ * margin), so small movements don't touch the tree at all. Leaves are
+ * inserted next to the sibling that minimizes total surface area (found
+ * by branch and bound), and AVL-style rotations keep the tree balanced,
+ * giving O(log n) insert, remove and query.
+ *
+ * Queries report proxy IDs whose fat box passes the test; callers refine
+ * against exact bounds if they need to. Not thread-safe for concurrent
+ * modification; concurrent const queries are fine.
+ *
+ * Example:
+ * @code
+ * DynamicBVH tree;
+ * int id = tree.createProxy(object.getWorldBounds(), &object);
+ * tree.moveProxy(id, object.getWorldBounds());
+ * tree.query(frustum, [&](int proxy) {
+ *     draw(tree.getUserData(proxy));
+ *     return true;  // Keep going
+ * });
+ * @endcode
+ */
+class DynamicBVH
+{
+public:
+    static constexpr int NULL_NODE = -1;
+
+    explicit DynamicBVH(float fatMargin = 0.1f)
+        : root(NULL_NODE), freeList(NULL_NODE), proxyCount(0), margin(fatMargin)
+    {
+    }
+
+    /**
+     * @brief Insert a box
+     * @param box Tight world-space bounds
+     * @param userData Opaque pointer returned by getUserData()
+     * @return Proxy ID (stable until destroyProxy)
+     */
+    int createProxy(const AABB& box, void* userData)
+    {
+        int leaf = allocateNode();
+        nodes[leaf].box = fatten(box);
+        nodes[leaf].userData = userData;
+        nodes[leaf].height = 0;
+        insertLeaf(leaf);
+        proxyCount++;
+        return leaf;
+    }
+
+    /**
+     * @brief Remove a proxy
+     */
+    void destroyProxy(int proxyId)
+    {
+        removeLeaf(proxyId);
+        freeNode(proxyId);
+        proxyCount--;
+    }
+
+    /**
+     * @brief Update a proxy's bounds
+     * Nothing changes while the new box stays inside the fat box. Otherwise
+     * the leaf is reinserted with a fresh margin.
+     * @return true if the tree was modified
+     */
+    bool moveProxy(int proxyId, const AABB& box)
+    {
+        if (nodes[proxyId].box.contains(box))
+        {
+            // Re-fatten if the object shrank a lot, so stale huge boxes don't linger
+            vec3 fat = nodes[proxyId].box.getSize();
+            vec3 grown = box.getSize() + vec3(margin, margin, margin) * 4.0f;
+            if (fat.x <= grown.x && fat.y <= grown.y && fat.z <= grown.z)
+                return false;
+        }
+
+        removeLeaf(proxyId);
+        nodes[proxyId].box = fatten(box);
+        insertLeaf(proxyId);
+        return true;
+    }
+
+    void* getUserData(int proxyId) const { return nodes[proxyId].userData; }
+    const AABB& getFatBounds(int proxyId) const { return nodes[proxyId].box; }
+    size_t getProxyCount() const { return proxyCount; }
+    int getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+    /**
+     * @brief Box around every proxy's fat bounds (invalid when empty)
+     */
+    AABB getBounds() const { return root == NULL_NODE ? AABB() : nodes[root].box; }
+
+    /**
+     * @brief Remove every proxy
+     */
+    void clear()
+    {
+        nodes.clear();
+        root = NULL_NODE;
+        freeList = NULL_NODE;
+        proxyCount = 0;
+    }
+
+    /**
+     * @brief Visit proxies whose fat box overlaps a box
+     * @param callback bool(int proxyId); return false to stop
+     */
+    template<typename Callback>
+    void query(const AABB& box, Callback&& callback) const
+    {
+        NodeStack stack;
+        stack.push(root);
+        while (!stack.empty())
+        {
+            int id = stack.pop();
+            if (id == NULL_NODE) continue;
+            const Node& node = nodes[id];
+            if (!node.box.intersects(box)) continue;
+
+            if (node.isLeaf())
+            {
+                if (!callback(id)) return;
+            }
+            else
+            {
+                stack.push(node.child1);
+                stack.push(node.child2);
+            }
+        }
+    }
+
+    /**
+     * @brief Visit proxies whose fat box intersects a frustum
+     * Subtrees fully inside are reported without further plane tests.
+     * @param callback bool(int proxyId); return false to stop
+     */
+    template<typename Callback>
+    void query(const Frustum& frustum, Callback&& callback) const
+    {
+        NodeStack stack;
+        stack.push(root);
+        while (!stack.empty())
+        {
+            int id = stack.pop();
+            if (id == NULL_NODE) continue;
+            const Node& node = nodes[id];
+
+            Frustum::Containment containment = frustum.classify(node.box);
+            if (containment == Frustum::Containment::Outside) continue;
+            if (containment == Frustum::Containment::Inside)
+            {
+                if (!reportSubtree(id, callback)) return;
+                continue;
+            }
+
+            if (node.isLeaf())
+            {
+                if (!callback(id)) return;
+            }
+            else
+            {
+                stack.push(node.child1);
+                stack.push(node.child2);
+            }
+        }
+    }
+
+    /**
+     * @brief Visit proxies whose fat box a ray passes through, nearest boxes first
+     * @param ray Ray to cast (direction need not be normalized; distances are in t)
+     * @param maxDistance Ignore boxes beyond this t
+     * @param callback float(int proxyId, float currentMax); return the new
+     *        max distance: currentMax to continue, a hit t to clip the ray,
+     *        or 0 to stop
+     */
+    template<typename Callback>
+    void raycast(const Ray& ray, float maxDistance, Callback&& callback) const
+    {
+        if (root == NULL_NODE) return;
+
+        vec3 invDirection = ray.inverseDirection();
+        float entry;
+        if (!nodes[root].box.intersectRay(ray.origin, invDirection, maxDistance, entry))
+            return;
+
+        // Entries are (entry t, node); popped nearest-first within each branch
+        std::vector<std::pair<float, int>> stack;
+        stack.reserve(64);
+        stack.emplace_back(entry, root);
+
+        while (!stack.empty())
+        {
+            auto [nodeEntry, id] = stack.back();
+            stack.pop_back();
+            if (nodeEntry > maxDistance) continue;
+
+            const Node& node = nodes[id];
+            if (node.isLeaf())
+            {
+                float value = callback(id, maxDistance);
+                if (value <= 0.0f) return;
+                maxDistance = std::min(maxDistance, value);
+                continue;
+            }
+
+            float entry1, entry2;
+            bool hit1 = nodes[node.child1].box.intersectRay(ray.origin, invDirection, maxDistance, entry1);
+            bool hit2 = nodes[node.child2].box.intersectRay(ray.origin, invDirection, maxDistance, entry2);
+
+            // Push the farther child first so the nearer one is processed next
+            if (hit1 && hit2)
+            {
+                if (entry1 <= entry2)
+                {
+                    stack.emplace_back(entry2, node.child2);
+                    stack.emplace_back(entry1, node.child1);
+                }
+                else
+                {
+                    stack.emplace_back(entry1, node.child1);
+                    stack.emplace_back(entry2, node.child2);
+                }
+            }
+            else if (hit1)
+            {
+                stack.emplace_back(entry1, node.child1);
+            }
+            else if (hit2)
+            {
+                stack.emplace_back(entry2, node.child2);
+            }
+        }
+    }
+
+    /**
+     * @brief Find the k proxies whose fat boxes are nearest a point
+     * @param point Query point
+     * @param k Maximum number of results
+     * @param results Receives proxy IDs, nearest first (cleared first)
+     * @param maxDistance Ignore proxies farther than this
+     */
+    void queryNearest(const vec3& point, size_t k, std::vector<int>& results,
+                      float maxDistance = FLT_MAX) const
+    {
+        results.clear();
+        if (root == NULL_NODE || k == 0) return;
+
+        float maxDistanceSq = maxDistance < FLT_MAX ? maxDistance * maxDistance : FLT_MAX;
+
+        // Best-first search: min-heap on box distance
+        using Entry = std::pair<float, int>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        open.emplace(nodes[root].box.distanceSquared(point), root);
+
+        while (!open.empty() && results.size() < k)
+        {
+            auto [distanceSq, id] = open.top();
+            open.pop();
+            if (distanceSq > maxDistanceSq) break;
+
+            const Node& node = nodes[id];
+            if (node.isLeaf())
+            {
+                results.push_back(id);
+                continue;
+            }
+            open.emplace(nodes[node.child1].box.distanceSquared(point), node.child1);
+            open.emplace(nodes[node.child2].box.distanceSquared(point), node.child2);
+        }
+    }
+
+    /**
+     * @brief Sum of internal node areas divided by root area (tree quality, lower is better)
+     */
+    float getAreaRatio() const
+    {
+        if (root == NULL_NODE) return 0.0f;
+        float rootArea = nodes[root].box.getSurfaceArea();
+        if (rootArea <= 0.0f) return 0.0f;
+
+        float total = 0.0f;
+        for (const auto& node : nodes)
+        {
+            if (node.height > 0)
+                total += node.box.getSurfaceArea();
+        }
+        return total / rootArea;
+    }
+
+private:
+    struct Node
+    {
+        AABB box;
+        void* userData;
+        int parent;     // Next free node when on the free list
+        int child1;
+        int child2;
+        int height;     // 0 = leaf, -1 = free
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    /**
+     * @brief Traversal stack with inline storage (no allocation for typical depths)
+     */
+    class NodeStack
+    {
+    public:
+        void push(int id)
+        {
+            if (count < INLINE_CAPACITY)
+                inlineItems[count] = id;
+            else
+                overflow.push_back(id);
+            count++;
+        }
+
+        int pop()
+        {
+            count--;
+            if (count < INLINE_CAPACITY)
+                return inlineItems[count];
+            int id = overflow.back();
+            overflow.pop_back();
+            return id;
+        }
+
+        bool empty() const { return count == 0; }
+
+    private:
+        static constexpr size_t INLINE_CAPACITY = 64;
+        int inlineItems[INLINE_CAPACITY];
+        std::vector<int> overflow;
+        size_t count = 0;
+    };
+
+    std::vector<Node> nodes;
+    int root;
+    int freeList;
+    size_t proxyCount;
+    float margin;
+
+    AABB fatten(const AABB& box) const
+    {
+        vec3 m(margin, margin, margin);
+        return AABB(box.min - m, box.max + m);
+    }
+
+    int allocateNode()
+    {
+        int id;
+        if (freeList != NULL_NODE)
+        {
+            id = freeList;
+            freeList = nodes[id].parent;
+        }
+        else
+        {
+            id = static_cast<int>(nodes.size());
+            nodes.emplace_back();
+        }
+
+        Node& node = nodes[id];
+        node.box = AABB();
+        node.userData = nullptr;
+        node.parent = NULL_NODE;
+        node.child1 = NULL_NODE;
+        node.child2 = NULL_NODE;
+        node.height = 0;
+        return id;
+    }
+
+    void freeNode(int id)
+    {
+        nodes[id].parent = freeList;
+        nodes[id].height = -1;
+        freeList = id;
+    }
+
+    template<typename Callback>
+    bool reportSubtree(int start, Callback& callback) const
+    {
+        NodeStack stack;
+        stack.push(start);
+        while (!stack.empty())
+        {
+            int id = stack.pop();
+            const Node& node = nodes[id];
+            if (node.isLeaf())
+            {
+                if (!callback(id)) return false;
+            }
+            else
+            {
+                stack.push(node.child1);
+                stack.push(node.child2);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Insert a leaf next to the sibling with the lowest surface-area cost
+     */
+    void insertLeaf(int leaf)
+    {
+        if (root == NULL_NODE)
+        {
+            root = leaf;
+            nodes[root].parent = NULL_NODE;
+            return;
+        }
+
+        // Branch and bound search for the sibling with the lowest total cost:
+        // area of the new parent plus the growth of every ancestor's box
+        AABB leafBox = nodes[leaf].box;
+        float leafArea = leafBox.getSurfaceArea();
+        int bestSibling = root;
+        float bestCost = AABB::merge(nodes[root].box, leafBox).getSurfaceArea();
+
+        // (inherited cost from ancestors, node)
+        using Candidate = std::pair<float, int>;
+        std::vector<Candidate> candidates;
+        candidates.reserve(64);
+        candidates.emplace_back(0.0f, root);
+
+        while (!candidates.empty())
+        {
+            auto [inherited, index] = candidates.back();
+            candidates.pop_back();
+
+            const Node& node = nodes[index];
+            float combinedArea = AABB::merge(node.box, leafBox).getSurfaceArea();
+            float cost = combinedArea + inherited;
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestSibling = index;
+            }
+
+            // Any sibling below this node pays at least the leaf's own area
+            // plus this node's growth
+            float childInherited = inherited + (combinedArea - node.box.getSurfaceArea());
+            if (!node.isLeaf() && leafArea + childInherited < bestCost)
+            {
+                candidates.emplace_back(childInherited, node.child1);
+                candidates.emplace_back(childInherited, node.child2);
+            }
+        }
+        int index = bestSibling;
+
+        // Create a new parent joining the sibling and the leaf
+        int sibling = index;
+        int oldParent = nodes[sibling].parent;
+        int newParent = allocateNode();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].box = AABB::merge(leafBox, nodes[sibling].box);
+        nodes[newParent].height = nodes[sibling].height + 1;
+        nodes[newParent].child1 = sibling;
+        nodes[newParent].child2 = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+
+        if (oldParent != NULL_NODE)
+        {
+            if (nodes[oldParent].child1 == sibling)
+                nodes[oldParent].child1 = newParent;
+            else
+                nodes[oldParent].child2 = newParent;
+        }
+        else
+        {
+            root = newParent;
+        }
+
+        refitAncestors(nodes[leaf].parent);
+    }
+
+    void removeLeaf(int leaf)
+    {
+        if (leaf == root)
+        {
+            root = NULL_NODE;
+            return;
+        }
+
+        int parent = nodes[leaf].parent;
+        int grandParent = nodes[parent].parent;
+        int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+        if (grandParent != NULL_NODE)
+        {
+            // Replace the parent with the sibling
+            if (nodes[grandParent].child1 == parent)
+                nodes[grandParent].child1 = sibling;
+            else
+                nodes[grandParent].child2 = sibling;
+            nodes[sibling].parent = grandParent;
+            freeNode(parent);
+            refitAncestors(grandParent);
+        }
+        else
+        {
+            root = sibling;
+            nodes[sibling].parent = NULL_NODE;
+            freeNode(parent);
+        }
+    }
+
+    /**
+     * @brief Walk to the root fixing heights and boxes, rebalancing on the way
+     */
+    void refitAncestors(int index)
+    {
+        while (index != NULL_NODE)
+        {
+            index = balance(index);
+
+            int child1 = nodes[index].child1;
+            int child2 = nodes[index].child2;
+            nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+            nodes[index].box = AABB::merge(nodes[child1].box, nodes[child2].box);
+
+            index = nodes[index].parent;
+        }
+    }
+
+    /**
+     * @brief Rotate node A up or down if its subtrees differ in height by more than one
+     * @return Index of the node now at A's position
+     */
+    int balance(int iA)
+    {
+        Node& A = nodes[iA];
+        if (A.isLeaf() || A.height < 2)
+            return iA;
+
+        int iB = A.child1;
+        int iC = A.child2;
+        int delta = nodes[iC].height - nodes[iB].height;
+
+        if (delta > 1)
+            return rotateUp(iA, iC, iB, false);
+        if (delta < -1)
+            return rotateUp(iA, iB, iC, true);
+        return iA;
+    }
+
+    /**
+     * @brief Promote child iUp of iA above it; iA takes iUp's shorter child
+     * @param iA Unbalanced node
+     * @param iUp Taller child of A (becomes the subtree root)
+     * @param iOther A's other child (stays under A)
+     * @param upIsChild1 Whether iUp is A.child1
+     */
+    int rotateUp(int iA, int iUp, int iOther, bool upIsChild1)
+    {
+        Node& A = nodes[iA];
+        Node& U = nodes[iUp];
+        int iF = U.child1;
+        int iG = U.child2;
+        Node& F = nodes[iF];
+        Node& G = nodes[iG];
+
+        // U takes A's place
+        U.child1 = iA;
+        U.parent = A.parent;
+        A.parent = iUp;
+
+        if (U.parent != NULL_NODE)
+        {
+            if (nodes[U.parent].child1 == iA)
+                nodes[U.parent].child1 = iUp;
+            else
+                nodes[U.parent].child2 = iUp;
+        }
+        else
+        {
+            root = iUp;
+        }
+
+        // The taller of U's children stays with U, the shorter moves under A
+        int iKeep = F.height > G.height ? iF : iG;
+        int iMove = iKeep == iF ? iG : iF;
+        U.child2 = iKeep;
+        if (upIsChild1)
+            A.child1 = iMove;
+        else
+            A.child2 = iMove;
+        nodes[iMove].parent = iA;
+
+        A.box = AABB::merge(nodes[iOther].box, nodes[iMove].box);
+        U.box = AABB::merge(A.box, nodes[iKeep].box);
+        A.height = 1 + std::max(nodes[iOther].height, nodes[iMove].height);
+        U.height = 1 + std::max(A.height, nodes[iKeep].height);
+
+        return iUp;
+    }
+};
+
+#endif // DYNAMIC_BVH_H
@@ -0,0 +1,167 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class JobSystem
+ * @brief Singleton pool of worker threads for data-parallel loops
+ *
+ * Workers are created once and sleep until work arrives, so parallelFor
+ * is cheap enough to call every frame. The calling thread helps drain
+ * the queue while it waits, which also makes nested parallelFor calls
+ * safe (a waiting worker keeps executing other jobs).
+ *
+ * Example:
+ * @code
+ * JobSystem::getInstance().parallelFor(vertices.size(), 4096,
+ *     [&](size_t begin, size_t end) {
+ *         for (size_t i = begin; i < end; i++) process(vertices[i]);
+ *     });
+ * @endcode
+ */
+class JobSystem
+{
+public:
+    static JobSystem& getInstance()
+    {
+        static JobSystem instance;
+        return instance;
+    }
+
+    /**
+     * @brief Threads that execute jobs (workers + the calling thread)
+     */
+    size_t getThreadCount() const { return workers.size() + 1; }
+
+    /**
+     * @brief Split [0, count) into batches and run them across all threads
+     * @param count Number of items
+     * @param minBatch Smallest batch worth sending to another thread
+     * @param fn Callable invoked as fn(begin, end) for each batch
+     *
+     * Runs inline when the range is too small to split. Returns once
+     * every batch has finished.
+     */
+    template<typename Fn>
+    void parallelFor(size_t count, size_t minBatch, Fn&& fn)
+    {
+        if (count == 0)
+            return;
+
+        minBatch = std::max<size_t>(minBatch, 1);
+        size_t maxBatches = getThreadCount() * 4;  // Oversplit a little for load balance
+        size_t batches = std::min(maxBatches, (count + minBatch - 1) / minBatch);
+
+        if (batches <= 1 || workers.empty())
+        {
+            fn(size_t(0), count);
+            return;
+        }
+
+        size_t batchSize = (count + batches - 1) / batches;
+        std::atomic<size_t> remaining(batches);
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            for (size_t b = 0; b < batches; b++)
+            {
+                size_t begin = b * batchSize;
+                size_t end = std::min(count, begin + batchSize);
+                jobs.emplace_back([&fn, &remaining, begin, end]() {
+                    if (begin < end)
+                        fn(begin, end);
+                    remaining.fetch_sub(1, std::memory_order_acq_rel);
+                });
+            }
+        }
+        queueSignal.notify_all();
+
+        // Help out until our batches are done
+        while (remaining.load(std::memory_order_acquire) > 0)
+        {
+            if (!runOneJob())
+                std::this_thread::yield();
+        }
+    }
+
+    // Non-copyable
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex queueMutex;
+    std::condition_variable queueSignal;
+    bool stopping;
+
+    JobSystem()
+        : stopping(false)
+    {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        size_t workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+        workers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; i++)
+        {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueSignal.notify_all();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Pop and execute one queued job
+     * @return false if the queue was empty
+     */
+    bool runOneJob()
+    {
+        std::function<void()> job;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (jobs.empty())
+                return false;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+        return true;
+    }
+
+    void workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueSignal.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty())
+                    return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+};
+
+#endif // JOB_SYSTEM_H
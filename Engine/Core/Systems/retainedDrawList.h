@@ -0,0 +1,470 @@
+#ifndef RETAINED_DRAW_LIST_H
+#define RETAINED_DRAW_LIST_H
+
+#include "sceneView.h"
+#include "../scene.h"
+#include "../Components/meshRenderer.h"
+#include "../Components/meshFilter.h"
+#include "../../Math/frustum.h"
+#include "../../Rendering/Core/render_backend.h"
+#include "../../Rendering/Core/render_command.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class RetainedDrawList
+ * @brief Persistent, sorted draw list that is only patched where the scene changed
+ *
+ * SceneView records, sorts and copies a command for every visible renderer
+ * each frame. This list instead keeps one render proxy per MeshRenderer and
+ * one command per proxy, sorted by state across frames, and hands the list
+ * to the backend in place (RenderBackend::submitRetained):
+ * - a moved object (TransformComponent version changed) only has its
+ *   matrix rewritten in its command
+ * - a changed mesh, LOD, material shader, property block or enabled state
+ *   queues the proxy for reinsertion; queued proxies are sorted and merged
+ *   into the list in one pass
+ * - objects leaving or entering the view have their command's mesh cleared
+ *   or restored (the flush skips null meshes); the order is untouched
+ * - each visible command's lights come from Scene::getObjectLights, which
+ *   is cached per renderer
+ * - the scene is rescanned for new or removed renderers only when
+ *   Scene::getStructureVersion() changes
+ *
+ * Proxies are visited only while visible, so steady-state work follows the
+ * visible set and the number of changes rather than the scene size. Sort
+ * keys ignore depth, so movement never reorders the list. Culling uses the
+ * spatial index's fattened bounds; occlusion culling is not applied.
+ *
+ * Example:
+ * @code
+ * RetainedDrawList drawList;
+ * // Each frame, after scene.updateSpatialIndex():
+ * drawList.render(scene, renderer, camera, scene.backgroundColor);
+ * @endcode
+ */
+class RetainedDrawList
+{
+private:
+    static constexpr size_t NO_SLOT = SIZE_MAX;
+
+    struct Proxy
+    {
+        GameObject* object;                       // nullptr = free
+        MeshRenderer* renderer;
+        MeshFilter* meshFilter;
+        const Mesh* mesh;                         // Drawn mesh (LOD-selected), nullptr if not drawable
+        uint64_t meshID;
+        Material* material;
+        uint64_t materialVersion;
+        const MaterialPropertyBlock* properties;
+        LightSet lights;                          // From Scene::getObjectLights
+        bool receiveShadows;                      // MeshRenderer::getReceiveShadows()
+        uint64_t transformVersion;                // Of the matrix in its command
+        uint64_t sortKey;
+        size_t slot;                              // Index of its command, NO_SLOT if none
+        uint64_t seenStamp;                       // Last rescan that found it
+        uint64_t visibleFrame;                    // Last frame it passed culling
+        bool visible;                             // Its command has the mesh set
+        bool pending;                             // Queued for insertion
+    };
+
+    std::vector<Proxy> proxies;
+    std::vector<uint32_t> freeProxies;
+    std::unordered_map<GameObject*, uint32_t> objectProxies;
+
+    // The retained list: sorted commands and the proxy owning each one
+    std::vector<RenderCommand> commands;
+    std::vector<uint32_t> commandProxies;
+    std::vector<uint32_t> pendingInserts;
+    bool hasStaleCommands;                        // Entries whose proxy left the list
+
+    // Scratch, kept between frames
+    std::vector<RenderCommand> mergedCommands;
+    std::vector<uint32_t> mergedProxies;
+    std::vector<GameObject*> candidates;
+    std::vector<uint32_t> visibleProxies;
+    std::vector<uint32_t> previousVisible;
+    std::vector<Light> lights;
+
+    uint64_t syncedStructure;
+    bool scanned;
+    uint64_t frame;
+
+    // Work done by the last render(), for profiling
+    size_t transformUpdates;
+    size_t stateChanges;
+    size_t visibilityChanges;
+    size_t visibleCount;
+
+    /**
+     * Point the proxy's command (if any) at its mesh or hide it
+     */
+    void setVisible(Proxy& proxy, bool visible)
+    {
+        proxy.visible = visible;
+        if (proxy.slot != NO_SLOT)
+            commands[proxy.slot].mesh = visible ? proxy.mesh : nullptr;
+    }
+
+    /**
+     * Hide the proxy's command and drop it at the next repair
+     */
+    void unlink(Proxy& proxy)
+    {
+        if (proxy.slot == NO_SLOT)
+            return;
+        commands[proxy.slot].mesh = nullptr;
+        proxy.slot = NO_SLOT;
+        hasStaleCommands = true;
+    }
+
+    void queueInsert(uint32_t id)
+    {
+        Proxy& proxy = proxies[id];
+        if (!proxy.pending)
+        {
+            proxy.pending = true;
+            pendingInserts.push_back(id);
+        }
+    }
+
+    void removeProxy(uint32_t id)
+    {
+        Proxy& proxy = proxies[id];
+        unlink(proxy);
+        objectProxies.erase(proxy.object);
+        proxy.object = nullptr;
+        proxy.pending = false;
+        freeProxies.push_back(id);
+    }
+
+    /**
+     * Find renderers added or removed since the last scan
+     */
+    void rescan(Scene& scene)
+    {
+        uint64_t stamp = ++frame;
+        for (auto* obj : scene.getAllGameObjects())
+        {
+            auto* meshRenderer = obj->getComponent<MeshRenderer>();
+            auto* meshFilter = obj->getComponent<MeshFilter>();
+            if (!meshRenderer || !meshFilter)
+                continue;
+
+            auto it = objectProxies.find(obj);
+            if (it != objectProxies.end())
+            {
+                Proxy& existing = proxies[it->second];
+                if (existing.renderer == meshRenderer && existing.meshFilter == meshFilter)
+                {
+                    existing.seenStamp = stamp;
+                    continue;
+                }
+                removeProxy(it->second);  // Components were replaced
+            }
+
+            uint32_t id;
+            if (!freeProxies.empty())
+            {
+                id = freeProxies.back();
+                freeProxies.pop_back();
+            }
+            else
+            {
+                id = static_cast<uint32_t>(proxies.size());
+                proxies.emplace_back();
+            }
+
+            Proxy& proxy = proxies[id];
+            proxy.object = obj;
+            proxy.renderer = meshRenderer;
+            proxy.meshFilter = meshFilter;
+            proxy.mesh = nullptr;
+            proxy.meshID = 0;
+            proxy.material = nullptr;
+            proxy.materialVersion = 0;
+            proxy.properties = nullptr;
+            proxy.lights = LightSet();
+            proxy.receiveShadows = true;
+            proxy.transformVersion = 0;
+            proxy.sortKey = 0;
+            proxy.slot = NO_SLOT;
+            proxy.seenStamp = stamp;
+            proxy.visibleFrame = 0;
+            proxy.visible = false;
+            proxy.pending = false;
+            objectProxies[obj] = id;
+        }
+
+        for (uint32_t id = 0; id < proxies.size(); id++)
+        {
+            if (proxies[id].object && proxies[id].seenStamp != stamp)
+                removeProxy(id);
+        }
+
+        syncedStructure = scene.getStructureVersion();
+        scanned = true;
+    }
+
+    /**
+     * Bring a visible proxy's command up to date with its renderer
+     */
+    void refresh(uint32_t id, const Scene& scene, const Camera& camera)
+    {
+        Proxy& proxy = proxies[id];
+        MeshRenderer* meshRenderer = proxy.renderer;
+
+        const Mesh* mesh = nullptr;
+        if (proxy.object->isActive() && meshRenderer->isEnabled())
+        {
+            mesh = meshRenderer->getLODs().empty() ? proxy.meshFilter->getMeshPtr()
+                                                   : meshRenderer->selectLOD(camera).get();
+        }
+        Material* material = meshRenderer->getMaterialPtr();
+        const MaterialPropertyBlock* properties = meshRenderer->getPropertyBlockPtr();
+        uint64_t meshID = mesh ? mesh->getID() : 0;
+        uint64_t materialVersion = material ? material->getVersion() : 0;
+
+        if (mesh != proxy.mesh || meshID != proxy.meshID || material != proxy.material ||
+            materialVersion != proxy.materialVersion || properties != proxy.properties)
+        {
+            // A material edit only matters to the order if it swapped the shader
+            uint64_t sortKey = RenderCommand::generateSortKey(mesh, material);
+            bool reorder = !mesh || proxy.slot == NO_SLOT || sortKey != proxy.sortKey;
+
+            proxy.mesh = mesh;
+            proxy.meshID = meshID;
+            proxy.material = material;
+            proxy.materialVersion = materialVersion;
+            proxy.properties = properties;
+            proxy.sortKey = sortKey;
+            stateChanges++;
+
+            if (reorder)
+            {
+                unlink(proxy);
+                if (mesh)
+                    queueInsert(id);
+            }
+            else
+            {
+                RenderCommand& cmd = commands[proxy.slot];
+                cmd.mesh = proxy.visible ? mesh : nullptr;
+                cmd.material = material;
+                cmd.properties = properties;
+            }
+        }
+
+        // Cached by the renderer, so this is only version checks unless lights moved
+        proxy.lights = scene.getObjectLights(*meshRenderer);
+        proxy.receiveShadows = meshRenderer->getReceiveShadows();
+        if (proxy.slot != NO_SLOT)
+        {
+            commands[proxy.slot].lights = proxy.lights;
+            commands[proxy.slot].receiveShadows = proxy.receiveShadows;
+        }
+
+        uint64_t transformVersion = proxy.object->transform.getVersion();
+        if (proxy.slot != NO_SLOT && transformVersion != proxy.transformVersion)
+        {
+            commands[proxy.slot].modelMatrix = proxy.object->transform.getModelMatrix();
+            proxy.transformVersion = transformVersion;
+            transformUpdates++;
+        }
+    }
+
+    /**
+     * Drop stale commands and merge queued proxies into the sorted list
+     * Linear in the list size, and only runs on frames with such changes.
+     */
+    void repair()
+    {
+        if (!hasStaleCommands && pendingInserts.empty())
+            return;
+
+        // Compact in place; a command is live if its proxy still points at it
+        size_t kept = 0;
+        for (size_t i = 0; i < commands.size(); i++)
+        {
+            uint32_t id = commandProxies[i];
+            if (proxies[id].slot != i)
+                continue;
+            commands[kept] = commands[i];
+            commandProxies[kept] = id;
+            proxies[id].slot = kept;
+            kept++;
+        }
+        commands.resize(kept);
+        commandProxies.resize(kept);
+        hasStaleCommands = false;
+
+        if (pendingInserts.empty())
+            return;
+
+        std::sort(pendingInserts.begin(), pendingInserts.end(), [this](uint32_t a, uint32_t b) {
+            return proxies[a].sortKey < proxies[b].sortKey;
+        });
+
+        mergedCommands.clear();
+        mergedProxies.clear();
+        mergedCommands.reserve(commands.size() + pendingInserts.size());
+        mergedProxies.reserve(commands.size() + pendingInserts.size());
+
+        auto emit = [this](const RenderCommand& cmd, uint32_t id) {
+            proxies[id].slot = mergedCommands.size();
+            mergedCommands.push_back(cmd);
+            mergedProxies.push_back(id);
+        };
+        auto emitPending = [&](uint32_t id) {
+            Proxy& proxy = proxies[id];
+            if (!proxy.object || !proxy.pending || !proxy.mesh)
+                return;
+            proxy.pending = false;
+            proxy.transformVersion = proxy.object->transform.getVersion();
+            RenderCommand cmd = RenderCommand::create(proxy.mesh, proxy.material,
+                proxy.object->transform.getModelMatrix(), proxy.properties);
+            cmd.sortKey = proxy.sortKey;
+            cmd.lights = proxy.lights;
+            cmd.receiveShadows = proxy.receiveShadows;
+            if (!proxy.visible)
+                cmd.mesh = nullptr;
+            emit(cmd, id);
+        };
+
+        size_t next = 0;
+        for (size_t i = 0; i < commands.size(); i++)
+        {
+            while (next < pendingInserts.size() && proxies[pendingInserts[next]].sortKey < commands[i].sortKey)
+                emitPending(pendingInserts[next++]);
+            emit(commands[i], commandProxies[i]);
+        }
+        while (next < pendingInserts.size())
+            emitPending(pendingInserts[next++]);
+        pendingInserts.clear();
+
+        commands.swap(mergedCommands);
+        commandProxies.swap(mergedProxies);
+    }
+
+public:
+    RetainedDrawList()
+        : hasStaleCommands(false), syncedStructure(0), scanned(false), frame(0),
+          transformUpdates(0), stateChanges(0), visibilityChanges(0), visibleCount(0)
+    {
+    }
+
+    /**
+     * @brief Bring the list up to date for a camera
+     * @param scene Scene whose spatial index is up to date (updateSpatialIndex)
+     */
+    void sync(Scene& scene, const Camera& camera)
+    {
+        transformUpdates = 0;
+        stateChanges = 0;
+        visibilityChanges = 0;
+        visibleCount = 0;
+
+        if (!scanned || scene.getStructureVersion() != syncedStructure)
+            rescan(scene);
+        frame++;
+
+        Frustum frustum = Frustum::fromMatrix(camera.getViewProjectionMatrix());
+        candidates.clear();
+        scene.queryFrustum(frustum, candidates);
+
+        visibleProxies.clear();
+        for (auto* obj : candidates)
+        {
+            auto it = objectProxies.find(obj);
+            if (it == objectProxies.end())
+                continue;
+
+            // Drawn = in view and drawable (a disabled renderer has no mesh)
+            uint32_t id = it->second;
+            bool wasDrawn = proxies[id].visible && proxies[id].mesh;
+            refresh(id, scene, camera);
+            Proxy& proxy = proxies[id];
+            proxy.visibleFrame = frame;
+            visibleProxies.push_back(id);
+            if (!proxy.visible)
+                setVisible(proxy, true);
+
+            bool drawn = proxy.mesh != nullptr;
+            if (drawn)
+                visibleCount++;
+            if (drawn != wasDrawn)
+                visibilityChanges++;
+        }
+
+        for (uint32_t id : previousVisible)
+        {
+            Proxy& proxy = proxies[id];
+            if (proxy.object && proxy.visible && proxy.visibleFrame != frame)
+            {
+                if (proxy.mesh)
+                    visibilityChanges++;
+                setVisible(proxy, false);
+            }
+        }
+        previousVisible.swap(visibleProxies);
+
+        repair();
+    }
+
+    /**
+     * @brief Sync and draw one frame on a backend
+     * Lights come from the scene as in SceneView.
+     */
+    void render(Scene& scene, RenderBackend& backend, const Camera& camera, const color& clearColor)
+    {
+        sync(scene, camera);
+        SceneView::collectLights(scene, lights);
+
+        backend.beginFrame(camera, lights);
+        backend.submitRetained(commands);
+        backend.clear(clearColor);
+        backend.flush();
+    }
+
+    /**
+     * @brief Forget all proxies (the next sync rescans the scene)
+     */
+    void clear()
+    {
+        proxies.clear();
+        freeProxies.clear();
+        objectProxies.clear();
+        commands.clear();
+        commandProxies.clear();
+        pendingInserts.clear();
+        previousVisible.clear();
+        hasStaleCommands = false;
+        scanned = false;
+    }
+
+    /**
+     * @brief The sorted list; hidden entries have a null mesh
+     */
+    const std::vector<RenderCommand>& getCommands() const { return commands; }
+
+    size_t getProxyCount() const { return objectProxies.size(); }
+
+    /**
+     * @brief Renderers drawn by the last sync (in view, active and enabled)
+     */
+    size_t getVisibleCount() const { return visibleCount; }
+
+    size_t getTransformUpdateCount() const { return transformUpdates; }
+    size_t getStateChangeCount() const { return stateChanges; }
+
+    /**
+     * @brief Renderers that started or stopped being drawn in the last sync
+     * (entering/leaving the view, or enabled/disabled while in view)
+     */
+    size_t getVisibilityChangeCount() const { return visibilityChanges; }
+};
+
+#endif // RETAINED_DRAW_LIST_H
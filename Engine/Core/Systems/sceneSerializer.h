@@ -4,6 +4,7 @@
 #include "../scene.h"
 #include "../Components/meshFilter.h"
 #include "../Components/meshRenderer.h"
+#include "../Components/lightComponent.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -16,9 +17,11 @@
  * 
  * Simple text-based format for scene serialization.
  * Format:
- * - GameObject lines: GO <name> <active>
+ * - GameObject lines: GO <name> <active> [static]
  * - Transform lines: TR <posX> <posY> <posZ> <rotX> <rotY> <rotZ> <scaleX> <scaleY> <scaleZ>
  * - Mesh lines: MESH <type> [params]
+ * - Light lines: LIGHT <type> <r> <g> <b> <intensity> <range> <spotAngleDegrees>
+ *   (type: 0 directional, 1 point, 2 spot)
  */
 class SceneSerializer
 {
@@ -43,7 +46,8 @@ public:
 
         // Save all game objects
         for (const auto* obj : scene.getAllGameObjects()) {
-            file << "GO " << obj->name << " " << (obj->isActive() ? "1" : "0") << "\n";
+            file << "GO " << obj->name << " " << (obj->isActive() ? "1" : "0")
+                 << " " << (obj->isStatic() ? "1" : "0") << "\n";
             
             // Save transform
             const auto& t = obj->transform;
@@ -63,6 +67,16 @@ public:
                 file << "MESH primitive\n";
             }
 
+            // Save light if LightComponent exists
+            auto light = obj->getComponent<LightComponent>();
+            if (light) {
+                const color& c = light->getColor();
+                file << "LIGHT " << static_cast<int>(light->getType()) << " "
+                     << c.x << " " << c.y << " " << c.z << " "
+                     << light->getIntensity() << " " << light->getRange() << " "
+                     << light->getSpotAngle() * 180.0f / 3.14159f << "\n";
+            }
+
             file << "ENDGO\n";
         }
 
@@ -107,9 +121,11 @@ public:
             else if (token == "GO") {
                 std::string name;
                 int active;
-                iss >> name >> active;
+                int isStatic = 0;  // Optional (older files)
+                iss >> name >> active >> isStatic;
                 currentObject = scene.createGameObject(name);
                 currentObject->setActive(active != 0);
+                currentObject->setStatic(isStatic != 0);
             }
             else if (token == "TR" && currentObject) {
                 float px, py, pz, rx, ry, rz, sx, sy, sz;
@@ -126,6 +142,17 @@ public:
                 currentObject->addComponent<MeshFilter>()->setMesh(Mesh::createCube());
                 currentObject->addComponent<MeshRenderer>();
             }
+            else if (token == "LIGHT" && currentObject) {
+                int type;
+                float r, g, b, intensity, range, spotAngle;
+                iss >> type >> r >> g >> b >> intensity >> range >> spotAngle;
+                auto* light = currentObject->addComponent<LightComponent>();
+                light->setType(static_cast<Light::Type>(type));
+                light->setColor(color(r, g, b));
+                light->setIntensity(intensity);
+                light->setRange(range);
+                light->setSpotAngle(spotAngle);
+            }
             else if (token == "ENDGO") {
                 currentObject = nullptr;
             }
@@ -0,0 +1,207 @@
+#ifndef SCENE_VIEW_H
+#define SCENE_VIEW_H
+
+#include "../scene.h"
+#include "../Components/meshRenderer.h"
+#include "../Components/meshFilter.h"
+#include "../Components/cameraComponent.h"
+#include "../../Math/bounds.h"
+#include "../../Math/frustum.h"
+#include "../../Rendering/Core/render_backend.h"
+#include "../../Rendering/Core/render_command.h"
+#include "../../Rendering/Core/occlusion_culler.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @class SceneView
+ * @brief Renderer-independent front-end: what a camera sees this frame
+ *
+ * gather() picks the camera and lights, then culls the scene's renderers
+ * (spatial index broadphase, batched frustum test, occlusion culling
+ * against flagged occluders). recordCommands() selects each visible
+ * renderer's LOD and records sorted draw commands on the job system.
+ * The result feeds any RenderBackend, so the OpenGL loop and the software
+ * GameEngine share the same visibility and batching code.
+ *
+ * Scratch buffers are kept between frames; use one SceneView per view.
+ *
+ * Example:
+ * @code
+ * SceneView view;
+ * scene.updateSpatialIndex();
+ * view.render(scene, renderer, scene.backgroundColor);
+ * @endcode
+ */
+class SceneView
+{
+private:
+    const Scene* currentScene;
+    const Camera* camera;
+    std::vector<Light> lights;
+
+    // Per-frame culling scratch (reused to avoid allocations)
+    std::vector<GameObject*> candidates;
+    std::vector<std::pair<MeshRenderer*, MeshFilter*>> renderables;
+    BoundsSoA renderableBounds;
+    std::vector<uint32_t> visibleRenderables;
+    OcclusionCuller occlusionCuller;
+
+    DrawCommandQueue commands;
+
+    AABB boundsAt(uint32_t index) const
+    {
+        return AABB::fromCenterExtents(
+            vec3(renderableBounds.centerX[index], renderableBounds.centerY[index], renderableBounds.centerZ[index]),
+            vec3(renderableBounds.extentX[index], renderableBounds.extentY[index], renderableBounds.extentZ[index]));
+    }
+
+public:
+    SceneView()
+        : currentScene(nullptr), camera(nullptr)
+    {
+    }
+
+    /**
+     * @brief Lights for a frame: the LightComponents' then Scene::lights, or a
+     * default directional light if there are none
+     * Scene::getObjectLights indexes into this list.
+     */
+    static void collectLights(const Scene& scene, std::vector<Light>& out)
+    {
+        out = scene.getComponentLights();
+        out.insert(out.end(), scene.lights.begin(), scene.lights.end());
+        if (out.empty())
+            out.push_back(Light::directional(vec3(-1, -1, -1), color(1, 1, 1), 0.8f));
+    }
+
+    /**
+     * @brief Find the camera and lights and cull the scene for this frame
+     * @param scene Scene whose spatial index is up to date (updateSpatialIndex)
+     * @param fallbackCamera Used when no GameObject has a CameraComponent
+     * @return false if there is no camera (nothing visible)
+     *
+     * Uses the scene's lights, or a default directional light if it has none.
+     */
+    bool gather(Scene& scene, const Camera* fallbackCamera = nullptr)
+    {
+        currentScene = &scene;
+        renderables.clear();
+        renderableBounds.clear();
+        visibleRenderables.clear();
+        lights.clear();
+
+        // First camera component wins
+        camera = fallbackCamera;
+        for (auto* obj : scene.getAllGameObjects())
+        {
+            if (auto* camComp = obj->getComponent<CameraComponent>())
+            {
+                camera = camComp->getCamera();
+                break;
+            }
+        }
+        if (!camera)
+            return false;
+
+        collectLights(scene, lights);
+
+        // Broadphase through the spatial index (fat bounds), then frustum cull
+        // the candidates' exact world bounds in one batch
+        mat4 viewProjection = camera->getViewProjectionMatrix();
+        Frustum frustum = Frustum::fromMatrix(viewProjection);
+        candidates.clear();
+        scene.queryFrustum(frustum, candidates);
+        for (auto* obj : candidates)
+        {
+            auto meshRenderer = obj->getComponent<MeshRenderer>();
+            auto meshFilter = obj->getComponent<MeshFilter>();
+
+            if (meshRenderer && meshFilter && meshRenderer->canRender())
+            {
+                renderables.emplace_back(meshRenderer, meshFilter);
+                renderableBounds.push(meshRenderer->getWorldBounds());
+            }
+        }
+        frustum.cull(renderableBounds, visibleRenderables);
+
+        // Occlusion cull against objects flagged as occluders (skipped when there are none)
+        occlusionCuller.beginFrame(viewProjection, camera->position);
+        for (uint32_t index : visibleRenderables)
+        {
+            auto* meshRenderer = renderables[index].first;
+            const Mesh* occluderMesh = meshRenderer->isOccluder() ? meshRenderer->getOccluderMesh() : nullptr;
+            if (occluderMesh)
+            {
+                occlusionCuller.addOccluder(*occluderMesh,
+                    meshRenderer->gameObject->transform.getModelMatrix(), boundsAt(index));
+            }
+        }
+        occlusionCuller.finishOccluders();
+        if (occlusionCuller.getOccluderCount() > 0)
+        {
+            visibleRenderables.erase(
+                std::remove_if(visibleRenderables.begin(), visibleRenderables.end(),
+                    [&](uint32_t index) { return !occlusionCuller.isVisible(boundsAt(index)); }),
+                visibleRenderables.end());
+        }
+        return true;
+    }
+
+    /**
+     * @brief Record sorted draw commands for the visible renderers (LOD selected)
+     * @return Commands, valid while the scene's meshes and materials are
+     *
+     * Culling already refreshed the lazy transform and bounds caches, so
+     * recording only reads them and runs on worker threads. Each command
+     * carries the renderer's lights from Scene::getObjectLights.
+     */
+    DrawCommandQueue& recordCommands()
+    {
+        commands.recordParallel(visibleRenderables.size(), [&](size_t i, std::vector<RenderCommand>& out) {
+            auto* meshRenderer = getVisible(i);
+            auto mesh = meshRenderer->selectLOD(*camera);
+            if (mesh)
+            {
+                out.push_back(RenderCommand::create(mesh.get(), meshRenderer->getMaterial().get(),
+                    meshRenderer->gameObject->transform.getModelMatrix(), meshRenderer->getPropertyBlock().get()));
+                out.back().lights = currentScene->getObjectLights(*meshRenderer);
+                out.back().receiveShadows = meshRenderer->getReceiveShadows();
+            }
+        });
+        return commands;
+    }
+
+    /**
+     * @brief Gather, record and draw one frame on a backend
+     * @return false if there was no camera (the target is only cleared)
+     */
+    bool render(Scene& scene, RenderBackend& backend, const color& clearColor,
+                const Camera* fallbackCamera = nullptr)
+    {
+        if (!gather(scene, fallbackCamera))
+        {
+            backend.clear(clearColor);
+            return false;
+        }
+
+        backend.beginFrame(*camera, lights);
+        backend.submit(recordCommands());
+        backend.clear(clearColor);
+        backend.flush();
+        return true;
+    }
+
+    const Camera* getCamera() const { return camera; }
+    const std::vector<Light>& getLights() const { return lights; }
+
+    /**
+     * @brief Visible renderers from the last gather()
+     */
+    size_t getVisibleCount() const { return visibleRenderables.size(); }
+    MeshRenderer* getVisible(size_t i) const { return renderables[visibleRenderables[i]].first; }
+};
+
+#endif // SCENE_VIEW_H
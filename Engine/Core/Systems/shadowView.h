@@ -0,0 +1,310 @@
+#ifndef SHADOW_VIEW_H
+#define SHADOW_VIEW_H
+
+#include "../scene.h"
+#include "../Components/meshRenderer.h"
+#include "../Components/meshFilter.h"
+#include "../../Math/bounds.h"
+#include "../../Math/frustum.h"
+#include "../../Math/mat4.h"
+#include "../../Rendering/camera.h"
+#include "../../Rendering/light.h"
+#include "../../Rendering/Core/shadow_frame.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ShadowView
+ * @brief Renderer-independent front-end for cascaded directional shadows
+ *
+ * gather() splits the camera's view range into cascades (practical split
+ * scheme) and fits each one with the bounding sphere of its frustum slice.
+ * The sphere's size doesn't depend on the camera's orientation. Each
+ * cascade's box is the sphere plus a margin (setCacheMargin), anchored at
+ * a center snapped to whole texels in light space, and its depth range
+ * spans the scene bounds along the light. The box stays put while the
+ * sphere moves inside it, so shadow edges don't shimmer and the matrix
+ * only changes once the camera has moved about margin × radius sideways
+ * to the light (or left the depth range).
+ *
+ * Casters are culled per cascade against the cascade's light-space box,
+ * extended toward the light up to the scene bounds. Static objects
+ * (GameObject::setStatic) are only collected when the cascade's cached
+ * depth is stale: its box moved, or the light or Scene::getStaticVersion()
+ * changed. Otherwise the backend reuses the depth it drew earlier and only
+ * draws the dynamic casters on top, so a moving camera mostly costs the
+ * dynamic casters, not the scene size.
+ *
+ * The shadowed light is the first directional light in the frame's list.
+ *
+ * Example:
+ * @code
+ * ShadowView shadows;
+ * view.gather(scene);
+ * if (shadows.gather(scene, *view.getCamera(), view.getLights()))
+ *     renderer.submitShadows(shadows.getFrame());
+ * @endcode
+ */
+class ShadowView
+{
+private:
+    // What a cascade's cached static depth was drawn with
+    struct CascadeCache
+    {
+        bool valid = false;
+        int64_t anchorX = 0, anchorY = 0;  // Light-space box center, in texels
+        float depthNear = 0.0f;            // Light-space Z range of the box
+        float depthFar = 0.0f;
+        float halfWidth = 0.0f;
+        vec3 direction;
+        int resolution = 0;
+        uint64_t staticVersion = 0;
+    };
+
+    int cascadeCount;
+    int resolution;
+    float maxDistance;
+    float splitLambda;
+    float cacheMargin;
+
+    ShadowFrame frame;
+    CascadeCache caches[ShadowFrame::MAX_CASCADES];
+    std::vector<GameObject*> candidates;
+    int staticRedraws;
+
+    static int64_t snap(float value, float cell)
+    {
+        return static_cast<int64_t>(std::floor(value / cell + 0.5f));
+    }
+
+    /**
+     * @brief Light-space bounding sphere of the view slice [near, far]
+     */
+    static void sliceSphere(const Camera& camera, float nearDistance, float farDistance,
+                            vec3& center, float& radius)
+    {
+        float tanHalfHeight = std::tan(camera.fieldOfView * 0.5f);
+        float tanHalfWidth = tanHalfHeight * camera.aspectRatio;
+        float tanSquared = tanHalfHeight * tanHalfHeight + tanHalfWidth * tanHalfWidth;
+
+        // Sphere through the slice's near and far corners, centered on the view axis
+        float distance = 0.5f * (farDistance + nearDistance) * (1.0f + tanSquared);
+        if (distance >= farDistance)
+        {
+            // Wide slices: the far cap's circle already encloses the near one
+            distance = farDistance;
+            radius = farDistance * std::sqrt(tanSquared);
+        }
+        else
+        {
+            float along = distance - nearDistance;
+            radius = std::sqrt(along * along + nearDistance * nearDistance * tanSquared);
+        }
+        center = camera.position + camera.getForward() * distance;
+    }
+
+    void addCaster(std::vector<RenderCommand>& out, MeshFilter* meshFilter, MeshRenderer* meshRenderer)
+    {
+        auto mesh = meshFilter->getMesh();
+        out.push_back(RenderCommand::create(mesh.get(), nullptr,
+            meshRenderer->gameObject->transform.getModelMatrix()));
+        frame.meshes.push_back(std::move(mesh));
+    }
+
+public:
+    ShadowView(int cascades = 4, int shadowResolution = 2048, float shadowDistance = 80.0f,
+               float lambda = 0.75f)
+        : cascadeCount(std::clamp(cascades, 1, ShadowFrame::MAX_CASCADES)),
+          resolution(shadowResolution),
+          maxDistance(shadowDistance),
+          splitLambda(lambda),
+          cacheMargin(0.25f),
+          staticRedraws(0)
+    {
+    }
+
+    // Settings (each change redraws every cascade)
+
+    void setCascadeCount(int count) { cascadeCount = std::clamp(count, 1, ShadowFrame::MAX_CASCADES); invalidate(); }
+    void setResolution(int texels) { resolution = std::max(texels, 64); invalidate(); }
+    void setMaxDistance(float distance) { maxDistance = distance; invalidate(); }
+
+    /**
+     * Blend between uniform (0) and logarithmic (1) cascade splits
+     */
+    void setSplitLambda(float lambda) { splitLambda = std::clamp(lambda, 0.0f, 1.0f); invalidate(); }
+
+    /**
+     * Extra box size around each cascade's sphere, as a fraction of its
+     * radius; larger values keep the static cache longer while the camera
+     * moves but spread the cascade's texels over more area
+     */
+    void setCacheMargin(float margin) { cacheMargin = std::clamp(margin, 0.05f, 1.0f); invalidate(); }
+
+    int getCascadeCount() const { return cascadeCount; }
+    int getResolution() const { return resolution; }
+    float getMaxDistance() const { return maxDistance; }
+
+    /**
+     * @brief Drop the cached static depth of every cascade
+     */
+    void invalidate()
+    {
+        for (auto& cache : caches)
+            cache.valid = false;
+    }
+
+    /**
+     * @brief Fit the cascades to a camera and collect their casters
+     * @param scene Scene whose spatial index is up to date (updateSpatialIndex)
+     * @param camera View the shadows are for
+     * @param lights Frame lights (e.g. SceneView::getLights); the first
+     *        directional one casts shadows
+     * @return false if there's no lit directional light (the frame is empty)
+     */
+    bool gather(Scene& scene, const Camera& camera, const std::vector<Light>& lights)
+    {
+        frame.cascadeCount = 0;
+        frame.meshes.clear();
+        staticRedraws = 0;
+
+        const Light* sun = nullptr;
+        for (const auto& light : lights)
+        {
+            if (light.type == Light::Type::Directional)
+            {
+                sun = &light;
+                break;
+            }
+        }
+        if (!sun || sun->intensity <= 0.0f)
+            return false;
+
+        vec3 direction = sun->direction.normalized();
+        vec3 up = std::abs(direction.y) > 0.99f ? vec3(1, 0, 0) : vec3(0, 1, 0);
+        mat4 lightView = mat4::lookAt(vec3::zero, direction, up);
+
+        // Toward the light, casters can sit anywhere up to the scene bounds
+        AABB sceneBounds = scene.getSpatialIndex().getBounds();
+        AABB lightSceneBounds = sceneBounds.isValid() ? sceneBounds.transformed(lightView) : AABB();
+        float sceneTop = lightSceneBounds.isValid() ? lightSceneBounds.max.z : 0.0f;
+
+        float nearDistance = camera.nearPlane;
+        float farDistance = std::max(std::min(camera.farPlane, maxDistance), nearDistance * 2.0f);
+        uint64_t staticVersion = scene.getStaticVersion();
+
+        frame.cascadeCount = cascadeCount;
+        frame.resolution = resolution;
+        frame.lightDirection = direction;
+
+        float sliceNear = nearDistance;
+        for (int i = 0; i < cascadeCount; i++)
+        {
+            ShadowCascade& cascade = frame.cascades[i];
+            cascade.staticCasters.clear();
+            cascade.dynamicCasters.clear();
+
+            // Practical split scheme: blend logarithmic and uniform splits
+            float t = static_cast<float>(i + 1) / cascadeCount;
+            float logSplit = nearDistance * std::pow(farDistance / nearDistance, t);
+            float uniformSplit = nearDistance + (farDistance - nearDistance) * t;
+            float sliceFar = splitLambda * logSplit + (1.0f - splitLambda) * uniformSplit;
+
+            vec3 center;
+            float radius;
+            sliceSphere(camera, sliceNear, sliceFar, center, radius);
+
+            float halfWidth = radius * (1.0f + cacheMargin);
+            float texel = 2.0f * halfWidth / resolution;
+            vec3 lightCenter = lightView.transformPoint(center);
+
+            // Keep the cached box while it still holds the sphere
+            CascadeCache& cache = caches[i];
+            float reach = halfWidth - radius;
+            cascade.staticDirty = !cache.valid || cache.halfWidth != halfWidth ||
+                                  cache.direction != direction || cache.resolution != resolution ||
+                                  cache.staticVersion != staticVersion ||
+                                  std::abs(lightCenter.x - cache.anchorX * texel) > reach ||
+                                  std::abs(lightCenter.y - cache.anchorY * texel) > reach ||
+                                  lightCenter.z + radius > cache.depthFar ||
+                                  lightCenter.z - radius < cache.depthNear;
+            if (cascade.staticDirty)
+            {
+                // Re-anchor on the texel grid; depth spans the scene along the light
+                float depthNear = lightCenter.z - radius;
+                float depthFar = lightCenter.z + radius;
+                if (lightSceneBounds.isValid())
+                {
+                    depthNear = std::min(depthNear, lightSceneBounds.min.z);
+                    depthFar = std::max(depthFar, lightSceneBounds.max.z);
+                }
+                cache.valid = true;
+                cache.anchorX = snap(lightCenter.x, texel);
+                cache.anchorY = snap(lightCenter.y, texel);
+                cache.depthNear = depthNear - halfWidth;
+                cache.depthFar = depthFar + halfWidth;
+                cache.halfWidth = halfWidth;
+                cache.direction = direction;
+                cache.resolution = resolution;
+                cache.staticVersion = staticVersion;
+                staticRedraws++;
+            }
+
+            // Light view looks down -Z: near is toward the light
+            float x = cache.anchorX * texel;
+            float y = cache.anchorY * texel;
+            float boxNear = -cache.depthFar;
+            float boxFar = -cache.depthNear;
+            cascade.viewProjection =
+                mat4::orthographic(x - halfWidth, x + halfWidth, y - halfWidth, y + halfWidth, boxNear, boxFar) * lightView;
+            cascade.splitDistance = sliceFar;
+            cascade.texelWorldSize = texel;
+
+            // Casters: the cascade's box extended toward the light
+            float cullNear = std::min(boxNear, -sceneTop);
+            Frustum casterVolume = Frustum::fromMatrix(
+                mat4::orthographic(x - halfWidth, x + halfWidth, y - halfWidth, y + halfWidth, cullNear, boxFar) * lightView);
+            candidates.clear();
+            scene.queryFrustum(casterVolume, candidates);
+            for (auto* obj : candidates)
+            {
+                bool isStatic = obj->isStatic();
+                if (isStatic && !cascade.staticDirty)
+                    continue;
+
+                auto* meshRenderer = obj->getComponent<MeshRenderer>();
+                auto* meshFilter = obj->getComponent<MeshFilter>();
+                if (!meshRenderer || !meshFilter || !obj->isActive() || !meshRenderer->canRender() ||
+                    !meshRenderer->getCastShadows() || !casterVolume.intersects(meshRenderer->getWorldBounds()))
+                    continue;
+
+                addCaster(isStatic ? cascade.staticCasters : cascade.dynamicCasters, meshFilter, meshRenderer);
+            }
+
+            sliceNear = sliceFar;
+        }
+        return true;
+    }
+
+    const ShadowFrame& getFrame() const { return frame; }
+
+    /**
+     * @brief Cascades whose static depth must be redrawn this frame
+     */
+    int getStaticRedrawCount() const { return staticRedraws; }
+
+    /**
+     * @brief Casters over all cascades (static ones only when redrawn)
+     */
+    size_t getCasterCount() const
+    {
+        size_t count = 0;
+        for (int i = 0; i < frame.cascadeCount; i++)
+            count += frame.cascades[i].staticCasters.size() + frame.cascades[i].dynamicCasters.size();
+        return count;
+    }
+};
+
+#endif // SHADOW_VIEW_H
@@ -0,0 +1,184 @@
+#ifndef STATIC_BATCHER_H
+#define STATIC_BATCHER_H
+
+#include "../scene.h"
+#include "../Components/meshRenderer.h"
+#include "../Components/meshFilter.h"
+#include "../../Math/bounds.h"
+#include "../../Rendering/Core/vertex_transform.h"
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @class StaticBatcher
+ * @brief Merges static meshes that share a material into a few large meshes
+ *
+ * Objects opt in with GameObject::setStatic(true). build() groups their
+ * renderers by material and by a world-space grid cell, bakes the world
+ * transforms into merged vertex data and adds one GameObject per group
+ * (split further when a group exceeds the vertex limit). The originals'
+ * MeshRenderers are disabled, so thousands of small draws become a
+ * handful, while the grid keeps each batch small enough for culling.
+ *
+ * Renderers with LODs or a property block are left alone, as they can't
+ * share one mesh and material. Static objects must not move afterwards;
+ * call build() again (or clear()) after editing them.
+ *
+ * Example:
+ * @code
+ * rock->setStatic(true);
+ * StaticBatcher batcher;
+ * batcher.build(scene);  // after loading the level
+ * @endcode
+ */
+class StaticBatcher
+{
+private:
+    float chunkSize;
+    size_t maxVerticesPerBatch;
+
+    std::vector<GameObject*> batchObjects;    // Created by build()
+    std::vector<GameObject*> sourceObjects;   // Renderers disabled by build()
+
+    using GroupKey = std::tuple<Material*, bool, bool, int, int, int>;  // Material, shadow flags, cell
+
+    /**
+     * @brief Append a mesh with its world transform baked in
+     */
+    static void appendTransformed(Mesh& target, const Mesh& source, const mat4& model)
+    {
+        size_t baseVertex = target.vertices.size();
+        target.vertices.resize(baseVertex + source.vertices.size());
+        bool mirrored = VertexTransform::transformMesh(source, model, target.vertices.data() + baseVertex);
+
+        std::vector<unsigned int> indices(source.triangles.size() * 3);
+        VertexTransform::copyIndices(source, static_cast<unsigned int>(baseVertex), mirrored, indices.data());
+        for (size_t i = 0; i < indices.size(); i += 3)
+            target.triangles.emplace_back(indices[i], indices[i + 1], indices[i + 2]);
+    }
+
+public:
+    /**
+     * @param cellSize World-space size of the grid cells batches are split by
+     * @param maxVertices Vertex limit per merged mesh
+     */
+    StaticBatcher(float cellSize = 32.0f, size_t maxVertices = 65536)
+        : chunkSize(cellSize), maxVerticesPerBatch(maxVertices)
+    {
+    }
+
+    /**
+     * @brief Batch all active static renderers of the scene (replaces a previous build)
+     * @return Number of batch objects created
+     */
+    size_t build(Scene& scene)
+    {
+        clear(scene);
+
+        // Group by material, shadow flags and the grid cell of each object's center
+        std::map<GroupKey, std::vector<std::pair<GameObject*, const Mesh*>>> groups;
+        for (auto* obj : scene.getAllGameObjects())
+        {
+            if (!obj->isActive() || !obj->isStatic())
+                continue;
+
+            auto* meshRenderer = obj->getComponent<MeshRenderer>();
+            auto* meshFilter = obj->getComponent<MeshFilter>();
+            if (!meshRenderer || !meshFilter || !meshRenderer->canRender() || !meshRenderer->hasMaterial())
+                continue;
+            if (!meshRenderer->getLODs().empty() || meshRenderer->hasPropertyBlock())
+                continue;
+
+            AABB bounds = meshRenderer->getWorldBounds();
+            if (!bounds.isValid())
+                continue;
+            vec3 cell = bounds.getCenter() * (1.0f / chunkSize);
+
+            GroupKey key(meshRenderer->getMaterialPtr(),
+                         meshRenderer->getCastShadows(), meshRenderer->getReceiveShadows(),
+                         static_cast<int>(std::floor(cell.x)),
+                         static_cast<int>(std::floor(cell.y)),
+                         static_cast<int>(std::floor(cell.z)));
+            groups[key].emplace_back(obj, meshFilter->getMeshPtr());
+        }
+
+        for (const auto& [key, members] : groups)
+        {
+            // A lone object gains nothing from merging
+            if (members.size() < 2)
+                continue;
+
+            auto* firstRenderer = members.front().first->getComponent<MeshRenderer>();
+            std::shared_ptr<Material> material = firstRenderer->getMaterial();
+
+            std::shared_ptr<Mesh> merged;
+            auto finishBatch = [&]() {
+                if (!merged || merged->vertices.empty())
+                    return;
+                merged->markDirty();
+
+                GameObject* batch = scene.createGameObject("StaticBatch_" + material->getName());
+                batch->setStatic(true);
+                batch->addComponent<MeshFilter>()->setMesh(merged);
+                auto* batchRenderer = batch->addComponent<MeshRenderer>();
+                batchRenderer->setMaterial(material);
+                batchRenderer->setCastShadows(std::get<1>(key));
+                batchRenderer->setReceiveShadows(std::get<2>(key));
+                batchObjects.push_back(batch);
+                merged.reset();
+            };
+
+            for (const auto& [obj, mesh] : members)
+            {
+                if (merged && merged->vertices.size() + mesh->vertices.size() > maxVerticesPerBatch)
+                    finishBatch();
+                if (!merged)
+                    merged = std::make_shared<Mesh>();
+
+                appendTransformed(*merged, *mesh, obj->transform.getModelMatrix());
+                obj->getComponent<MeshRenderer>()->setEnabled(false);
+                sourceObjects.push_back(obj);
+            }
+            finishBatch();
+        }
+
+        return batchObjects.size();
+    }
+
+    /**
+     * @brief Remove the batches and re-enable the original renderers
+     */
+    void clear(Scene& scene)
+    {
+        std::vector<GameObject*> live = scene.getAllGameObjects();
+        std::unordered_set<GameObject*> liveSet(live.begin(), live.end());
+
+        for (auto* obj : sourceObjects)
+        {
+            if (liveSet.count(obj))
+            {
+                if (auto* meshRenderer = obj->getComponent<MeshRenderer>())
+                    meshRenderer->setEnabled(true);
+            }
+        }
+        for (auto* batch : batchObjects)
+        {
+            if (liveSet.count(batch))
+                scene.destroyGameObject(batch);
+        }
+
+        sourceObjects.clear();
+        batchObjects.clear();
+    }
+
+    size_t getBatchCount() const { return batchObjects.size(); }
+    size_t getSourceCount() const { return sourceObjects.size(); }
+    const std::vector<GameObject*>& getBatchObjects() const { return batchObjects; }
+};
+
+#endif // STATIC_BATCHER_H
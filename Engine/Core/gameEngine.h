@@ -3,8 +3,10 @@
 
 #include "scene.h"
 #include "Systems/input.h"
+#include "Systems/sceneView.h"
 #include "../Rendering/Core/framebuffer.h"
 #include "../Rendering/Core/rasterizer.h"
+#include "../Rendering/Core/software_renderer.h"
 #include "../Rendering/Core/window.h"
 #include <chrono>
 #include <iostream>
@@ -29,6 +31,8 @@ public:
     Scene* activeScene;
     Framebuffer framebuffer;
     Rasterizer rasterizer;
+    SoftwareRenderer renderer;   // Draws into framebuffer with rasterizer
+    SceneView sceneView;
 
     // Time management
     float deltaTime;
@@ -52,6 +56,7 @@ public:
           activeScene(nullptr),
           framebuffer(w, h),
           rasterizer(),
+          renderer(framebuffer, rasterizer),
           deltaTime(0.0f),
           time(0.0f),
           frameCount(0),
@@ -107,8 +112,9 @@ public:
         activeScene->update(deltaTime);
         activeScene->lateUpdate(deltaTime);
 
-        // Render scene
-        activeScene->render(framebuffer, rasterizer);
+        // Render scene (same culling/LOD/command front-end as the OpenGL loop)
+        activeScene->updateSpatialIndex();
+        sceneView.render(*activeScene, renderer, activeScene->backgroundColor, &activeScene->mainCamera);
 
         frameCount++;
         time += deltaTime;
@@ -29,6 +29,7 @@ public:
     std::string name;
     TransformComponent transform;
     bool active;
+    bool staticObject;  // Promised never to move (see setStatic)
 
     /**
      * @brief Constructor for GameObject
@@ -37,7 +38,8 @@ public:
     GameObject(const std::string& objectName = "GameObject")
         : name(objectName),
           transform(),
-          active(true)
+          active(true),
+          staticObject(false)
     {
     }
 
@@ -72,6 +74,7 @@ public:
         
         std::type_index typeIdx(typeid(T));
         componentMap[typeIdx] = component;
+        componentVersionCounter()++;
         
         return static_cast<T*>(component.get());
     }
@@ -156,6 +159,7 @@ public:
                     }),
                 components.end()
             );
+            componentVersionCounter()++;
         }
     }
 
@@ -169,10 +173,38 @@ public:
         return active;
     }
 
+    /**
+     * @brief Mark the object as never moving, opting it into StaticBatcher
+     */
+    void setStatic(bool value)
+    {
+        staticObject = value;
+    }
+
+    bool isStatic() const
+    {
+        return staticObject;
+    }
+
+    /**
+     * @brief Counter bumped whenever any GameObject gains or loses a component
+     * Lets caches of component pointers skip rescanning unchanged scenes.
+     */
+    static uint64_t getComponentVersion()
+    {
+        return componentVersionCounter();
+    }
+
 private:
     std::vector<std::shared_ptr<Component>> components;
     std::unordered_map<std::type_index, std::shared_ptr<Component>> componentMap;
 
+    static uint64_t& componentVersionCounter()
+    {
+        static uint64_t counter = 0;
+        return counter;
+    }
+
     // Private lifecycle methods - only Scene should call these
     
     void awake()
@@ -2,24 +2,54 @@
 #define SCENE_H
 
 #include "gameObject.h"
+#include "Components/meshFilter.h"
+#include "Components/cameraComponent.h"
+#include "Components/lightComponent.h"
+#include "Components/meshRenderer.h"
+#include "Systems/dynamicBVH.h"
 #include "../Rendering/camera.h"
 #include "../Rendering/light.h"
 #include "../Rendering/Core/framebuffer.h"
 #include "../Rendering/Core/rasterizer.h"
+#include "../Rendering/Primitives/meshBVH.h"
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <cmath>
 #include <functional>
+#include <unordered_map>
 
 // Forward declaration
 class GameEngine;
+class SceneView;
+class ShadowView;
+class RenderThread;
+struct CapturedFrame;
 
 // Forward declare Engine namespace functions for friend access
 namespace Engine {
     inline void run(Scene& scene, int targetFPS);
-    inline void runOpenGL(Scene& scene, int width, int height, const std::string& title, int targetFPS);
+    inline void runOpenGL(Scene& scene, int width, int height, const std::string& title, int targetFPS, bool useRenderThread);
+    inline bool renderFrame(Scene& scene, SceneView& sceneView, ShadowView& shadowView,
+                            RenderThread& renderThread, int width, int height, float deltaTime);
+    inline bool renderOffscreen(Scene& scene, int width, int height, int frameCount,
+                                std::function<void(const CapturedFrame&)> onFrame, float deltaTime, bool useRenderThread);
 }
 
+/**
+ * @struct RaycastHit
+ * @brief Result of Scene::raycast / Scene::pick
+ */
+struct RaycastHit
+{
+    GameObject* gameObject = nullptr;
+    float distance = 0.0f;  // Along the normalized ray direction
+    vec3 point;             // World-space hit position
+    vec3 normal;            // World-space geometric normal (not flipped toward the ray)
+    int triangleIndex = -1; // Index into the mesh's triangles
+    vec2 barycentric;       // Weights of the triangle's v1 and v2
+};
+
 /**
  * @class Scene
  * @brief Represents a 3D scene containing GameObjects, lights, and a camera
@@ -31,7 +61,9 @@ class Scene
 {
     friend class GameEngine;  // Allow GameEngine to call private lifecycle methods
     friend void Engine::run(Scene&, int);
-    friend void Engine::runOpenGL(Scene&, int, int, const std::string&, int);
+    friend void Engine::runOpenGL(Scene&, int, int, const std::string&, int, bool);
+    friend bool Engine::renderFrame(Scene&, SceneView&, ShadowView&, RenderThread&, int, int, float);
+    friend bool Engine::renderOffscreen(Scene&, int, int, int, std::function<void(const CapturedFrame&)>, float, bool);
 public:
     std::string name;
     Camera mainCamera;
@@ -41,7 +73,13 @@ public:
     Scene(const std::string& sceneName = "Untitled Scene")
         : name(sceneName),
           mainCamera(),
-          backgroundColor(0.1f, 0.1f, 0.15f)
+          backgroundColor(0.1f, 0.1f, 0.15f),
+          structureVersion(0),
+          staticVersion(0),
+          lightVersion(0),
+          lightStructureVersion(0),
+          lightsScanned(false),
+          lightsPerObject(LightSet::MAX_LIGHTS)
     {
     }
     
@@ -62,11 +100,14 @@ public:
     {
         auto obj = std::make_shared<GameObject>(name);
         gameObjects.push_back(obj);
+        structureVersion++;
         return obj.get();
     }
 
     void destroyGameObject(GameObject* obj)
     {
+        removeFromSpatialIndex(obj);
+        structureVersion++;
         gameObjects.erase(
             std::remove_if(gameObjects.begin(), gameObjects.end(),
                 [obj](const std::shared_ptr<GameObject>& go) {
@@ -77,6 +118,8 @@ public:
     }
 
     // Light management
+    // Lights added here reach every object; LightComponents are culled per object
+
     void addLight(const Light& light)
     {
         lights.push_back(light);
@@ -92,8 +135,8 @@ public:
     {
         framebuffer.clear(backgroundColor);
 
-        // Note: Software rasterizer rendering is deprecated
-        // Use OpenGL renderer instead (Engine::runOpenGL)
+        // Note: Only clears. Draw through SceneView with a RenderBackend
+        // (SoftwareRenderer or OpenGLRenderer), as GameEngine does
         // This method kept for backwards compatibility
     }
 
@@ -108,6 +151,16 @@ public:
         return result;
     }
 
+    /**
+     * @brief Changes whenever objects are created or destroyed or any
+     * GameObject gains or loses a component
+     * Caches of component pointers only need to rescan when it changes.
+     */
+    uint64_t getStructureVersion() const
+    {
+        return structureVersion + GameObject::getComponentVersion();
+    }
+
     GameObject* findGameObject(const std::string& objectName)
     {
         for (auto& obj : gameObjects)
@@ -118,9 +171,534 @@ public:
         return nullptr;
     }
 
+    // Spatial queries
+
+    /**
+     * @brief Sync the spatial index with the current transforms and meshes
+     * Objects with a MeshFilter are inserted, moved or removed as needed;
+     * only objects whose transform or mesh changed are touched. The light
+     * index is synced the same way (see getObjectLights). Called by the
+     * engine once per frame after lateUpdate; call it yourself before
+     * querying if objects moved earlier in the same frame.
+     */
+    void updateSpatialIndex()
+    {
+        updateLightIndex();
+
+        for (auto& objPtr : gameObjects)
+        {
+            GameObject* obj = objPtr.get();
+            auto* meshFilter = obj->getComponent<MeshFilter>();
+            const Mesh* mesh = meshFilter ? meshFilter->getMeshPtr() : nullptr;
+            auto it = spatialEntries.find(obj);
+
+            if (!mesh || !mesh->getBounds().isValid())
+            {
+                if (it != spatialEntries.end())
+                    removeSpatialEntry(it);
+                continue;
+            }
+
+            uint64_t transformVersion = obj->transform.getVersion();
+            uint64_t meshVersion = mesh->getVersion();
+            if (it == spatialEntries.end())
+            {
+                AABB box = mesh->getBounds().transformed(obj->transform.getWorldMatrix());
+                SpatialEntry entry;
+                entry.proxy = spatialIndex.createProxy(box, obj);
+                entry.transformVersion = transformVersion;
+                entry.meshID = mesh->getID();
+                entry.meshVersion = meshVersion;
+                entry.isStatic = obj->isStatic();
+                spatialEntries.emplace(obj, entry);
+                if (entry.isStatic)
+                    staticVersion++;
+            }
+            else if (it->second.transformVersion != transformVersion ||
+                     it->second.meshID != mesh->getID() || it->second.meshVersion != meshVersion)
+            {
+                AABB box = mesh->getBounds().transformed(obj->transform.getWorldMatrix());
+                spatialIndex.moveProxy(it->second.proxy, box);
+                it->second.transformVersion = transformVersion;
+                it->second.meshID = mesh->getID();
+                it->second.meshVersion = meshVersion;
+                if (it->second.isStatic || obj->isStatic())
+                    staticVersion++;
+                it->second.isStatic = obj->isStatic();
+            }
+            else if (it->second.isStatic != obj->isStatic())
+            {
+                it->second.isStatic = obj->isStatic();
+                staticVersion++;
+            }
+        }
+    }
+
+    /**
+     * @brief Collect objects whose (fattened) bounds intersect the frustum
+     * Results are conservative; refine with exact bounds if needed.
+     */
+    void queryFrustum(const Frustum& frustum, std::vector<GameObject*>& results) const
+    {
+        spatialIndex.query(frustum, [&](int proxy) {
+            results.push_back(static_cast<GameObject*>(spatialIndex.getUserData(proxy)));
+            return true;
+        });
+    }
+
+    /**
+     * @brief Collect objects whose (fattened) bounds overlap a box
+     */
+    void queryBounds(const AABB& box, std::vector<GameObject*>& results) const
+    {
+        spatialIndex.query(box, [&](int proxy) {
+            results.push_back(static_cast<GameObject*>(spatialIndex.getUserData(proxy)));
+            return true;
+        });
+    }
+
+    /**
+     * @brief Collect up to k objects nearest to a point, closest first
+     * Distance is measured to each object's fattened bounds.
+     */
+    void queryNearest(const vec3& point, size_t k, std::vector<GameObject*>& results,
+                      float maxDistance = FLT_MAX) const
+    {
+        std::vector<int> proxies;
+        spatialIndex.queryNearest(point, k, proxies, maxDistance);
+        for (int proxy : proxies)
+            results.push_back(static_cast<GameObject*>(spatialIndex.getUserData(proxy)));
+    }
+
+    // Light queries
+
+    /**
+     * @brief Lights of the lit LightComponents as of the last updateSpatialIndex()
+     * Entry i belongs to the component whose getSceneIndex() is i. A frame's
+     * light list is these followed by Scene::lights (SceneView::collectLights).
+     */
+    const std::vector<Light>& getComponentLights() const { return componentLights; }
+
+    /**
+     * @brief Change counter of the light index, bumped for every light that
+     * is added, removed, moved or edited
+     */
+    uint64_t getLightVersion() const { return lightVersion; }
+
+    /**
+     * @brief Maximum number of lights per object (at most LightSet::MAX_LIGHTS)
+     */
+    void setLightsPerObject(int count)
+    {
+        lightsPerObject = std::clamp(count, 0, LightSet::MAX_LIGHTS);
+    }
+
+    int getLightsPerObject() const { return lightsPerObject; }
+
+    /**
+     * @brief The lights that most influence a renderer, as indices into the
+     * frame's light list (see getComponentLights)
+     *
+     * Scene::lights reach every object and take the first slots. The rest go
+     * to the strongest component lights: directional lights by intensity,
+     * point and spot lights found through the light index and ranked by
+     * intensity times the falloff at the closest point of the object's
+     * bounds. The pick is cached in the renderer and only redone when the
+     * object moves or a light whose range overlaps it changes, so steady
+     * frames cost a few version checks per object. Safe to call concurrently
+     * for different renderers.
+     *
+     * @return All lights (LightSet()) if the scene has none, or if objects
+     *         or components were added or removed since updateSpatialIndex()
+     */
+    LightSet getObjectLights(MeshRenderer& renderer) const
+    {
+        if ((componentLights.empty() && lights.empty()) || !renderer.gameObject ||
+            getStructureVersion() != lightStructureVersion)
+            return LightSet();
+
+        LightSet set = LightSet::none();
+        int globalCount = std::min(static_cast<int>(lights.size()), lightsPerObject);
+        for (int i = 0; i < globalCount; i++)
+            set.add(static_cast<uint16_t>(componentLights.size() + i));
+
+        int capacity = lightsPerObject - globalCount;
+        if (capacity > 0 && !componentLights.empty())
+        {
+            MeshRenderer::LightCache& cache = renderer.getLightCache();
+            if (!isLightCacheValid(renderer, cache, capacity))
+                pickLights(renderer, cache, capacity);
+            for (int i = 0; i < cache.count; i++)
+                set.add(static_cast<uint16_t>(cache.lights[i]->getSceneIndex()));
+        }
+        return set;
+    }
+
+    /**
+     * @brief Closest mesh triangle hit by a ray
+     * @param origin Ray origin (world space)
+     * @param direction Ray direction (normalized internally)
+     * @param hit Receives the closest hit
+     * @param maxDistance Ignore hits farther than this
+     * @return true if any object was hit
+     *
+     * Objects are visited nearest-first through the spatial index, and
+     * each mesh is tested with its cached MeshBVH (built on first use,
+     * rebuilt after the mesh changes). Both triangle faces count. Uses
+     * the index as of the last updateSpatialIndex().
+     */
+    bool raycast(const vec3& origin, const vec3& direction, RaycastHit& hit,
+                 float maxDistance = FLT_MAX) const
+    {
+        float length = direction.length();
+        if (length <= 0.0f)
+            return false;
+
+        Ray ray(origin, direction / length);
+        bool found = false;
+        spatialIndex.raycast(ray, maxDistance, [&](int proxy, float currentMax) {
+            auto* obj = static_cast<GameObject*>(spatialIndex.getUserData(proxy));
+            auto* meshFilter = obj->getComponent<MeshFilter>();
+            const Mesh* mesh = meshFilter ? meshFilter->getMeshPtr() : nullptr;
+            if (!mesh)
+                return currentMax;
+
+            // Test in mesh space; an affine transform keeps t unchanged
+            mat4 world = obj->transform.getWorldMatrix();
+            mat4 invWorld = world.inverse();
+            Ray localRay(invWorld.transformPoint(ray.origin), invWorld.transformDirection(ray.direction));
+
+            std::shared_ptr<const MeshBVH> bvh = MeshBVHCache::getInstance().get(*mesh);
+            MeshBVH::Hit meshHit;
+            if (!bvh->intersect(localRay, currentMax, meshHit))
+                return currentMax;
+
+            const Triangle& tri = mesh->triangles[meshHit.triangle];
+            vec3 p0 = world.transformPoint(mesh->vertices[tri.v0].position);
+            vec3 p1 = world.transformPoint(mesh->vertices[tri.v1].position);
+            vec3 p2 = world.transformPoint(mesh->vertices[tri.v2].position);
+
+            hit.gameObject = obj;
+            hit.distance = meshHit.distance;
+            hit.point = ray.at(meshHit.distance);
+            hit.normal = vec3::cross(p1 - p0, p2 - p0).normalized();
+            hit.triangleIndex = meshHit.triangle;
+            hit.barycentric = vec2(meshHit.u, meshHit.v);
+            found = true;
+            return meshHit.distance;
+        });
+        return found;
+    }
+
+    /**
+     * @brief Raycast through a screen pixel of a camera (e.g. mouse picking)
+     * @param camera Camera the screen point belongs to
+     * @param screenX, screenY Pixel coordinates ((0,0) is top-left)
+     * @param screenWidth, screenHeight Viewport size in pixels
+     * @param hit Receives the closest hit
+     */
+    bool pick(const CameraComponent& camera, float screenX, float screenY,
+              float screenWidth, float screenHeight, RaycastHit& hit) const
+    {
+        vec3 nearPoint = camera.screenToWorldPoint(vec3(screenX, screenY, 0.0f), screenWidth, screenHeight);
+        vec3 farPoint = camera.screenToWorldPoint(vec3(screenX, screenY, 1.0f), screenWidth, screenHeight);
+        return raycast(nearPoint, farPoint - nearPoint, hit, (farPoint - nearPoint).length());
+    }
+
+    /**
+     * @brief Direct access to the spatial index (proxy user data is the GameObject*)
+     */
+    const DynamicBVH& getSpatialIndex() const { return spatialIndex; }
+
+    /**
+     * @brief Change counter for static geometry
+     * Bumped by updateSpatialIndex() when a static object is added, moved,
+     * removed or changes its static flag. Caches built from static objects
+     * (e.g. shadow maps, see ShadowView) compare against it.
+     */
+    uint64_t getStaticVersion() const { return staticVersion; }
+
+    /**
+     * @brief Invalidate caches of static geometry
+     * Call after changes the scene can't see, such as toggling shadow
+     * casting or activity of a static object.
+     */
+    void markStaticChanged() { staticVersion++; }
+
 private:
+    struct SpatialEntry
+    {
+        int proxy;
+        uint64_t transformVersion;  // TransformComponent::getVersion() at last sync
+        uint64_t meshID;
+        uint64_t meshVersion;       // Mesh::getVersion() at last sync
+        bool isStatic;              // GameObject::isStatic() at last sync
+    };
+
+    struct LightEntry
+    {
+        int proxy = -1;         // Light index proxy (local lights only)
+        bool lit = false;       // LightComponent::isLit() at last sync
+        bool seen = false;      // Found by the current rescan
+        uint64_t version = 0;   // LightComponent::getVersion() at last sync
+        AABB bounds;            // Influence bounds at last sync (invalid = everywhere)
+    };
+
+    static constexpr size_t LIGHT_CHANGE_HISTORY = 256;  // Changes a renderer's cache can catch up on
+
     std::vector<std::shared_ptr<GameObject>> gameObjects;
+    uint64_t structureVersion;  // Bumped by create/destroyGameObject
+    uint64_t staticVersion;     // Bumped when static objects change (see getStaticVersion)
     std::function<void(Scene&)> openGLReadyCallback;
+    DynamicBVH spatialIndex;
+    std::unordered_map<GameObject*, SpatialEntry> spatialEntries;
+
+    // Light index (LightComponents)
+    DynamicBVH lightIndex;                                  // Point/spot influence boxes
+    std::unordered_map<LightComponent*, LightEntry> lightEntries;
+    std::vector<LightComponent*> sceneLights;               // Lit components by scene index
+    std::vector<Light> componentLights;                     // Their world-space lights
+    std::vector<int> directionalLights;                     // Scene indices of directional lights
+    std::vector<AABB> lightChanges;                         // Bounds of the most recent changes
+    uint64_t lightVersion;                                  // Changes so far (last one is lightChanges.back())
+    uint64_t lightStructureVersion;                         // getStructureVersion() at last light sync
+    bool lightsScanned;
+    int lightsPerObject;
+
+    /**
+     * @brief Record that lighting changed inside bounds (invalid = everywhere)
+     */
+    void recordLightChange(const AABB& bounds)
+    {
+        lightChanges.push_back(bounds);
+        lightVersion++;
+        if (lightChanges.size() > 2 * LIGHT_CHANGE_HISTORY)
+            lightChanges.erase(lightChanges.begin(), lightChanges.end() - LIGHT_CHANGE_HISTORY);
+    }
+
+    /**
+     * @brief Sync the light index with the LightComponents
+     * Components are only searched for when the scene structure changed;
+     * otherwise only lights whose version or lit state changed are touched.
+     */
+    void updateLightIndex()
+    {
+        bool listChanged = false;
+        uint64_t structure = getStructureVersion();
+        if (!lightsScanned || structure != lightStructureVersion)
+        {
+            for (auto& [component, entry] : lightEntries)
+                entry.seen = false;
+
+            for (auto& objPtr : gameObjects)
+            {
+                auto* component = objPtr->getComponent<LightComponent>();
+                if (!component)
+                    continue;
+                LightEntry& entry = lightEntries[component];
+                entry.seen = true;
+                // A new component reusing a destroyed one's address was never indexed
+                if (entry.lit && component->sceneIndex < 0)
+                    entry.version = ~0ull;
+            }
+
+            for (auto it = lightEntries.begin(); it != lightEntries.end();)
+            {
+                if (it->second.seen)
+                {
+                    ++it;
+                    continue;
+                }
+                if (it->second.lit)
+                {
+                    recordLightChange(it->second.bounds);
+                    listChanged = true;
+                }
+                if (it->second.proxy != -1)
+                    lightIndex.destroyProxy(it->second.proxy);
+                it = lightEntries.erase(it);
+            }
+
+            lightStructureVersion = structure;
+            lightsScanned = true;
+        }
+
+        bool lightsChanged = listChanged;
+        for (auto& [component, entry] : lightEntries)
+        {
+            bool lit = component->isLit();
+            uint64_t version = component->getVersion();
+            if (lit == entry.lit && (!lit || version == entry.version))
+                continue;
+
+            // Both the old and the new reach of the light need new picks
+            if (entry.lit)
+                recordLightChange(entry.bounds);
+            if (lit)
+            {
+                entry.bounds = component->getInfluenceBounds();
+                recordLightChange(entry.bounds);
+            }
+
+            bool indexed = lit && component->isLocal();
+            if (indexed && entry.proxy == -1)
+                entry.proxy = lightIndex.createProxy(entry.bounds, component);
+            else if (indexed)
+                lightIndex.moveProxy(entry.proxy, entry.bounds);
+            else if (entry.proxy != -1)
+            {
+                lightIndex.destroyProxy(entry.proxy);
+                entry.proxy = -1;
+            }
+
+            if (lit != entry.lit)
+                listChanged = true;
+            entry.lit = lit;
+            entry.version = version;
+            lightsChanged = true;
+            if (!listChanged && lit)
+                componentLights[component->sceneIndex] = component->getLight();
+        }
+
+        if (listChanged)
+        {
+            sceneLights.clear();
+            componentLights.clear();
+            for (auto& [component, entry] : lightEntries)
+            {
+                component->sceneIndex = -1;
+                if (!entry.lit)
+                    continue;
+                component->sceneIndex = static_cast<int>(sceneLights.size());
+                sceneLights.push_back(component);
+                componentLights.push_back(component->getLight());
+            }
+        }
+
+        if (lightsChanged)
+        {
+            directionalLights.clear();
+            for (size_t i = 0; i < sceneLights.size(); i++)
+            {
+                if (!sceneLights[i]->isLocal())
+                    directionalLights.push_back(static_cast<int>(i));
+            }
+        }
+    }
+
+    /**
+     * @brief Whether a renderer's cached pick still holds (catches up on
+     * light changes that don't reach it)
+     */
+    bool isLightCacheValid(const MeshRenderer& renderer, MeshRenderer::LightCache& cache, int capacity) const
+    {
+        const GameObject* obj = renderer.gameObject;
+        auto* meshFilter = obj->getComponent<MeshFilter>();
+        const Mesh* mesh = meshFilter ? meshFilter->getMeshPtr() : nullptr;
+        if (cache.capacity != capacity || cache.transformVersion != obj->transform.getVersion() ||
+            cache.meshID != (mesh ? mesh->getID() : 0) || cache.meshVersion != (mesh ? mesh->getVersion() : 0))
+            return false;
+
+        // Versions are consecutive, so the missed changes are the newest ones
+        uint64_t missed = lightVersion - cache.lightVersion;
+        if (missed > lightChanges.size())
+            return false;
+        for (size_t i = lightChanges.size() - missed; i < lightChanges.size(); i++)
+        {
+            if (!lightChanges[i].isValid() || lightChanges[i].intersects(cache.bounds))
+                return false;
+        }
+        cache.lightVersion = lightVersion;
+        return true;
+    }
+
+    /**
+     * @brief Falloff used to rank lights (matches the built-in shaders)
+     */
+    static float lightFalloff(float distance, float range)
+    {
+        float attenuation = 1.0f / (1.0f + 0.09f * distance + 0.032f * distance * distance);
+        float ratio = distance / range;
+        float fade = std::max(1.0f - ratio * ratio * ratio * ratio, 0.0f);
+        return attenuation * fade * fade;
+    }
+
+    /**
+     * @brief Pick the strongest component lights for a renderer into its cache
+     */
+    void pickLights(const MeshRenderer& renderer, MeshRenderer::LightCache& cache, int capacity) const
+    {
+        const GameObject* obj = renderer.gameObject;
+        auto* meshFilter = obj->getComponent<MeshFilter>();
+        const Mesh* mesh = meshFilter ? meshFilter->getMeshPtr() : nullptr;
+        AABB bounds = renderer.getWorldBounds();
+        if (!bounds.isValid())
+        {
+            vec3 position = obj->transform.getWorldPosition();
+            bounds = AABB(position, position);
+        }
+
+        // Keep the best `capacity` lights, strongest first
+        float scores[LightSet::MAX_LIGHTS];
+        cache.count = 0;
+        auto consider = [&](const LightComponent* component, float score) {
+            if (score <= 0.0f || (cache.count == capacity && score <= scores[capacity - 1]))
+                return;
+            int i = std::min(cache.count, capacity - 1);
+            while (i > 0 && scores[i - 1] < score)
+            {
+                scores[i] = scores[i - 1];
+                cache.lights[i] = cache.lights[i - 1];
+                i--;
+            }
+            scores[i] = score;
+            cache.lights[i] = component;
+            cache.count = std::min(cache.count + 1, capacity);
+        };
+        auto strength = [](const Light& light) {
+            return light.intensity * std::max(light.color.x, std::max(light.color.y, light.color.z));
+        };
+
+        for (int index : directionalLights)
+            consider(sceneLights[index], strength(componentLights[index]));
+
+        vec3 center = bounds.getCenter();
+        float radius = bounds.getExtents().length();
+        lightIndex.query(bounds, [&](int proxy) {
+            auto* component = static_cast<const LightComponent*>(lightIndex.getUserData(proxy));
+            const Light& light = componentLights[component->getSceneIndex()];
+            float distanceSquared = bounds.distanceSquared(light.position);
+            if (distanceSquared >= light.range * light.range)
+                return true;
+            // Objects entirely behind a spot light can't be lit by it
+            if (light.type == Light::Type::Spot && vec3::dot(center - light.position, light.direction) < -radius)
+                return true;
+            consider(component, strength(light) * lightFalloff(std::sqrt(distanceSquared), light.range));
+            return true;
+        });
+
+        cache.capacity = capacity;
+        cache.bounds = bounds;
+        cache.transformVersion = obj->transform.getVersion();
+        cache.meshID = mesh ? mesh->getID() : 0;
+        cache.meshVersion = mesh ? mesh->getVersion() : 0;
+        cache.lightVersion = lightVersion;
+    }
+
+    void removeSpatialEntry(std::unordered_map<GameObject*, SpatialEntry>::iterator it)
+    {
+        if (it->second.isStatic)
+            staticVersion++;
+        spatialIndex.destroyProxy(it->second.proxy);
+        spatialEntries.erase(it);
+    }
+
+    void removeFromSpatialIndex(GameObject* obj)
+    {
+        auto it = spatialEntries.find(obj);
+        if (it != spatialEntries.end())
+            removeSpatialEntry(it);
+    }
 
     // Private lifecycle methods - only GameEngine should call these
     
@@ -0,0 +1,209 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include "vec3.h"
+#include "mat4.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+/**
+ * @struct AABB
+ * @brief Axis-aligned bounding box
+ *
+ * Default-constructed boxes are empty (min > max) so expand() can
+ * grow them from nothing.
+ */
+struct AABB
+{
+    vec3 min;
+    vec3 max;
+
+    AABB() : min(FLT_MAX, FLT_MAX, FLT_MAX), max(-FLT_MAX, -FLT_MAX, -FLT_MAX) {}
+    AABB(const vec3& minPoint, const vec3& maxPoint) : min(minPoint), max(maxPoint) {}
+
+    static AABB fromCenterExtents(const vec3& center, const vec3& extents)
+    {
+        return AABB(center - extents, center + extents);
+    }
+
+    /**
+     * @brief Smallest box containing both boxes
+     */
+    static AABB merge(const AABB& a, const AABB& b)
+    {
+        AABB result = a;
+        result.expand(b);
+        return result;
+    }
+
+    bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    vec3 getCenter() const { return (min + max) * 0.5f; }
+    vec3 getExtents() const { return (max - min) * 0.5f; }  // Half size
+    vec3 getSize() const { return max - min; }
+
+    /**
+     * @brief Surface area (cost metric for BVH construction)
+     */
+    float getSurfaceArea() const
+    {
+        if (!isValid()) return 0.0f;
+        vec3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    void expand(const vec3& p)
+    {
+        min = vec3(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+        max = vec3(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+    }
+
+    void expand(const AABB& other)
+    {
+        if (!other.isValid()) return;
+        expand(other.min);
+        expand(other.max);
+    }
+
+    bool contains(const vec3& p) const
+    {
+        return p.x >= min.x && p.x <= max.x &&
+               p.y >= min.y && p.y <= max.y &&
+               p.z >= min.z && p.z <= max.z;
+    }
+
+    bool contains(const AABB& other) const
+    {
+        return other.min.x >= min.x && other.max.x <= max.x &&
+               other.min.y >= min.y && other.max.y <= max.y &&
+               other.min.z >= min.z && other.max.z <= max.z;
+    }
+
+    bool intersects(const AABB& other) const
+    {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y &&
+               min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    /**
+     * @brief Squared distance from a point to the box (0 if inside)
+     */
+    float distanceSquared(const vec3& p) const
+    {
+        float dx = std::max(std::max(min.x - p.x, 0.0f), p.x - max.x);
+        float dy = std::max(std::max(min.y - p.y, 0.0f), p.y - max.y);
+        float dz = std::max(std::max(min.z - p.z, 0.0f), p.z - max.z);
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    /**
+     * @brief Slab test against a ray given as origin + 1/direction
+     * @param origin Ray origin
+     * @param invDirection Component-wise reciprocal of the ray direction
+     * @param maxDistance Ignore hits beyond this ray parameter
+     * @param entry Receives the entry parameter (0 if the origin is inside)
+     * @return true if the ray overlaps the box within [0, maxDistance]
+     */
+    bool intersectRay(const vec3& origin, const vec3& invDirection, float maxDistance, float& entry) const
+    {
+        float t1 = (min.x - origin.x) * invDirection.x;
+        float t2 = (max.x - origin.x) * invDirection.x;
+        float tNear = std::min(t1, t2);
+        float tFar = std::max(t1, t2);
+
+        t1 = (min.y - origin.y) * invDirection.y;
+        t2 = (max.y - origin.y) * invDirection.y;
+        tNear = std::max(tNear, std::min(t1, t2));
+        tFar = std::min(tFar, std::max(t1, t2));
+
+        t1 = (min.z - origin.z) * invDirection.z;
+        t2 = (max.z - origin.z) * invDirection.z;
+        tNear = std::max(tNear, std::min(t1, t2));
+        tFar = std::min(tFar, std::max(t1, t2));
+
+        entry = std::max(tNear, 0.0f);
+        return tFar >= entry && tNear <= maxDistance;
+    }
+
+    /**
+     * @brief Bounds of this box after an affine transform
+     * Uses the center/extents form (Arvo): the new extents are the old ones
+     * multiplied by the absolute rotation-scale part of the matrix.
+     */
+    AABB transformed(const mat4& matrix) const
+    {
+        if (!isValid()) return *this;
+
+        vec3 c = getCenter();
+        vec3 e = getExtents();
+        vec3 center = matrix.transformPoint(c);
+        vec3 extents(
+            std::abs(matrix.m[0][0]) * e.x + std::abs(matrix.m[0][1]) * e.y + std::abs(matrix.m[0][2]) * e.z,
+            std::abs(matrix.m[1][0]) * e.x + std::abs(matrix.m[1][1]) * e.y + std::abs(matrix.m[1][2]) * e.z,
+            std::abs(matrix.m[2][0]) * e.x + std::abs(matrix.m[2][1]) * e.y + std::abs(matrix.m[2][2]) * e.z);
+        return fromCenterExtents(center, extents);
+    }
+};
+
+/**
+ * @struct Ray
+ * @brief Half-line origin + t * direction, t >= 0
+ */
+struct Ray
+{
+    vec3 origin;
+    vec3 direction;  // Normalized by convention, so t is a distance
+
+    Ray() : origin(vec3::zero), direction(vec3::forward) {}
+    Ray(const vec3& o, const vec3& d) : origin(o), direction(d) {}
+
+    vec3 at(float t) const { return origin + direction * t; }
+
+    /**
+     * @brief Component-wise reciprocal of the direction (for slab tests)
+     * Zero components map to +/-inf, which the slab test handles.
+     */
+    vec3 inverseDirection() const
+    {
+        return vec3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    }
+};
+
+/**
+ * @struct BoundingSphere
+ * @brief Sphere bounds (cheaper rejection tests, rotation invariant)
+ */
+struct BoundingSphere
+{
+    vec3 center;
+    float radius;
+
+    BoundingSphere() : center(vec3::zero), radius(-1.0f) {}
+    BoundingSphere(const vec3& c, float r) : center(c), radius(r) {}
+
+    bool isValid() const { return radius >= 0.0f; }
+
+    bool intersects(const BoundingSphere& other) const
+    {
+        float r = radius + other.radius;
+        return (center - other.center).lengthSquared() <= r * r;
+    }
+
+    /**
+     * @brief Bounds after an affine transform (radius grows by the largest axis scale)
+     */
+    BoundingSphere transformed(const mat4& matrix) const
+    {
+        if (!isValid()) return *this;
+
+        float sx = vec3(matrix.m[0][0], matrix.m[1][0], matrix.m[2][0]).lengthSquared();
+        float sy = vec3(matrix.m[0][1], matrix.m[1][1], matrix.m[2][1]).lengthSquared();
+        float sz = vec3(matrix.m[0][2], matrix.m[1][2], matrix.m[2][2]).lengthSquared();
+        float scale = std::sqrt(std::max(sx, std::max(sy, sz)));
+        return BoundingSphere(matrix.transformPoint(center), radius * scale);
+    }
+};
+
+#endif //BOUNDS_H
@@ -0,0 +1,213 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "vec3.h"
+#include "mat4.h"
+#include "bounds.h"
+#include "simd.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct Plane
+ * @brief Plane dot(normal, p) + distance = 0, normal pointing to the inside
+ */
+struct Plane
+{
+    vec3 normal;
+    float distance;
+
+    Plane() : normal(vec3::up), distance(0.0f) {}
+    Plane(const vec3& n, float d) : normal(n), distance(d) {}
+
+    /**
+     * @brief Signed distance (positive = inside)
+     */
+    float distanceTo(const vec3& p) const { return vec3::dot(normal, p) + distance; }
+};
+
+/**
+ * @struct BoundsSoA
+ * @brief Structure-of-arrays AABB list (center/extents) for batched culling
+ *
+ * Keeping each component in its own array lets Frustum::cull() test four
+ * boxes per SIMD instruction.
+ */
+struct BoundsSoA
+{
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+    size_t size() const { return centerX.size(); }
+    bool empty() const { return centerX.empty(); }
+
+    void clear()
+    {
+        centerX.clear(); centerY.clear(); centerZ.clear();
+        extentX.clear(); extentY.clear(); extentZ.clear();
+    }
+
+    void reserve(size_t count)
+    {
+        centerX.reserve(count); centerY.reserve(count); centerZ.reserve(count);
+        extentX.reserve(count); extentY.reserve(count); extentZ.reserve(count);
+    }
+
+    void push(const AABB& box)
+    {
+        vec3 c = box.getCenter();
+        vec3 e = box.getExtents();
+        centerX.push_back(c.x); centerY.push_back(c.y); centerZ.push_back(c.z);
+        extentX.push_back(e.x); extentY.push_back(e.y); extentZ.push_back(e.z);
+    }
+};
+
+/**
+ * @class Frustum
+ * @brief Six clip planes extracted from a (view-)projection matrix
+ *
+ * Planes come straight from the matrix rows (Gribb/Hartmann), so a
+ * view-projection gives world-space planes and a model-view-projection
+ * gives object-space planes. Tests are conservative: boxes straddling a
+ * corner outside the frustum may be reported visible.
+ */
+class Frustum
+{
+public:
+    enum Side { Left = 0, Right, Bottom, Top, Near, Far, Count };
+
+    Plane planes[Count];
+
+    /**
+     * @brief Extract planes from an OpenGL-style clip matrix (z in [-w, w])
+     */
+    static Frustum fromMatrix(const mat4& clip)
+    {
+        Frustum f;
+        const float (*m)[4] = clip.m;
+        auto makePlane = [&](int row, float sign) {
+            vec3 n(m[3][0] + sign * m[row][0], m[3][1] + sign * m[row][1], m[3][2] + sign * m[row][2]);
+            float d = m[3][3] + sign * m[row][3];
+            float len = n.length();
+            return len > 0.0f ? Plane(n / len, d / len) : Plane(n, d);
+        };
+        f.planes[Left] = makePlane(0, 1.0f);
+        f.planes[Right] = makePlane(0, -1.0f);
+        f.planes[Bottom] = makePlane(1, 1.0f);
+        f.planes[Top] = makePlane(1, -1.0f);
+        f.planes[Near] = makePlane(2, 1.0f);
+        f.planes[Far] = makePlane(2, -1.0f);
+        return f;
+    }
+
+    bool contains(const vec3& p) const
+    {
+        for (const auto& plane : planes)
+        {
+            if (plane.distanceTo(p) < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    bool intersects(const AABB& box) const
+    {
+        if (!box.isValid()) return false;
+        vec3 c = box.getCenter();
+        vec3 e = box.getExtents();
+        for (const auto& plane : planes)
+        {
+            float r = e.x * std::abs(plane.normal.x) + e.y * std::abs(plane.normal.y) + e.z * std::abs(plane.normal.z);
+            if (plane.distanceTo(c) + r < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    enum class Containment { Outside, Intersecting, Inside };
+
+    /**
+     * @brief Classify a box as fully outside, straddling, or fully inside
+     * Lets hierarchy traversals accept whole subtrees without further tests.
+     */
+    Containment classify(const AABB& box) const
+    {
+        if (!box.isValid()) return Containment::Outside;
+        vec3 c = box.getCenter();
+        vec3 e = box.getExtents();
+        Containment result = Containment::Inside;
+        for (const auto& plane : planes)
+        {
+            float r = e.x * std::abs(plane.normal.x) + e.y * std::abs(plane.normal.y) + e.z * std::abs(plane.normal.z);
+            float d = plane.distanceTo(c);
+            if (d + r < 0.0f)
+                return Containment::Outside;
+            if (d - r < 0.0f)
+                result = Containment::Intersecting;
+        }
+        return result;
+    }
+
+    bool intersects(const BoundingSphere& sphere) const
+    {
+        if (!sphere.isValid()) return false;
+        for (const auto& plane : planes)
+        {
+            if (plane.distanceTo(sphere.center) < -sphere.radius)
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Batch-cull boxes, four at a time with SIMD
+     * @param bounds Boxes to test
+     * @param visible Receives indices of boxes that intersect (appended, in order)
+     * @return Number of visible boxes appended
+     */
+    size_t cull(const BoundsSoA& bounds, std::vector<uint32_t>& visible) const
+    {
+        const size_t count = bounds.size();
+        const size_t before = visible.size();
+        const float4 zero(0.0f);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            float4 cx = float4::load(&bounds.centerX[i]);
+            float4 cy = float4::load(&bounds.centerY[i]);
+            float4 cz = float4::load(&bounds.centerZ[i]);
+            float4 ex = float4::load(&bounds.extentX[i]);
+            float4 ey = float4::load(&bounds.extentY[i]);
+            float4 ez = float4::load(&bounds.extentZ[i]);
+
+            float4 outside = zero < zero;  // All false
+            for (const auto& plane : planes)
+            {
+                float4 nx(plane.normal.x), ny(plane.normal.y), nz(plane.normal.z);
+                float4 dist = cx * nx + cy * ny + cz * nz + float4(plane.distance);
+                float4 radius = ex * float4::abs(nx) + ey * float4::abs(ny) + ez * float4::abs(nz);
+                outside = outside | (dist + radius < zero);
+            }
+
+            int outsideBits = float4::mask(outside);
+            for (int k = 0; k < 4; k++)
+            {
+                if (!(outsideBits & (1 << k)))
+                    visible.push_back(static_cast<uint32_t>(i + k));
+            }
+        }
+
+        for (; i < count; i++)
+        {
+            vec3 c(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+            vec3 e(bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]);
+            if (intersects(AABB::fromCenterExtents(c, e)))
+                visible.push_back(static_cast<uint32_t>(i));
+        }
+
+        return visible.size() - before;
+    }
+};
+
+#endif //FRUSTUM_H
@@ -0,0 +1,301 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+/**
+ * @file simd.h
+ * @brief Minimal 4-wide float SIMD wrapper
+ *
+ * Backed by SSE2 on x86-64 (plus F16C when the compiler targets it),
+ * NEON on ARM64 (Apple Silicon), and plain scalar code elsewhere.
+ * Only the operations the engine's hot loops need are provided.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define ENGINE_SIMD_SSE 1
+#include <emmintrin.h>
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define ENGINE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+/**
+ * @brief Round-to-nearest-even float to half-float conversion
+ * Handles overflow to infinity, NaN, and half denormals.
+ */
+inline uint16_t floatToHalfRounded(float f)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t absBits = bits & 0x7FFFFFFF;
+
+    if (absBits >= 0x7F800000)
+    {
+        // Infinity or NaN (keep a mantissa bit so NaN stays NaN)
+        return static_cast<uint16_t>(sign | 0x7C00 | (absBits > 0x7F800000 ? 0x200 : 0));
+    }
+    if (absBits >= 0x477FF000)
+    {
+        // Rounds past the largest half (65504)
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+    if (absBits < 0x38800000)
+    {
+        // Half denormal or zero: shift mantissa (with implicit 1) into place
+        if (absBits < 0x33000000)
+            return static_cast<uint16_t>(sign);
+        uint32_t exponent = absBits >> 23;
+        uint32_t mantissa = (absBits & 0x007FFFFF) | 0x00800000;
+        uint32_t shift = 126 - exponent;  // 14..24
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t midpoint = 1u << (shift - 1);
+        if (remainder > midpoint || (remainder == midpoint && (half & 1)))
+            half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // Normal: rebias exponent, round mantissa to 10 bits (carry may bump exponent)
+    uint32_t half = (absBits - 0x38000000) >> 13;
+    uint32_t remainder = absBits & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        half++;
+    return static_cast<uint16_t>(sign | half);
+}
+
+/**
+ * @struct float4
+ * @brief Four packed floats with element-wise arithmetic
+ *
+ * Comparisons return lane masks (all bits set where true) for use
+ * with select() and anyTrue()/allTrue().
+ */
+struct float4
+{
+#if defined(ENGINE_SIMD_SSE)
+    __m128 v;
+    float4() : v(_mm_setzero_ps()) {}
+    float4(__m128 value) : v(value) {}
+    explicit float4(float s) : v(_mm_set1_ps(s)) {}
+    float4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+
+    static float4 load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+
+    float4 operator+(const float4& o) const { return _mm_add_ps(v, o.v); }
+    float4 operator-(const float4& o) const { return _mm_sub_ps(v, o.v); }
+    float4 operator*(const float4& o) const { return _mm_mul_ps(v, o.v); }
+    float4 operator/(const float4& o) const { return _mm_div_ps(v, o.v); }
+    float4 operator-() const { return _mm_xor_ps(v, _mm_set1_ps(-0.0f)); }
+    float4 operator&(const float4& o) const { return _mm_and_ps(v, o.v); }
+    float4 operator|(const float4& o) const { return _mm_or_ps(v, o.v); }
+
+    float4 operator<(const float4& o) const { return _mm_cmplt_ps(v, o.v); }
+    float4 operator<=(const float4& o) const { return _mm_cmple_ps(v, o.v); }
+    float4 operator>(const float4& o) const { return _mm_cmpgt_ps(v, o.v); }
+    float4 operator>=(const float4& o) const { return _mm_cmpge_ps(v, o.v); }
+
+    static float4 min(const float4& a, const float4& b) { return _mm_min_ps(a.v, b.v); }
+    static float4 max(const float4& a, const float4& b) { return _mm_max_ps(a.v, b.v); }
+    static float4 abs(const float4& a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+    static float4 sqrt(const float4& a) { return _mm_sqrt_ps(a.v); }
+
+    /** @brief Per lane: mask ? a : b */
+    static float4 select(const float4& mask, const float4& a, const float4& b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+    }
+
+    /** @brief Bit per lane (lane 0 = bit 0) where the mask is set */
+    static int mask(const float4& m) { return _mm_movemask_ps(m.v); }
+
+    /** @brief Round to nearest and store as int32 */
+    void storeRoundedInt(int32_t* out) const
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_cvtps_epi32(v));
+    }
+
+    /** @brief Convert to half floats (round to nearest even) */
+    void storeHalf(uint16_t* out) const
+    {
+#if defined(__F16C__)
+        __m128i h = _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), h);
+#else
+        alignas(16) float f[4];
+        _mm_store_ps(f, v);
+        for (int i = 0; i < 4; i++)
+            out[i] = floatToHalfRounded(f[i]);
+#endif
+    }
+
+#elif defined(ENGINE_SIMD_NEON)
+    float32x4_t v;
+    float4() : v(vdupq_n_f32(0.0f)) {}
+    float4(float32x4_t value) : v(value) {}
+    explicit float4(float s) : v(vdupq_n_f32(s)) {}
+    float4(float a, float b, float c, float d)
+    {
+        const float f[4] = { a, b, c, d };
+        v = vld1q_f32(f);
+    }
+
+    static float4 load(const float* p) { return vld1q_f32(p); }
+    void store(float* p) const { vst1q_f32(p, v); }
+
+    float4 operator+(const float4& o) const { return vaddq_f32(v, o.v); }
+    float4 operator-(const float4& o) const { return vsubq_f32(v, o.v); }
+    float4 operator*(const float4& o) const { return vmulq_f32(v, o.v); }
+    float4 operator/(const float4& o) const { return vdivq_f32(v, o.v); }
+    float4 operator-() const { return vnegq_f32(v); }
+    float4 operator&(const float4& o) const
+    {
+        return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), vreinterpretq_u32_f32(o.v)));
+    }
+    float4 operator|(const float4& o) const
+    {
+        return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(v), vreinterpretq_u32_f32(o.v)));
+    }
+
+    float4 operator<(const float4& o) const { return vreinterpretq_f32_u32(vcltq_f32(v, o.v)); }
+    float4 operator<=(const float4& o) const { return vreinterpretq_f32_u32(vcleq_f32(v, o.v)); }
+    float4 operator>(const float4& o) const { return vreinterpretq_f32_u32(vcgtq_f32(v, o.v)); }
+    float4 operator>=(const float4& o) const { return vreinterpretq_f32_u32(vcgeq_f32(v, o.v)); }
+
+    static float4 min(const float4& a, const float4& b) { return vminq_f32(a.v, b.v); }
+    static float4 max(const float4& a, const float4& b) { return vmaxq_f32(a.v, b.v); }
+    static float4 abs(const float4& a) { return vabsq_f32(a.v); }
+    static float4 sqrt(const float4& a) { return vsqrtq_f32(a.v); }
+
+    static float4 select(const float4& mask, const float4& a, const float4& b)
+    {
+        return vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v);
+    }
+
+    static int mask(const float4& m)
+    {
+        uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(m.v), 31);
+        return static_cast<int>(vgetq_lane_u32(bits, 0) | (vgetq_lane_u32(bits, 1) << 1) |
+                                (vgetq_lane_u32(bits, 2) << 2) | (vgetq_lane_u32(bits, 3) << 3));
+    }
+
+    void storeRoundedInt(int32_t* out) const { vst1q_s32(out, vcvtnq_s32_f32(v)); }
+
+    void storeHalf(uint16_t* out) const
+    {
+        float16x4_t h = vcvt_f16_f32(v);
+        vst1_u16(out, vreinterpret_u16_f16(h));
+    }
+
+#else
+    float f[4];
+    float4() : f{ 0.0f, 0.0f, 0.0f, 0.0f } {}
+    explicit float4(float s) : f{ s, s, s, s } {}
+    float4(float a, float b, float c, float d) : f{ a, b, c, d } {}
+
+    static float4 load(const float* p) { return float4(p[0], p[1], p[2], p[3]); }
+    void store(float* p) const { for (int i = 0; i < 4; i++) p[i] = f[i]; }
+
+    template<typename Op>
+    static float4 apply(const float4& a, const float4& b, Op op)
+    {
+        return float4(op(a.f[0], b.f[0]), op(a.f[1], b.f[1]), op(a.f[2], b.f[2]), op(a.f[3], b.f[3]));
+    }
+
+    static float fromMask(bool b)
+    {
+        uint32_t bits = b ? 0xFFFFFFFFu : 0u;
+        float r;
+        std::memcpy(&r, &bits, sizeof(r));
+        return r;
+    }
+
+    static uint32_t bitsOf(float x)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        return bits;
+    }
+
+    static float fromBits(uint32_t bits)
+    {
+        float r;
+        std::memcpy(&r, &bits, sizeof(r));
+        return r;
+    }
+
+    float4 operator+(const float4& o) const { return apply(*this, o, [](float a, float b) { return a + b; }); }
+    float4 operator-(const float4& o) const { return apply(*this, o, [](float a, float b) { return a - b; }); }
+    float4 operator*(const float4& o) const { return apply(*this, o, [](float a, float b) { return a * b; }); }
+    float4 operator/(const float4& o) const { return apply(*this, o, [](float a, float b) { return a / b; }); }
+    float4 operator-() const { return float4(-f[0], -f[1], -f[2], -f[3]); }
+    float4 operator&(const float4& o) const { return apply(*this, o, [](float a, float b) { return fromBits(bitsOf(a) & bitsOf(b)); }); }
+    float4 operator|(const float4& o) const { return apply(*this, o, [](float a, float b) { return fromBits(bitsOf(a) | bitsOf(b)); }); }
+
+    float4 operator<(const float4& o) const { return apply(*this, o, [](float a, float b) { return fromMask(a < b); }); }
+    float4 operator<=(const float4& o) const { return apply(*this, o, [](float a, float b) { return fromMask(a <= b); }); }
+    float4 operator>(const float4& o) const { return apply(*this, o, [](float a, float b) { return fromMask(a > b); }); }
+    float4 operator>=(const float4& o) const { return apply(*this, o, [](float a, float b) { return fromMask(a >= b); }); }
+
+    static float4 min(const float4& a, const float4& b) { return apply(a, b, [](float x, float y) { return x < y ? x : y; }); }
+    static float4 max(const float4& a, const float4& b) { return apply(a, b, [](float x, float y) { return x > y ? x : y; }); }
+    static float4 abs(const float4& a) { return float4(std::fabs(a.f[0]), std::fabs(a.f[1]), std::fabs(a.f[2]), std::fabs(a.f[3])); }
+    static float4 sqrt(const float4& a) { return float4(std::sqrt(a.f[0]), std::sqrt(a.f[1]), std::sqrt(a.f[2]), std::sqrt(a.f[3])); }
+
+    static float4 select(const float4& mask, const float4& a, const float4& b)
+    {
+        float4 r;
+        for (int i = 0; i < 4; i++)
+            r.f[i] = bitsOf(mask.f[i]) ? a.f[i] : b.f[i];
+        return r;
+    }
+
+    static int mask(const float4& m)
+    {
+        int bits = 0;
+        for (int i = 0; i < 4; i++)
+            bits |= (bitsOf(m.f[i]) >> 31) << i;
+        return bits;
+    }
+
+    void storeRoundedInt(int32_t* out) const
+    {
+        for (int i = 0; i < 4; i++)
+            out[i] = static_cast<int32_t>(std::nearbyint(f[i]));
+    }
+
+    void storeHalf(uint16_t* out) const
+    {
+        for (int i = 0; i < 4; i++)
+            out[i] = floatToHalfRounded(f[i]);
+    }
+#endif
+
+    /** @brief True if any lane of a comparison mask is set */
+    static bool anyTrue(const float4& m) { return mask(m) != 0; }
+
+    /** @brief True if every lane of a comparison mask is set */
+    static bool allTrue(const float4& m) { return mask(m) == 0xF; }
+
+    /** @brief Clamp each lane to [lo, hi] */
+    static float4 clamp(const float4& a, const float4& lo, const float4& hi)
+    {
+        return min(max(a, lo), hi);
+    }
+
+    /** @brief +1 where lane >= 0, -1 elsewhere (octahedral encoding sign) */
+    static float4 signNotZero(const float4& a)
+    {
+        return select(a >= float4(0.0f), float4(1.0f), float4(-1.0f));
+    }
+};
+
+#endif // SIMD_H
@@ -0,0 +1,301 @@
+#ifndef CASCADED_SHADOW_MAPS_H
+#define CASCADED_SHADOW_MAPS_H
+
+#include "gl_dispatch.h"
+
+#include "shadow_frame.h"
+#include "render_command.h"
+#include "../Shaders/shader.h"
+#include "../../Math/mat4.h"
+#include <algorithm>
+#include <vector>
+
+/**
+ * @file cascaded_shadow_maps.h
+ * @brief GPU side of cascaded directional shadows
+ *
+ * Two depth texture arrays with one layer per cascade:
+ * - a static cache holding only static casters, redrawn when a cascade's
+ *   ShadowCascade::staticDirty is set
+ * - the shadow map shaders sample (_ShadowMap, sampler2DArrayShadow),
+ *   a copy of the cached layer with the frame's dynamic casters on top
+ *
+ * Layers without dynamic casters this frame or last frame are left as they
+ * are, so a still scene costs no shadow draws at all. Casters are drawn
+ * with depth clamping (objects between the light and the cascade's near
+ * plane still cast) and a polygon offset against acne.
+ */
+class CascadedShadowMaps
+{
+private:
+    bool initialized;
+    GLuint staticDepth;         // Cached static casters
+    GLuint shadowDepth;         // Static + dynamic, sampled by shaders
+    GLuint drawFramebuffer;
+    GLuint copyFramebuffer;
+    GLuint compareSampler;
+    int resolution;
+    int layerCount;
+
+    // Last render()
+    bool active;
+    int cascadeCount;
+    mat4 matrices[ShadowFrame::MAX_CASCADES];
+    float splits[ShadowFrame::MAX_CASCADES];
+    float texelSizes[ShadowFrame::MAX_CASCADES];
+    bool layerHasDynamic[ShadowFrame::MAX_CASCADES];
+    int staticLayersDrawn;
+    int layersComposited;
+
+    float slopeBias;
+    float constantBias;
+
+    void attach(GLenum target, GLuint texture, int layer)
+    {
+        GL::FramebufferTextureLayer(target, GL_DEPTH_ATTACHMENT, texture, 0, layer);
+    }
+
+    static GLuint createDepthArray(int size, int layers)
+    {
+        GLuint texture = 0;
+        GL::GenTextures(1, &texture);
+        GL::BindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        GL::TexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, size, size, layers, 0,
+                       GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        GL::TexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        GL::TexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        GL::TexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        GL::TexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        GL::TexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        GL::TexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        GL::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        return texture;
+    }
+
+    void deleteTextures()
+    {
+        if (staticDepth != 0)
+            GL::DeleteTextures(1, &staticDepth);
+        if (shadowDepth != 0)
+            GL::DeleteTextures(1, &shadowDepth);
+        staticDepth = shadowDepth = 0;
+        resolution = layerCount = 0;
+    }
+
+public:
+    CascadedShadowMaps()
+        : initialized(false), staticDepth(0), shadowDepth(0), drawFramebuffer(0), copyFramebuffer(0),
+          compareSampler(0), resolution(0), layerCount(0), active(false), cascadeCount(0),
+          staticLayersDrawn(0), layersComposited(0), slopeBias(2.0f), constantBias(4.0f)
+    {
+        std::fill(std::begin(splits), std::end(splits), 0.0f);
+        std::fill(std::begin(texelSizes), std::end(texelSizes), 0.0f);
+        std::fill(std::begin(layerHasDynamic), std::end(layerHasDynamic), false);
+    }
+
+    ~CascadedShadowMaps()
+    {
+        cleanup();
+    }
+
+    CascadedShadowMaps(const CascadedShadowMaps&) = delete;
+    CascadedShadowMaps& operator=(const CascadedShadowMaps&) = delete;
+
+    /**
+     * @brief Create the framebuffers and sampler (needs a GL context)
+     * Depth textures are created by resize() once a frame asks for them.
+     */
+    void initialize()
+    {
+        if (initialized)
+            return;
+        GL::GenFramebuffers(1, &drawFramebuffer);
+        GL::GenFramebuffers(1, &copyFramebuffer);
+
+        // Units may also hold material samplers; this one keeps comparison on
+        GL::GenSamplers(1, &compareSampler);
+        GL::SamplerParameteri(compareSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        GL::SamplerParameteri(compareSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        GL::SamplerParameteri(compareSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        GL::SamplerParameteri(compareSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        GL::SamplerParameteri(compareSampler, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        GL::SamplerParameteri(compareSampler, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        initialized = true;
+    }
+
+    void cleanup()
+    {
+        if (!initialized)
+            return;
+        deleteTextures();
+        GL::DeleteFramebuffers(1, &drawFramebuffer);
+        GL::DeleteFramebuffers(1, &copyFramebuffer);
+        GL::DeleteSamplers(1, &compareSampler);
+        drawFramebuffer = copyFramebuffer = compareSampler = 0;
+        active = false;
+        initialized = false;
+    }
+
+    /**
+     * @brief Make sure the depth arrays match a frame's size
+     * @return true if the textures were (re)created, which binds textures
+     *         on the active unit and drops every cached layer
+     */
+    bool resize(int size, int layers)
+    {
+        if (!initialized || (size == resolution && layers <= layerCount))
+            return false;
+
+        deleteTextures();
+        staticDepth = createDepthArray(size, layers);
+        shadowDepth = createDepthArray(size, layers);
+        resolution = size;
+        layerCount = layers;
+        std::fill(std::begin(layerHasDynamic), std::end(layerHasDynamic), true);
+        return true;
+    }
+
+    /**
+     * @brief Draw a frame's shadow casters
+     * @param frame Cascades from ShadowView (call resize() first)
+     * @param drawCasters Callable drawCasters(const std::vector<RenderCommand>&, const mat4& viewProjection)
+     *        drawing depth only with the current framebuffer and state
+     *
+     * The viewport and draw framebuffer are restored afterwards.
+     */
+    template<typename DrawFn>
+    void render(const ShadowFrame& frame, DrawFn&& drawCasters)
+    {
+        staticLayersDrawn = 0;
+        layersComposited = 0;
+        active = initialized && !frame.empty() && frame.resolution == resolution &&
+                 frame.cascadeCount <= layerCount;
+        if (!active)
+            return;
+
+        cascadeCount = frame.cascadeCount;
+        for (int i = 0; i < cascadeCount; i++)
+        {
+            matrices[i] = frame.cascades[i].viewProjection;
+            splits[i] = frame.cascades[i].splitDistance;
+            texelSizes[i] = frame.cascades[i].texelWorldSize;
+        }
+
+        // Nothing to draw: the sampled layers are already this frame's
+        bool work = false;
+        for (int i = 0; i < cascadeCount; i++)
+        {
+            const ShadowCascade& cascade = frame.cascades[i];
+            work = work || cascade.staticDirty || !cascade.dynamicCasters.empty() || layerHasDynamic[i];
+        }
+        if (!work)
+            return;
+
+        GLint viewport[4];
+        GLint previousFramebuffer = 0;
+        GL::GetIntegerv(GL_VIEWPORT, viewport);
+        GL::GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+        GL::BindFramebuffer(GL_FRAMEBUFFER, drawFramebuffer);
+        GL::DrawBuffer(GL_NONE);
+        GL::ReadBuffer(GL_NONE);
+        GL::Viewport(0, 0, resolution, resolution);
+        GL::DepthMask(GL_TRUE);
+        GL::Enable(GL_DEPTH_CLAMP);
+        GL::Enable(GL_POLYGON_OFFSET_FILL);
+        GL::PolygonOffset(slopeBias, constantBias);
+
+        for (int i = 0; i < cascadeCount; i++)
+        {
+            const ShadowCascade& cascade = frame.cascades[i];
+            if (cascade.staticDirty)
+            {
+                attach(GL_FRAMEBUFFER, staticDepth, i);
+                GL::Clear(GL_DEPTH_BUFFER_BIT);
+                drawCasters(cascade.staticCasters, cascade.viewProjection);
+                staticLayersDrawn++;
+            }
+
+            // Refresh the sampled layer only if it can differ from last frame's
+            bool hasDynamic = !cascade.dynamicCasters.empty();
+            if (cascade.staticDirty || hasDynamic || layerHasDynamic[i])
+            {
+                attach(GL_DRAW_FRAMEBUFFER, shadowDepth, i);
+                GL::BindFramebuffer(GL_READ_FRAMEBUFFER, copyFramebuffer);
+                attach(GL_READ_FRAMEBUFFER, staticDepth, i);
+                GL::ReadBuffer(GL_NONE);
+                GL::BlitFramebuffer(0, 0, resolution, resolution, 0, 0, resolution, resolution,
+                                    GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+                if (hasDynamic)
+                    drawCasters(cascade.dynamicCasters, cascade.viewProjection);
+                layersComposited++;
+            }
+            layerHasDynamic[i] = hasDynamic;
+        }
+
+        GL::Disable(GL_POLYGON_OFFSET_FILL);
+        GL::Disable(GL_DEPTH_CLAMP);
+        GL::BindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+        GL::Viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+
+    /**
+     * @brief Turn shadows off for shaders bound until the next render()
+     */
+    void disable() { active = false; }
+
+    /**
+     * @brief Set a shader's shadow uniforms (no-op for shaders without _ShadowMap)
+     * @param bindTexture Callable bindTexture(target, texture, sampler, unit)
+     */
+    template<typename BindFn>
+    void bind(Shader& shader, BindFn&& bindTexture) const
+    {
+        if (!initialized || !shader.hasSampler("_ShadowMap"))
+            return;
+
+        static const char* matrixNames[ShadowFrame::MAX_CASCADES] = {
+            "shadowMatrices[0]", "shadowMatrices[1]", "shadowMatrices[2]", "shadowMatrices[3]" };
+        static const char* splitNames[ShadowFrame::MAX_CASCADES] = {
+            "shadowSplits[0]", "shadowSplits[1]", "shadowSplits[2]", "shadowSplits[3]" };
+        static const char* texelNames[ShadowFrame::MAX_CASCADES] = {
+            "shadowTexelSizes[0]", "shadowTexelSizes[1]", "shadowTexelSizes[2]", "shadowTexelSizes[3]" };
+
+        int count = active ? cascadeCount : 0;
+        shader.setInt("shadowCascadeCount", count);
+        if (count == 0)
+            return;
+
+        bindTexture(GL_TEXTURE_2D_ARRAY, shadowDepth, compareSampler, shader.getSamplerUnit("_ShadowMap"));
+        for (int i = 0; i < count; i++)
+        {
+            shader.setMat4(matrixNames[i], matrices[i]);
+            shader.setFloat(splitNames[i], splits[i]);
+            shader.setFloat(texelNames[i], texelSizes[i]);
+        }
+    }
+
+    /**
+     * @brief Depth bias while drawing casters (glPolygonOffset factor and units)
+     */
+    void setDepthBias(float slope, float constant)
+    {
+        slopeBias = slope;
+        constantBias = constant;
+    }
+
+    bool isActive() const { return active; }
+    int getResolution() const { return resolution; }
+
+    /**
+     * @brief Cascades whose static cache was redrawn by the last render()
+     */
+    int getStaticLayersDrawn() const { return staticLayersDrawn; }
+
+    /**
+     * @brief Cascades whose sampled layer was refreshed by the last render()
+     */
+    int getLayersComposited() const { return layersComposited; }
+};
+
+#endif // CASCADED_SHADOW_MAPS_H
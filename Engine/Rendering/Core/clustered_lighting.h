@@ -0,0 +1,418 @@
+#ifndef CLUSTERED_LIGHTING_H
+#define CLUSTERED_LIGHTING_H
+
+#include "gl_dispatch.h"
+
+#include "../camera.h"
+#include "../light.h"
+#include "../Shaders/shader.h"
+#include "../../Math/mat4.h"
+#include "../../Math/simd.h"
+#include "../../Core/Systems/jobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file clustered_lighting.h
+ * @brief Froxel grid light assignment for forward shading
+ *
+ * The view frustum is split into GRID_X x GRID_Y screen tiles and GRID_Z
+ * exponential depth slices. Each frame every point/spot light is tested
+ * against the clusters its range can touch (four clusters per SIMD test)
+ * and the results are packed into three buffer textures:
+ * - _ClusterLights: all lights, directional ones first (4 RGBA32F texels each)
+ * - _ClusterGrid: first index and count per cluster (RG32UI)
+ * - _ClusterIndices: light indices grouped by cluster (R32UI)
+ *
+ * Shaders include DefaultShaders::CLUSTERED_LIGHTING and loop only over
+ * their cluster's lights, so per-fragment cost follows local light density
+ * rather than the scene's light count.
+ */
+class ClusteredLighting
+{
+public:
+    static constexpr int GRID_X = 16;  // Multiple of 4 (SIMD over columns)
+    static constexpr int GRID_Y = 9;
+    static constexpr int GRID_Z = 24;
+    static constexpr int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+    static constexpr int FLOATS_PER_LIGHT = 16;
+
+private:
+    struct BufferTexture
+    {
+        GLuint buffer = 0;
+        GLuint texture = 0;
+        GLenum format = 0;
+    };
+
+    // A point or spot light in view space (depth positive forward)
+    struct LocalLight
+    {
+        uint32_t index;      // Into the light texels
+        float x, y, depth;
+        float radius;
+        int tileX0, tileX1, tileY0, tileY1;
+    };
+
+    BufferTexture lightTexels;
+    BufferTexture gridTexels;
+    BufferTexture indexTexels;
+    bool initialized;
+
+    std::vector<float> lightData;
+    std::vector<uint32_t> gridData;
+    std::vector<uint32_t> indexData;
+
+    std::vector<LocalLight> localLights;
+    std::vector<std::vector<uint32_t>> sliceLights;    // Local lights overlapping each slice
+    std::vector<std::vector<uint32_t>> clusterLists;   // Light indices per cluster
+
+    // Cluster bounds in view space; separable, so X extents depend only on
+    // (slice, column), Y extents on (slice, row)
+    float sliceNear[GRID_Z];
+    float sliceFar[GRID_Z];
+    alignas(16) float tileMinX[GRID_Z][GRID_X];
+    alignas(16) float tileMaxX[GRID_Z][GRID_X];
+    float tileMinY[GRID_Z][GRID_Y];
+    float tileMaxY[GRID_Z][GRID_Y];
+
+    // Projection the bounds were built for
+    float projectionX, projectionY, nearPlane, farPlane;
+    float depthScale, depthBias;
+
+    int directionalCount;
+    size_t maxClusterLights;
+
+    void createBufferTexture(BufferTexture& target, GLenum format)
+    {
+        target.format = format;
+        GL::GenBuffers(1, &target.buffer);
+        GL::BindBuffer(GL_TEXTURE_BUFFER, target.buffer);
+        GL::BufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+        GL::GenTextures(1, &target.texture);
+        GL::BindTexture(GL_TEXTURE_BUFFER, target.texture);
+        GL::TexBuffer(GL_TEXTURE_BUFFER, format, target.buffer);
+        GL::BindTexture(GL_TEXTURE_BUFFER, 0);
+        GL::BindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    static void deleteBufferTexture(BufferTexture& target)
+    {
+        if (target.texture != 0)
+            GL::DeleteTextures(1, &target.texture);
+        if (target.buffer != 0)
+            GL::DeleteBuffers(1, &target.buffer);
+        target.texture = target.buffer = 0;
+    }
+
+    /**
+     * Orphan and refill a buffer (the texture keeps pointing at it)
+     */
+    static void upload(const BufferTexture& target, const void* data, size_t bytes)
+    {
+        GL::BindBuffer(GL_TEXTURE_BUFFER, target.buffer);
+        GL::BufferData(GL_TEXTURE_BUFFER, std::max<size_t>(bytes, 16), nullptr, GL_STREAM_DRAW);
+        if (bytes > 0)
+            GL::BufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+        GL::BindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    int sliceOf(float depth) const
+    {
+        int slice = static_cast<int>(std::log(std::max(depth, 1e-4f)) * depthScale + depthBias);
+        return std::clamp(slice, 0, GRID_Z - 1);
+    }
+
+    static int tileOf(float ndc, int count)
+    {
+        return std::clamp(static_cast<int>((ndc * 0.5f + 0.5f) * count), 0, count - 1);
+    }
+
+    /**
+     * Rebuild the cluster bounds when the projection changed
+     */
+    void updateBounds(const Camera& camera)
+    {
+        mat4 projection = camera.getProjectionMatrix();
+        float px = projection.m[0][0];
+        float py = projection.m[1][1];
+        if (px == projectionX && py == projectionY &&
+            camera.nearPlane == nearPlane && camera.farPlane == farPlane)
+            return;
+
+        projectionX = px;
+        projectionY = py;
+        nearPlane = camera.nearPlane;
+        farPlane = camera.farPlane;
+
+        float logRatio = std::log(farPlane / nearPlane);
+        depthScale = GRID_Z / logRatio;
+        depthBias = -GRID_Z * std::log(nearPlane) / logRatio;
+
+        for (int z = 0; z < GRID_Z; z++)
+        {
+            float nearDepth = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z) / GRID_Z);
+            float farDepth = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z + 1) / GRID_Z);
+            sliceNear[z] = nearDepth;
+            sliceFar[z] = farDepth;
+
+            // View-space x = ndc * depth / P00, extremes at the slice's two depths
+            for (int x = 0; x < GRID_X; x++)
+            {
+                float ndc0 = -1.0f + 2.0f * x / GRID_X;
+                float ndc1 = -1.0f + 2.0f * (x + 1) / GRID_X;
+                tileMinX[z][x] = std::min(ndc0 * nearDepth, ndc0 * farDepth) / px;
+                tileMaxX[z][x] = std::max(ndc1 * nearDepth, ndc1 * farDepth) / px;
+            }
+            for (int y = 0; y < GRID_Y; y++)
+            {
+                float ndc0 = -1.0f + 2.0f * y / GRID_Y;
+                float ndc1 = -1.0f + 2.0f * (y + 1) / GRID_Y;
+                tileMinY[z][y] = std::min(ndc0 * nearDepth, ndc0 * farDepth) / py;
+                tileMaxY[z][y] = std::max(ndc1 * nearDepth, ndc1 * farDepth) / py;
+            }
+        }
+    }
+
+    /**
+     * Write one light's texels (position/type, direction/intensity, color/range, cone)
+     */
+    void packLight(const Light& light, size_t index)
+    {
+        float* out = lightData.data() + index * FLOATS_PER_LIGHT;
+        float type = light.type == Light::Type::Directional ? 0.0f : (light.type == Light::Type::Point ? 1.0f : 2.0f);
+        vec3 direction = light.direction.length() > 0.0f ? light.direction.normalized() : vec3(0, -1, 0);
+        float halfAngle = light.spotAngle * 0.5f;
+
+        out[0] = light.position.x;  out[1] = light.position.y;  out[2] = light.position.z;  out[3] = type;
+        out[4] = direction.x;       out[5] = direction.y;       out[6] = direction.z;       out[7] = light.intensity;
+        out[8] = light.color.x;     out[9] = light.color.y;     out[10] = light.color.z;    out[11] = light.range;
+        out[12] = std::cos(halfAngle);
+        out[13] = std::cos(halfAngle * 0.8f);  // Inner cone: soft edge over the outer 20%
+        out[14] = 0.0f;
+        out[15] = 0.0f;
+    }
+
+    /**
+     * Test the local lights binned to one slice against its clusters
+     */
+    void assignSlice(int z)
+    {
+        for (int y = 0; y < GRID_Y; y++)
+            for (int x = 0; x < GRID_X; x++)
+                clusterLists[(z * GRID_Y + y) * GRID_X + x].clear();
+
+        for (uint32_t l : sliceLights[z])
+        {
+            const LocalLight& light = localLights[l];
+            float radius2 = light.radius * light.radius;
+            float dz = std::max({ sliceNear[z] - light.depth, 0.0f, light.depth - sliceFar[z] });
+            float remainingZ = radius2 - dz * dz;
+            if (remainingZ < 0.0f)
+                continue;
+
+            float4 centerX(light.x);
+            int firstColumn = light.tileX0 & ~3;
+            for (int y = light.tileY0; y <= light.tileY1; y++)
+            {
+                float dy = std::max({ tileMinY[z][y] - light.y, 0.0f, light.y - tileMaxY[z][y] });
+                float4 remaining(remainingZ - dy * dy);
+
+                // Squared distance to four columns' x extents at once
+                for (int x = firstColumn; x <= light.tileX1; x += 4)
+                {
+                    float4 dx = float4::max(float4::max(float4::load(&tileMinX[z][x]) - centerX,
+                                                        centerX - float4::load(&tileMaxX[z][x])),
+                                            float4(0.0f));
+                    int hits = float4::mask(dx * dx <= remaining);
+                    for (int lane = 0; lane < 4; lane++)
+                    {
+                        int column = x + lane;
+                        if ((hits & (1 << lane)) && column >= light.tileX0 && column <= light.tileX1)
+                            clusterLists[(z * GRID_Y + y) * GRID_X + column].push_back(light.index);
+                    }
+                }
+            }
+        }
+    }
+
+public:
+    ClusteredLighting()
+        : initialized(false),
+          projectionX(0.0f), projectionY(0.0f), nearPlane(0.0f), farPlane(0.0f),
+          depthScale(0.0f), depthBias(0.0f), directionalCount(0), maxClusterLights(0)
+    {
+        sliceLights.resize(GRID_Z);
+        clusterLists.resize(CLUSTER_COUNT);
+    }
+
+    ~ClusteredLighting()
+    {
+        cleanup();
+    }
+
+    ClusteredLighting(const ClusteredLighting&) = delete;
+    ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+    /**
+     * @brief Create the buffer textures (needs a GL context)
+     */
+    void initialize()
+    {
+        if (initialized)
+            return;
+        createBufferTexture(lightTexels, GL_RGBA32F);
+        createBufferTexture(gridTexels, GL_RG32UI);
+        createBufferTexture(indexTexels, GL_R32UI);
+        initialized = true;
+    }
+
+    void cleanup()
+    {
+        if (!initialized)
+            return;
+        deleteBufferTexture(lightTexels);
+        deleteBufferTexture(gridTexels);
+        deleteBufferTexture(indexTexels);
+        initialized = false;
+    }
+
+    /**
+     * @brief Assign lights to clusters for a camera (CPU only)
+     * Point and spot lights are bounded by Light::range; directional lights
+     * go first in the light list and are not clustered.
+     */
+    void assign(const Camera& camera, const std::vector<Light>& lights)
+    {
+        updateBounds(camera);
+
+        lightData.assign(lights.size() * FLOATS_PER_LIGHT, 0.0f);
+        directionalCount = 0;
+        for (const auto& light : lights)
+        {
+            if (light.type == Light::Type::Directional)
+                packLight(light, directionalCount++);
+        }
+
+        // Local lights: view-space sphere, depth slices and a conservative tile rect
+        mat4 view = camera.getViewMatrix();
+        localLights.clear();
+        for (auto& slice : sliceLights)
+            slice.clear();
+
+        uint32_t index = static_cast<uint32_t>(directionalCount);
+        for (const auto& light : lights)
+        {
+            if (light.type == Light::Type::Directional)
+                continue;
+            packLight(light, index);
+
+            vec3 center = view.transformPoint(light.position);
+            float depth = -center.z;
+            float radius = light.range;
+            if (radius <= 0.0f || depth + radius < nearPlane || depth - radius > farPlane)
+            {
+                index++;
+                continue;
+            }
+
+            // x / depth is monotonic in both, so the box's corners bound the sphere on screen
+            float minDepth = std::max(depth - radius, nearPlane);
+            float maxDepth = depth + radius;
+            float x0 = std::min((center.x - radius) / minDepth, (center.x - radius) / maxDepth) * projectionX;
+            float x1 = std::max((center.x + radius) / minDepth, (center.x + radius) / maxDepth) * projectionX;
+            float y0 = std::min((center.y - radius) / minDepth, (center.y - radius) / maxDepth) * projectionY;
+            float y1 = std::max((center.y + radius) / minDepth, (center.y + radius) / maxDepth) * projectionY;
+            if (x0 > 1.0f || x1 < -1.0f || y0 > 1.0f || y1 < -1.0f)
+            {
+                index++;
+                continue;
+            }
+
+            LocalLight local;
+            local.index = index++;
+            local.x = center.x;
+            local.y = center.y;
+            local.depth = depth;
+            local.radius = radius;
+            local.tileX0 = tileOf(x0, GRID_X);
+            local.tileX1 = tileOf(x1, GRID_X);
+            local.tileY0 = tileOf(y0, GRID_Y);
+            local.tileY1 = tileOf(y1, GRID_Y);
+
+            uint32_t localIndex = static_cast<uint32_t>(localLights.size());
+            localLights.push_back(local);
+            int lastSlice = sliceOf(std::min(maxDepth, farPlane));
+            for (int z = sliceOf(minDepth); z <= lastSlice; z++)
+                sliceLights[z].push_back(localIndex);
+        }
+
+        // Slices touch disjoint clusters, so they run in parallel
+        JobSystem::getInstance().parallelFor(GRID_Z, 1, [this](size_t first, size_t last) {
+            for (size_t z = first; z < last; z++)
+                assignSlice(static_cast<int>(z));
+        });
+
+        gridData.resize(CLUSTER_COUNT * 2);
+        indexData.clear();
+        maxClusterLights = 0;
+        for (int cluster = 0; cluster < CLUSTER_COUNT; cluster++)
+        {
+            const auto& list = clusterLists[cluster];
+            gridData[cluster * 2] = static_cast<uint32_t>(indexData.size());
+            gridData[cluster * 2 + 1] = static_cast<uint32_t>(list.size());
+            indexData.insert(indexData.end(), list.begin(), list.end());
+            maxClusterLights = std::max(maxClusterLights, list.size());
+        }
+    }
+
+    /**
+     * @brief Assign lights and upload the three buffers
+     */
+    void update(const Camera& camera, const std::vector<Light>& lights)
+    {
+        assign(camera, lights);
+        if (!initialized)
+            return;
+        upload(lightTexels, lightData.data(), lightData.size() * sizeof(float));
+        upload(gridTexels, gridData.data(), gridData.size() * sizeof(uint32_t));
+        upload(indexTexels, indexData.data(), indexData.size() * sizeof(uint32_t));
+    }
+
+    /**
+     * @brief Bind the buffers and grid uniforms for a program in use
+     * @param bindTexture Callable bindTexture(GLenum target, GLuint texture, int unit)
+     * Programs without the CLUSTERED_LIGHTING samplers are left alone.
+     */
+    template<typename BindFn>
+    void bind(Shader& shader, BindFn&& bindTexture) const
+    {
+        if (!initialized || !shader.hasSampler("_ClusterGrid"))
+            return;
+
+        bindTexture(GL_TEXTURE_BUFFER, lightTexels.texture, shader.getSamplerUnit("_ClusterLights"));
+        bindTexture(GL_TEXTURE_BUFFER, gridTexels.texture, shader.getSamplerUnit("_ClusterGrid"));
+        bindTexture(GL_TEXTURE_BUFFER, indexTexels.texture, shader.getSamplerUnit("_ClusterIndices"));
+        shader.setVec3("clusterDims", vec3(GRID_X, GRID_Y, GRID_Z));
+        shader.setFloat("clusterDepthScale", depthScale);
+        shader.setFloat("clusterDepthBias", depthBias);
+        shader.setInt("directionalLightCount", directionalCount);
+    }
+
+    /**
+     * @brief Lights of one cluster from the last assign() (for debugging/tests)
+     */
+    const std::vector<uint32_t>& getClusterLights(int x, int y, int z) const
+    {
+        return clusterLists[(z * GRID_Y + y) * GRID_X + x];
+    }
+
+    int getDirectionalLightCount() const { return directionalCount; }
+    size_t getLightCount() const { return lightData.size() / FLOATS_PER_LIGHT; }
+    size_t getIndexCount() const { return indexData.size(); }
+    size_t getMaxClusterLightCount() const { return maxClusterLights; }
+};
+
+#endif // CLUSTERED_LIGHTING_H
@@ -0,0 +1,279 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include "gl_dispatch.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @struct CapturedFrame
+ * @brief Pixels read back from a framebuffer
+ */
+struct CapturedFrame
+{
+    uint64_t frameIndex = 0;      // Order of the capture() call, from 0
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;  // RGBA8, top row first
+
+    /**
+     * @brief Save as a binary PPM image (alpha dropped)
+     */
+    bool saveToPPM(const std::string& filename) const
+    {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file)
+            return false;
+        file << "P6\n" << width << " " << height << "\n255\n";
+        std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+        for (int y = 0; y < height; y++)
+        {
+            const uint8_t* source = pixels.data() + static_cast<size_t>(y) * width * 4;
+            for (int x = 0; x < width; x++)
+            {
+                row[x * 3 + 0] = source[x * 4 + 0];
+                row[x * 3 + 1] = source[x * 4 + 1];
+                row[x * 3 + 2] = source[x * 4 + 2];
+            }
+            file.write(reinterpret_cast<const char*>(row.data()), row.size());
+        }
+        return static_cast<bool>(file);
+    }
+};
+
+/**
+ * @class FrameCapture
+ * @brief Asynchronous framebuffer readback through a ring of pixel buffers
+ *
+ * capture() only queues a copy of the framebuffer into the next pixel pack
+ * buffer and a fence after it; the GPU does the copy when it gets there.
+ * poll() maps the buffers whose fence has signaled and hands their pixels
+ * to the callback, without ever waiting. With the default ring of 3, frame
+ * N is typically read while N+2 renders; capture() only blocks (counted by
+ * getStallCount) when the GPU falls a whole ring behind.
+ *
+ * Frames are delivered in capture order, on the thread that owns the
+ * context (the render thread, when one runs).
+ *
+ * @code
+ * FrameCapture capture;
+ * capture.initialize();
+ * capture.setCallback([](const CapturedFrame& frame) { frame.saveToPPM("frame.ppm"); });
+ * // Each frame, after flush():
+ * capture.capture(0, width, height);
+ * capture.poll();
+ * // At the end:
+ * capture.finish();
+ * @endcode
+ */
+class FrameCapture
+{
+public:
+    using Callback = std::function<void(const CapturedFrame&)>;
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        size_t capacity = 0;     // Bytes allocated for buffer
+        GLsync fence = nullptr;  // Set while a readback is in flight
+        uint64_t frameIndex = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    static constexpr GLuint64 WAIT_NANOSECONDS = 1000000000ull;  // Per blocking wait (retried)
+
+    std::vector<Slot> slots;
+    size_t oldest;   // Next slot to deliver
+    size_t pending;  // Readbacks in flight
+    bool initialized;
+
+    Callback callback;
+    CapturedFrame frame;  // Reused between deliveries
+    uint64_t capturedCount;
+    uint64_t deliveredCount;
+    uint64_t stallCount;
+
+    /**
+     * @brief Deliver the oldest readback if its fence has signaled
+     * @param timeout Nanoseconds to wait for the fence (0 = just check)
+     */
+    bool deliverOldest(GLuint64 timeout)
+    {
+        Slot& slot = slots[oldest];
+        GLenum result = GL::ClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        if (result == GL_TIMEOUT_EXPIRED)
+            return false;
+        GL::DeleteSync(slot.fence);
+        slot.fence = nullptr;
+        oldest = (oldest + 1) % slots.size();
+        pending--;
+        if (result == GL_WAIT_FAILED)
+            return true;  // Lost (e.g. context reset); skip it
+
+        size_t rowBytes = static_cast<size_t>(slot.width) * 4;
+        size_t size = rowBytes * slot.height;
+        GL::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        const uint8_t* mapped = static_cast<const uint8_t*>(
+            GL::MapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT));
+        if (mapped)
+        {
+            frame.frameIndex = slot.frameIndex;
+            frame.width = slot.width;
+            frame.height = slot.height;
+            frame.pixels.resize(size);
+
+            // GL rows start at the bottom
+            for (int y = 0; y < slot.height; y++)
+                std::memcpy(frame.pixels.data() + y * rowBytes, mapped + (slot.height - 1 - y) * rowBytes, rowBytes);
+            GL::UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        GL::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        if (mapped)
+        {
+            deliveredCount++;
+            if (callback)
+                callback(frame);
+        }
+        return true;
+    }
+
+public:
+    /**
+     * @param ringSize Readbacks in flight before capture() has to wait (at least 2)
+     */
+    explicit FrameCapture(size_t ringSize = 3)
+        : slots(std::max<size_t>(ringSize, 2)), oldest(0), pending(0), initialized(false),
+          capturedCount(0), deliveredCount(0), stallCount(0)
+    {
+    }
+
+    ~FrameCapture()
+    {
+        cleanup();
+    }
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    /**
+     * @brief Create the pixel buffers (needs a GL context)
+     * Their storage is sized by the first capture.
+     */
+    void initialize()
+    {
+        if (initialized)
+            return;
+        for (auto& slot : slots)
+            GL::GenBuffers(1, &slot.buffer);
+        initialized = true;
+    }
+
+    /**
+     * @brief Drop readbacks still in flight and delete the buffers
+     */
+    void cleanup()
+    {
+        if (!initialized)
+            return;
+        for (auto& slot : slots)
+        {
+            if (slot.fence)
+                GL::DeleteSync(slot.fence);
+            GL::DeleteBuffers(1, &slot.buffer);
+            slot = Slot();
+        }
+        oldest = pending = 0;
+        initialized = false;
+    }
+
+    /**
+     * @brief Called with every frame read back (the frame is only valid during the call)
+     */
+    void setCallback(Callback onFrame) { callback = std::move(onFrame); }
+
+    /**
+     * @brief Queue a readback of a framebuffer's color
+     * @param framebuffer FBO to read (RenderTarget::getFramebuffer), 0 = the window
+     * @param width Width in pixels, from the lower left corner
+     * @param height Height in pixels
+     * @return false if not initialized or the size is empty
+     */
+    bool capture(GLuint framebuffer, int width, int height)
+    {
+        if (!initialized || width <= 0 || height <= 0)
+            return false;
+
+        // Ring full: the GPU is a whole ring behind, so wait for the oldest
+        if (pending == slots.size())
+        {
+            stallCount++;
+            while (!deliverOldest(WAIT_NANOSECONDS)) {}
+        }
+
+        size_t index = (oldest + pending) % slots.size();
+        Slot& slot = slots[index];
+        size_t size = static_cast<size_t>(width) * height * 4;
+        GL::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        if (slot.capacity < size)
+        {
+            GL::BufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+            slot.capacity = size;
+        }
+
+        GLint previousRead = 0;
+        GL::GetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead);
+        GL::BindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        GL::ReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);  // Into the bound buffer
+        GL::BindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(previousRead));
+        GL::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.fence = GL::FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.frameIndex = capturedCount++;
+        slot.width = width;
+        slot.height = height;
+        pending++;
+        return true;
+    }
+
+    /**
+     * @brief Deliver every finished readback, oldest first, without waiting
+     * @return Number of frames delivered
+     */
+    size_t poll()
+    {
+        size_t delivered = 0;
+        while (pending > 0 && deliverOldest(0))
+            delivered++;
+        return delivered;
+    }
+
+    /**
+     * @brief Wait for and deliver all readbacks in flight (e.g. before shutdown)
+     */
+    void finish()
+    {
+        while (pending > 0)
+            deliverOldest(WAIT_NANOSECONDS);
+    }
+
+    size_t getRingSize() const { return slots.size(); }
+    size_t getPendingCount() const { return pending; }
+    uint64_t getCapturedCount() const { return capturedCount; }
+    uint64_t getDeliveredCount() const { return deliveredCount; }
+
+    /**
+     * @brief Captures that had to wait for an older readback to finish
+     */
+    uint64_t getStallCount() const { return stallCount; }
+};
+
+#endif // FRAME_CAPTURE_H
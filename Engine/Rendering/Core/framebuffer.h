@@ -28,14 +28,21 @@ public:
      * @brief Construct a new Framebuffer object
      * @param w Width of the framebuffer
      * @param h Height of the framebuffer
+     * @param withColor false for a depth-only buffer (color writes are ignored)
      */
-    Framebuffer(int w, int h)
+    Framebuffer(int w, int h, bool withColor = true)
         : width(w), height(h)
     {
-        colorBuffer.resize(width * height, color(0, 0, 0));
+        if (withColor)
+            colorBuffer.resize(width * height, color(0, 0, 0));
         depthBuffer.resize(width * height, 1.0f); // Use 1.0 for far plane (depth range [0,1])
     }
 
+    /**
+     * @brief Check whether this framebuffer stores color
+     */
+    bool hasColor() const { return !colorBuffer.empty(); }
+
     /**
      * @brief Clear the framebuffer with a specified color
      * @param clearColor Color to clear the framebuffer with
@@ -46,6 +53,15 @@ public:
         std::fill(depthBuffer.begin(), depthBuffer.end(), 1.0f); // Clear to far plane
     }
 
+    /**
+     * @brief Clear only the depth buffer
+     * @param depth Value to clear to (1 = far plane)
+     */
+    void clearDepth(float depth = 1.0f)
+    {
+        std::fill(depthBuffer.begin(), depthBuffer.end(), depth);
+    }
+
     /**
      * @brief Set a pixel color at specified coordinates
      * @param x X coordinate
@@ -54,7 +70,7 @@ public:
      */
     void setPixel(int x, int y, const color& col)
     {
-        if (x >= 0 && x < width && y >= 0 && y < height)
+        if (hasColor() && x >= 0 && x < width && y >= 0 && y < height)
         {
             colorBuffer[y * width + x] = col;
         }
@@ -75,7 +91,8 @@ public:
             if (depth < depthBuffer[index])
             {
                 depthBuffer[index] = depth;
-                colorBuffer[index] = col;
+                if (hasColor())
+                    colorBuffer[index] = col;
             }
         }
     }
@@ -88,7 +105,7 @@ public:
      */
     color getPixel(int x, int y) const
     {
-        if (x >= 0 && x < width && y >= 0 && y < height)
+        if (hasColor() && x >= 0 && x < width && y >= 0 && y < height)
         {
             return colorBuffer[y * width + x];
         }
@@ -161,9 +178,11 @@ public:
      */
     void resize(int newWidth, int newHeight)
     {
+        bool withColor = hasColor();
         width = newWidth;
         height = newHeight;
-        colorBuffer.resize(width * height);
+        if (withColor)
+            colorBuffer.resize(width * height);
         depthBuffer.resize(width * height);
         clear();
     }
@@ -175,6 +194,8 @@ public:
     std::vector<unsigned char> getPixelData() const
     {
         std::vector<unsigned char> pixels(width * height * 3);
+        if (!hasColor())
+            return pixels;
         
         for (int i = 0; i < width * height; i++)
         {
@@ -0,0 +1,157 @@
+#ifndef GL_DISPATCH_H
+#define GL_DISPATCH_H
+
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl3.h>
+#else
+#include <GL/glew.h>
+#endif
+
+/**
+ * @file gl_dispatch.h
+ * @brief Indirection over every OpenGL entry point the engine uses
+ *
+ * Engine code calls GL::BindBuffer(...) instead of glBindBuffer(...).
+ * Each call goes through the active GL::Table, which by default forwards
+ * to the driver. GLRecorder (gl_recorder.h) installs a null table instead,
+ * so the renderer's CPU side can run, be counted and be benchmarked
+ * without a context or GPU.
+ *
+ * To use another GL function, add it to ENGINE_GL_FUNCTIONS (and, if it
+ * returns a value, a handler in GLRecorder).
+ */
+
+// X(return type, name without the gl prefix, parameter list, argument list)
+#define ENGINE_GL_FUNCTIONS(X) \
+    X(void, ActiveTexture, (GLenum texture), (texture)) \
+    X(void, AttachShader, (GLuint program, GLuint shader), (program, shader)) \
+    X(void, BindBuffer, (GLenum target, GLuint buffer), (target, buffer)) \
+    X(void, BindBufferBase, (GLenum target, GLuint index, GLuint buffer), (target, index, buffer)) \
+    X(void, BindFramebuffer, (GLenum target, GLuint framebuffer), (target, framebuffer)) \
+    X(void, BindSampler, (GLuint unit, GLuint sampler), (unit, sampler)) \
+    X(void, BindTexture, (GLenum target, GLuint texture), (target, texture)) \
+    X(void, BindVertexArray, (GLuint array), (array)) \
+    X(void, BlitFramebuffer, (GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter), (srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter)) \
+    X(void, BufferData, (GLenum target, GLsizeiptr size, const void* data, GLenum usage), (target, size, data, usage)) \
+    X(void, BufferSubData, (GLenum target, GLintptr offset, GLsizeiptr size, const void* data), (target, offset, size, data)) \
+    X(GLenum, CheckFramebufferStatus, (GLenum target), (target)) \
+    X(void, Clear, (GLbitfield mask), (mask)) \
+    X(void, ClearColor, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha), (red, green, blue, alpha)) \
+    X(GLenum, ClientWaitSync, (GLsync sync, GLbitfield flags, GLuint64 timeout), (sync, flags, timeout)) \
+    X(void, ColorMask, (GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha), (red, green, blue, alpha)) \
+    X(void, CompileShader, (GLuint shader), (shader)) \
+    X(GLuint, CreateProgram, (), ()) \
+    X(GLuint, CreateShader, (GLenum type), (type)) \
+    X(void, CullFace, (GLenum mode), (mode)) \
+    X(void, DeleteBuffers, (GLsizei n, const GLuint* buffers), (n, buffers)) \
+    X(void, DeleteFramebuffers, (GLsizei n, const GLuint* framebuffers), (n, framebuffers)) \
+    X(void, DeleteProgram, (GLuint program), (program)) \
+    X(void, DeleteSamplers, (GLsizei n, const GLuint* samplers), (n, samplers)) \
+    X(void, DeleteShader, (GLuint shader), (shader)) \
+    X(void, DeleteSync, (GLsync sync), (sync)) \
+    X(void, DeleteTextures, (GLsizei n, const GLuint* textures), (n, textures)) \
+    X(void, DeleteVertexArrays, (GLsizei n, const GLuint* arrays), (n, arrays)) \
+    X(void, DepthFunc, (GLenum func), (func)) \
+    X(void, DepthMask, (GLboolean flag), (flag)) \
+    X(void, Disable, (GLenum cap), (cap)) \
+    X(void, DrawBuffer, (GLenum buffer), (buffer)) \
+    X(void, DrawElements, (GLenum mode, GLsizei count, GLenum type, const void* indices), (mode, count, type, indices)) \
+    X(void, Enable, (GLenum cap), (cap)) \
+    X(void, EnableVertexAttribArray, (GLuint index), (index)) \
+    X(GLsync, FenceSync, (GLenum condition, GLbitfield flags), (condition, flags)) \
+    X(void, FramebufferTexture2D, (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level), (target, attachment, textarget, texture, level)) \
+    X(void, FramebufferTextureLayer, (GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer), (target, attachment, texture, level, layer)) \
+    X(void, FrontFace, (GLenum mode), (mode)) \
+    X(void, GenBuffers, (GLsizei n, GLuint* buffers), (n, buffers)) \
+    X(void, GenFramebuffers, (GLsizei n, GLuint* framebuffers), (n, framebuffers)) \
+    X(void, GenSamplers, (GLsizei n, GLuint* samplers), (n, samplers)) \
+    X(void, GenTextures, (GLsizei n, GLuint* textures), (n, textures)) \
+    X(void, GenVertexArrays, (GLsizei n, GLuint* arrays), (n, arrays)) \
+    X(void, GenerateMipmap, (GLenum target), (target)) \
+    X(void, GetActiveUniform, (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* uniformName), (program, index, bufSize, length, size, type, uniformName)) \
+    X(void, GetIntegerv, (GLenum pname, GLint* data), (pname, data)) \
+    X(void, GetProgramInfoLog, (GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog), (program, bufSize, length, infoLog)) \
+    X(void, GetProgramiv, (GLuint program, GLenum pname, GLint* value), (program, pname, value)) \
+    X(void, GetShaderInfoLog, (GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog), (shader, bufSize, length, infoLog)) \
+    X(void, GetShaderiv, (GLuint shader, GLenum pname, GLint* value), (shader, pname, value)) \
+    X(const GLubyte*, GetString, (GLenum which), (which)) \
+    X(GLuint, GetUniformBlockIndex, (GLuint program, const GLchar* blockName), (program, blockName)) \
+    X(GLint, GetUniformLocation, (GLuint program, const GLchar* uniformName), (program, uniformName)) \
+    X(void, LinkProgram, (GLuint program), (program)) \
+    X(void*, MapBufferRange, (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access), (target, offset, length, access)) \
+    X(void, PolygonMode, (GLenum face, GLenum mode), (face, mode)) \
+    X(void, PolygonOffset, (GLfloat factor, GLfloat units), (factor, units)) \
+    X(void, ReadBuffer, (GLenum source), (source)) \
+    X(void, ReadPixels, (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels), (x, y, width, height, format, type, pixels)) \
+    X(void, SamplerParameteri, (GLuint sampler, GLenum pname, GLint param), (sampler, pname, param)) \
+    X(void, ShaderSource, (GLuint shader, GLsizei count, const GLchar* const* source, const GLint* length), (shader, count, source, length)) \
+    X(void, TexBuffer, (GLenum target, GLenum internalFormat, GLuint buffer), (target, internalFormat, buffer)) \
+    X(void, TexImage2D, (GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels), (target, level, internalFormat, width, height, border, format, type, pixels)) \
+    X(void, TexImage3D, (GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels), (target, level, internalFormat, width, height, depth, border, format, type, pixels)) \
+    X(void, TexParameteri, (GLenum target, GLenum pname, GLint param), (target, pname, param)) \
+    X(void, TexSubImage3D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels), (target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels)) \
+    X(void, Uniform1f, (GLint location, GLfloat v0), (location, v0)) \
+    X(void, Uniform1i, (GLint location, GLint v0), (location, v0)) \
+    X(void, Uniform3f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2), (location, v0, v1, v2)) \
+    X(void, UniformBlockBinding, (GLuint program, GLuint blockIndex, GLuint binding), (program, blockIndex, binding)) \
+    X(void, UniformMatrix4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value), (location, count, transpose, value)) \
+    X(GLboolean, UnmapBuffer, (GLenum target), (target)) \
+    X(void, UseProgram, (GLuint program), (program)) \
+    X(void, VertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer), (index, size, type, normalized, stride, pointer)) \
+    X(void, Viewport, (GLint x, GLint y, GLsizei width, GLsizei height), (x, y, width, height))
+
+namespace GL
+{
+    /**
+     * @brief One function pointer per entry point
+     */
+    struct Table
+    {
+#define ENGINE_GL_TABLE_ENTRY(ret, name, parameters, arguments) ret (*name) parameters;
+        ENGINE_GL_FUNCTIONS(ENGINE_GL_TABLE_ENTRY)
+#undef ENGINE_GL_TABLE_ENTRY
+    };
+
+    /**
+     * @brief Table that calls the driver (resolved per call, so it works
+     * with loaders like GLEW that fill pointers after context creation)
+     */
+    inline const Table& driverTable()
+    {
+        static const Table table = {
+#define ENGINE_GL_DRIVER_ENTRY(ret, name, parameters, arguments) \
+            [] parameters -> ret { return gl##name arguments; },
+            ENGINE_GL_FUNCTIONS(ENGINE_GL_DRIVER_ENTRY)
+#undef ENGINE_GL_DRIVER_ENTRY
+        };
+        return table;
+    }
+
+    inline const Table*& activeTableSlot()
+    {
+        static const Table* active = &driverTable();
+        return active;
+    }
+
+    /**
+     * @brief Route all GL calls through a table (nullptr = driver)
+     * Switch only while no thread is issuing GL calls.
+     */
+    inline void setTable(const Table* table)
+    {
+        activeTableSlot() = table ? table : &driverTable();
+    }
+
+    inline const Table& table()
+    {
+        return *activeTableSlot();
+    }
+
+#define ENGINE_GL_FORWARD(ret, name, parameters, arguments) \
+    inline ret name parameters { return table().name arguments; }
+    ENGINE_GL_FUNCTIONS(ENGINE_GL_FORWARD)
+#undef ENGINE_GL_FORWARD
+}
+
+#endif // GL_DISPATCH_H
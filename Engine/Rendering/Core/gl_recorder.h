@@ -0,0 +1,591 @@
+#ifndef GL_RECORDER_H
+#define GL_RECORDER_H
+
+#include "gl_dispatch.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file gl_recorder.h
+ * @brief Null GL backend that counts, checks and records calls
+ *
+ * While a GLRecorder is installed every GL:: call is answered on the CPU
+ * (fake object names, successful compiles, scratch memory for mapped
+ * buffers) instead of reaching a driver, so OpenGLRenderer can be
+ * initialized and flushed without a window or GPU.
+ *
+ * @code
+ * GLRecorder recorder;
+ * recorder.install();
+ * OpenGLRenderer renderer;
+ * renderer.initialize();
+ * // ... submit, flush ...
+ * std::cout << recorder.getDrawCallCount() << " draws, "
+ *           << recorder.getRedundantCount() << " redundant state changes\n";
+ * @endcode
+ *
+ * Not thread-safe: issue GL calls from one thread while it is installed.
+ */
+
+/**
+ * @brief Identifies a dispatched GL function
+ */
+enum class GLFunction : uint16_t
+{
+#define ENGINE_GL_ENUM_ENTRY(ret, name, parameters, arguments) name,
+    ENGINE_GL_FUNCTIONS(ENGINE_GL_ENUM_ENTRY)
+#undef ENGINE_GL_ENUM_ENTRY
+    Count
+};
+
+constexpr size_t GL_FUNCTION_COUNT = static_cast<size_t>(GLFunction::Count);
+
+/**
+ * @brief Name of a GL function, with the gl prefix (e.g. "glDrawElements")
+ */
+inline const char* getGLFunctionName(GLFunction function)
+{
+    static const char* const names[] = {
+#define ENGINE_GL_NAME_ENTRY(ret, name, parameters, arguments) "gl" #name,
+        ENGINE_GL_FUNCTIONS(ENGINE_GL_NAME_ENTRY)
+#undef ENGINE_GL_NAME_ENTRY
+    };
+    size_t index = static_cast<size_t>(function);
+    return index < GL_FUNCTION_COUNT ? names[index] : "glUnknown";
+}
+
+/**
+ * @struct GLCall
+ * @brief One recorded call
+ *
+ * Holds the first four arguments: integers and enums by value, floats as
+ * their bit pattern (see getFloat), pointers as addresses.
+ */
+struct GLCall
+{
+    GLFunction function;
+    uint8_t argCount;           // Number of arguments stored (<= 4)
+    bool redundant;             // Set state to the value it already had
+    uint64_t args[4];
+
+    float getFloat(int index) const
+    {
+        uint32_t bits = static_cast<uint32_t>(args[index]);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+/**
+ * @class GLRecorder
+ * @brief Null/recording implementation of GL::Table
+ */
+class GLRecorder
+{
+private:
+    template<GLFunction F> struct Tag {};
+
+    /**
+     * @brief Last value written to one piece of GL state
+     * Matrices are the largest state we track (16 words).
+     */
+    struct StateValue
+    {
+        uint32_t count;
+        uint32_t words[16];
+    };
+
+    std::array<uint64_t, GL_FUNCTION_COUNT> callCounts;
+    std::array<uint64_t, GL_FUNCTION_COUNT> redundantCounts;
+    uint64_t totalCalls;
+    uint64_t indicesDrawn;
+
+    bool recording;
+    std::vector<GLCall> calls;
+
+    // Shadow state; keys from stateKey()
+    std::unordered_map<uint64_t, StateValue> state;
+    GLuint currentProgram;
+    GLuint currentVAO;
+    GLenum activeTextureUnit;
+    GLuint drawFramebuffer;
+    GLint viewport[4];
+
+    // Null object names and name lookups
+    GLuint nextObjectName;
+    std::unordered_map<std::string, GLint> uniformLocations;
+    std::unordered_map<std::string, GLuint> uniformBlockIndices;
+    std::unordered_map<GLenum, std::vector<uint8_t>> mappedBuffers;
+
+    bool installed;
+    bool lastCallRedundant;
+
+    static GLRecorder*& current()
+    {
+        static GLRecorder* recorder = nullptr;
+        return recorder;
+    }
+
+    /**
+     * @brief Key for a piece of state: the setter family plus a slot
+     * (capability, texture unit, uniform location, ...)
+     */
+    static uint64_t stateKey(GLFunction family, uint64_t slot)
+    {
+        return (static_cast<uint64_t>(family) << 48) | (slot & 0xFFFFFFFFFFFFull);
+    }
+
+    template<typename T>
+    static uint32_t toWord(T value)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            float f = static_cast<float>(value);
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            return bits;
+        }
+        else
+        {
+            return static_cast<uint32_t>(value);
+        }
+    }
+
+    template<typename T>
+    static uint64_t toArg(T value)
+    {
+        if constexpr (std::is_pointer_v<T>)
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+        else if constexpr (std::is_floating_point_v<T>)
+            return toWord(value);
+        else
+            return static_cast<uint64_t>(value);
+    }
+
+    /**
+     * @brief Store new state, marking the current call redundant if unchanged
+     */
+    void setState(uint64_t key, const uint32_t* words, uint32_t count)
+    {
+        auto it = state.find(key);
+        if (it != state.end() && it->second.count == count &&
+            std::memcmp(it->second.words, words, count * sizeof(uint32_t)) == 0)
+        {
+            lastCallRedundant = true;
+            return;
+        }
+        StateValue& value = state[key];
+        value.count = count;
+        std::memcpy(value.words, words, count * sizeof(uint32_t));
+    }
+
+    template<typename... Values>
+    void setState(GLFunction family, uint64_t slot, Values... values)
+    {
+        const uint32_t words[] = { toWord(values)... };
+        setState(stateKey(family, slot), words, static_cast<uint32_t>(sizeof...(Values)));
+    }
+
+    // Buffer binding slot: element array bindings belong to the bound VAO
+    uint64_t bufferSlot(GLenum target) const
+    {
+        if (target == GL_ELEMENT_ARRAY_BUFFER)
+            return (static_cast<uint64_t>(currentVAO) << 16) | target;
+        return target;
+    }
+
+    uint64_t uniformSlot(GLint location) const
+    {
+        return (static_cast<uint64_t>(currentProgram) << 24) | static_cast<uint32_t>(location);
+    }
+
+    template<typename Ret, GLFunction F, typename... Args>
+    static Ret invoke(Args... args)
+    {
+        GLRecorder& recorder = *current();
+        size_t index = static_cast<size_t>(F);
+        recorder.totalCalls++;
+        recorder.callCounts[index]++;
+        recorder.lastCallRedundant = false;
+
+        if constexpr (std::is_void_v<Ret>)
+            recorder.handle(Tag<F>(), args...);
+
+        if (recorder.lastCallRedundant)
+            recorder.redundantCounts[index]++;
+        if (recorder.recording)
+        {
+            GLCall call;
+            call.function = F;
+            call.redundant = recorder.lastCallRedundant;
+            const uint64_t values[] = { toArg(args)..., 0 };
+            call.argCount = static_cast<uint8_t>(std::min<size_t>(sizeof...(Args), 4));
+            for (int i = 0; i < 4; i++)
+                call.args[i] = i < call.argCount ? values[i] : 0;
+            recorder.calls.push_back(call);
+        }
+
+        if constexpr (!std::is_void_v<Ret>)
+            return recorder.handle(Tag<F>(), args...);
+    }
+
+    // ========== Null implementations ==========
+
+    // Calls without state or results we track
+    template<GLFunction F, typename... Args>
+    void handle(Tag<F>, Args...) {}
+
+    void handle(Tag<GLFunction::UseProgram>, GLuint program)
+    {
+        lastCallRedundant = program == currentProgram;
+        currentProgram = program;
+    }
+
+    void handle(Tag<GLFunction::BindVertexArray>, GLuint array)
+    {
+        lastCallRedundant = array == currentVAO;
+        currentVAO = array;
+    }
+
+    void handle(Tag<GLFunction::BindBuffer>, GLenum target, GLuint buffer)
+    {
+        setState(GLFunction::BindBuffer, bufferSlot(target), buffer);
+    }
+
+    void handle(Tag<GLFunction::BindBufferBase>, GLenum target, GLuint index, GLuint buffer)
+    {
+        setState(GLFunction::BindBufferBase, (static_cast<uint64_t>(target) << 16) | index, buffer);
+
+        // Also binds the generic target, which doesn't make the call redundant
+        bool redundant = lastCallRedundant;
+        setState(GLFunction::BindBuffer, bufferSlot(target), buffer);
+        lastCallRedundant = redundant;
+    }
+
+    void handle(Tag<GLFunction::ActiveTexture>, GLenum texture)
+    {
+        lastCallRedundant = texture == activeTextureUnit;
+        activeTextureUnit = texture;
+    }
+
+    void handle(Tag<GLFunction::BindTexture>, GLenum target, GLuint texture)
+    {
+        setState(GLFunction::BindTexture, (static_cast<uint64_t>(activeTextureUnit) << 16) | target, texture);
+    }
+
+    void handle(Tag<GLFunction::BindSampler>, GLuint unit, GLuint sampler)
+    {
+        setState(GLFunction::BindSampler, unit, sampler);
+    }
+
+    void handle(Tag<GLFunction::Enable>, GLenum cap) { setState(GLFunction::Enable, cap, 1); }
+    void handle(Tag<GLFunction::Disable>, GLenum cap) { setState(GLFunction::Enable, cap, 0); }
+    void handle(Tag<GLFunction::DepthFunc>, GLenum func) { setState(GLFunction::DepthFunc, 0, func); }
+    void handle(Tag<GLFunction::CullFace>, GLenum mode) { setState(GLFunction::CullFace, 0, mode); }
+    void handle(Tag<GLFunction::FrontFace>, GLenum mode) { setState(GLFunction::FrontFace, 0, mode); }
+    void handle(Tag<GLFunction::PolygonMode>, GLenum face, GLenum mode) { setState(GLFunction::PolygonMode, face, mode); }
+
+    void handle(Tag<GLFunction::ColorMask>, GLboolean r, GLboolean g, GLboolean b, GLboolean a)
+    {
+        setState(GLFunction::ColorMask, 0, r, g, b, a);
+    }
+
+    void handle(Tag<GLFunction::ClearColor>, GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+    {
+        setState(GLFunction::ClearColor, 0, r, g, b, a);
+    }
+
+    void handle(Tag<GLFunction::Viewport>, GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        setState(GLFunction::Viewport, 0, x, y, width, height);
+        viewport[0] = x;
+        viewport[1] = y;
+        viewport[2] = width;
+        viewport[3] = height;
+    }
+
+    void handle(Tag<GLFunction::BindFramebuffer>, GLenum target, GLuint framebuffer)
+    {
+        setState(GLFunction::BindFramebuffer, target, framebuffer);
+        if (target != GL_READ_FRAMEBUFFER)
+            drawFramebuffer = framebuffer;
+    }
+
+    void handle(Tag<GLFunction::DepthMask>, GLboolean flag) { setState(GLFunction::DepthMask, 0, flag); }
+    void handle(Tag<GLFunction::PolygonOffset>, GLfloat factor, GLfloat units) { setState(GLFunction::PolygonOffset, 0, factor, units); }
+
+    // Uniforms are per program; writes to location -1 are ignored by GL
+    void handle(Tag<GLFunction::Uniform1i>, GLint location, GLint v0)
+    {
+        if (location < 0) { lastCallRedundant = true; return; }
+        setState(GLFunction::Uniform1f, uniformSlot(location), v0);
+    }
+
+    void handle(Tag<GLFunction::Uniform1f>, GLint location, GLfloat v0)
+    {
+        if (location < 0) { lastCallRedundant = true; return; }
+        setState(GLFunction::Uniform1f, uniformSlot(location), v0);
+    }
+
+    void handle(Tag<GLFunction::Uniform3f>, GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+    {
+        if (location < 0) { lastCallRedundant = true; return; }
+        setState(GLFunction::Uniform1f, uniformSlot(location), v0, v1, v2);
+    }
+
+    void handle(Tag<GLFunction::UniformMatrix4fv>, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        if (location < 0) { lastCallRedundant = true; return; }
+        if (count != 1 || !value)
+            return;
+        uint32_t words[16];
+        std::memcpy(words, value, sizeof(words));
+        setState(stateKey(GLFunction::Uniform1f, uniformSlot(location)), words, 16);
+    }
+
+    void handle(Tag<GLFunction::UniformBlockBinding>, GLuint program, GLuint blockIndex, GLuint binding)
+    {
+        setState(GLFunction::UniformBlockBinding, (static_cast<uint64_t>(program) << 16) | blockIndex, binding);
+    }
+
+    void handle(Tag<GLFunction::DrawElements>, GLenum mode, GLsizei count, GLenum type, const void* indices)
+    {
+        indicesDrawn += static_cast<uint64_t>(count);
+    }
+
+    void generateNames(GLsizei n, GLuint* names)
+    {
+        for (GLsizei i = 0; i < n; i++)
+            names[i] = nextObjectName++;
+    }
+
+    void handle(Tag<GLFunction::GenBuffers>, GLsizei n, GLuint* buffers) { generateNames(n, buffers); }
+    void handle(Tag<GLFunction::GenTextures>, GLsizei n, GLuint* textures) { generateNames(n, textures); }
+    void handle(Tag<GLFunction::GenVertexArrays>, GLsizei n, GLuint* arrays) { generateNames(n, arrays); }
+    void handle(Tag<GLFunction::GenSamplers>, GLsizei n, GLuint* samplers) { generateNames(n, samplers); }
+    void handle(Tag<GLFunction::GenFramebuffers>, GLsizei n, GLuint* framebuffers) { generateNames(n, framebuffers); }
+
+    GLuint handle(Tag<GLFunction::CreateProgram>) { return nextObjectName++; }
+    GLuint handle(Tag<GLFunction::CreateShader>, GLenum type) { return nextObjectName++; }
+
+    // Every shader compiles and links, with an empty log
+    void handle(Tag<GLFunction::GetShaderiv>, GLuint shader, GLenum pname, GLint* value)
+    {
+        *value = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+    }
+
+    void handle(Tag<GLFunction::GetProgramiv>, GLuint program, GLenum pname, GLint* value)
+    {
+        *value = pname == GL_LINK_STATUS ? GL_TRUE : 0;
+    }
+
+    void emptyLog(GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+    {
+        if (length)
+            *length = 0;
+        if (infoLog && bufSize > 0)
+            infoLog[0] = '\0';
+    }
+
+    void handle(Tag<GLFunction::GetShaderInfoLog>, GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+    {
+        emptyLog(bufSize, length, infoLog);
+    }
+
+    void handle(Tag<GLFunction::GetProgramInfoLog>, GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+    {
+        emptyLog(bufSize, length, infoLog);
+    }
+
+    // Stable per name, so the same uniform shares a location across programs
+    GLint handle(Tag<GLFunction::GetUniformLocation>, GLuint program, const GLchar* uniformName)
+    {
+        auto result = uniformLocations.emplace(uniformName, static_cast<GLint>(uniformLocations.size()));
+        return result.first->second;
+    }
+
+    GLuint handle(Tag<GLFunction::GetUniformBlockIndex>, GLuint program, const GLchar* blockName)
+    {
+        auto result = uniformBlockIndices.emplace(blockName, static_cast<GLuint>(uniformBlockIndices.size()));
+        return result.first->second;
+    }
+
+    // Mapped ranges point at scratch memory, so callers really write the data
+    void* handle(Tag<GLFunction::MapBufferRange>, GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+    {
+        std::vector<uint8_t>& scratch = mappedBuffers[target];
+        if (scratch.size() < static_cast<size_t>(length))
+            scratch.resize(static_cast<size_t>(length));
+        return scratch.data();
+    }
+
+    GLboolean handle(Tag<GLFunction::UnmapBuffer>, GLenum target) { return GL_TRUE; }
+
+    GLenum handle(Tag<GLFunction::CheckFramebufferStatus>, GLenum target) { return GL_FRAMEBUFFER_COMPLETE; }
+
+    // Fences are signaled as soon as they're created
+    GLsync handle(Tag<GLFunction::FenceSync>, GLenum condition, GLbitfield flags)
+    {
+        return reinterpret_cast<GLsync>(static_cast<uintptr_t>(nextObjectName++));
+    }
+
+    GLenum handle(Tag<GLFunction::ClientWaitSync>, GLsync sync, GLbitfield flags, GLuint64 timeout)
+    {
+        return GL_ALREADY_SIGNALED;
+    }
+
+    // Only the state the engine saves and restores is answered
+    void handle(Tag<GLFunction::GetIntegerv>, GLenum pname, GLint* data)
+    {
+        if (pname == GL_VIEWPORT)
+            std::memcpy(data, viewport, sizeof(viewport));
+        else if (pname == GL_DRAW_FRAMEBUFFER_BINDING)
+            *data = static_cast<GLint>(drawFramebuffer);
+        else
+            *data = 0;
+    }
+
+    const GLubyte* handle(Tag<GLFunction::GetString>, GLenum which)
+    {
+        return reinterpret_cast<const GLubyte*>("Null GL");
+    }
+
+    static const GL::Table& nullTable()
+    {
+        static const GL::Table table = {
+#define ENGINE_GL_RECORDER_ENTRY(ret, name, parameters, arguments) \
+            [] parameters -> ret { return GLRecorder::invoke<ret, GLFunction::name> arguments; },
+            ENGINE_GL_FUNCTIONS(ENGINE_GL_RECORDER_ENTRY)
+#undef ENGINE_GL_RECORDER_ENTRY
+        };
+        return table;
+    }
+
+public:
+    GLRecorder()
+        : totalCalls(0), indicesDrawn(0), recording(false),
+          currentProgram(0), currentVAO(0), activeTextureUnit(GL_TEXTURE0),
+          drawFramebuffer(0), viewport{0, 0, 0, 0}, nextObjectName(1), installed(false), lastCallRedundant(false)
+    {
+        callCounts.fill(0);
+        redundantCounts.fill(0);
+    }
+
+    ~GLRecorder()
+    {
+        uninstall();
+    }
+
+    GLRecorder(const GLRecorder&) = delete;
+    GLRecorder& operator=(const GLRecorder&) = delete;
+
+    /**
+     * @brief Route GL:: calls to this recorder (replaces any other recorder)
+     */
+    void install()
+    {
+        if (current() && current() != this)
+            current()->installed = false;
+        current() = this;
+        installed = true;
+        GL::setTable(&nullTable());
+    }
+
+    /**
+     * @brief Route GL:: calls back to the driver
+     */
+    void uninstall()
+    {
+        if (!installed)
+            return;
+        installed = false;
+        current() = nullptr;
+        GL::setTable(nullptr);
+    }
+
+    bool isInstalled() const { return installed; }
+
+    /**
+     * @brief Clear counters and the recorded stream, keeping shadow state
+     * Call between setup and the frame you want to measure.
+     */
+    void resetCounters()
+    {
+        callCounts.fill(0);
+        redundantCounts.fill(0);
+        totalCalls = 0;
+        indicesDrawn = 0;
+        calls.clear();
+    }
+
+    /**
+     * @brief Forget shadow state too (as if on a fresh context)
+     */
+    void reset()
+    {
+        resetCounters();
+        state.clear();
+        currentProgram = 0;
+        currentVAO = 0;
+        activeTextureUnit = GL_TEXTURE0;
+        drawFramebuffer = 0;
+        std::fill(viewport, viewport + 4, 0);
+    }
+
+    /**
+     * @brief Keep every call in getCalls() (off by default; counting is always on)
+     */
+    void setRecording(bool enabled) { recording = enabled; }
+    const std::vector<GLCall>& getCalls() const { return calls; }
+
+    uint64_t getCallCount(GLFunction function) const { return callCounts[static_cast<size_t>(function)]; }
+    uint64_t getRedundantCount(GLFunction function) const { return redundantCounts[static_cast<size_t>(function)]; }
+    uint64_t getTotalCalls() const { return totalCalls; }
+
+    uint64_t getRedundantCount() const
+    {
+        uint64_t total = 0;
+        for (uint64_t count : redundantCounts)
+            total += count;
+        return total;
+    }
+
+    uint64_t getDrawCallCount() const { return getCallCount(GLFunction::DrawElements); }
+    uint64_t getIndicesDrawn() const { return indicesDrawn; }
+
+    /**
+     * @brief Calls per function, most frequent first
+     */
+    std::string getSummary() const
+    {
+        std::vector<size_t> order;
+        for (size_t i = 0; i < GL_FUNCTION_COUNT; i++)
+            if (callCounts[i] > 0)
+                order.push_back(i);
+        std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return callCounts[a] > callCounts[b];
+        });
+
+        std::ostringstream out;
+        out << totalCalls << " GL calls, " << getDrawCallCount() << " draws, "
+            << getRedundantCount() << " redundant\n";
+        for (size_t i : order)
+        {
+            out << "  " << getGLFunctionName(static_cast<GLFunction>(i)) << ": " << callCounts[i];
+            if (redundantCounts[i] > 0)
+                out << " (" << redundantCounts[i] << " redundant)";
+            out << "\n";
+        }
+        return out.str();
+    }
+};
+
+#endif // GL_RECORDER_H
@@ -0,0 +1,248 @@
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include "framebuffer.h"
+#include "rasterizer.h"
+#include "../Primitives/mesh.h"
+#include "../../Math/mat4.h"
+#include "../../Math/bounds.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+/**
+ * @class OcclusionCuller
+ * @brief Software occlusion culling against a low-resolution depth buffer
+ *
+ * Each frame a few large occluders are rasterized on the CPU (depth only)
+ * into a small Framebuffer, a max-depth hierarchy is built from it, and
+ * object bounds are tested against the hierarchy. An object is culled
+ * when its nearest depth is behind the farthest occluder depth everywhere
+ * its screen rectangle touches.
+ *
+ * Occluder meshes should lie inside the geometry they stand for (simple
+ * boxes inside buildings, walls, terrain): an occluder that sticks out
+ * hides objects that are actually visible.
+ *
+ * Example:
+ * @code
+ * culler.beginFrame(camera.getViewProjectionMatrix(), camera.position);
+ * culler.addOccluder(wallMesh, wallModel, wallBounds);
+ * culler.finishOccluders();
+ * if (culler.isVisible(objectBounds)) submit(object);
+ * @endcode
+ */
+class OcclusionCuller
+{
+public:
+    size_t maxOccluders;  // Occluders rasterized per frame (largest on screen first)
+
+    /**
+     * @param width, height Depth buffer resolution
+     */
+    OcclusionCuller(int width = 256, int height = 128)
+        : maxOccluders(32),
+          depth(width, height, false),
+          cameraPosition(vec3::zero),
+          occludersDrawn(0)
+    {
+        rasterizer.backfaceCulling = true;
+        rasterizer.frustumCulling = true;
+        allocateHierarchy();
+    }
+
+    /**
+     * @brief Change the depth buffer resolution
+     */
+    void setResolution(int width, int height)
+    {
+        depth.resize(width, height);
+        allocateHierarchy();
+    }
+
+    /**
+     * @brief Start a frame: clears the depth buffer and the occluder list
+     */
+    void beginFrame(const mat4& viewProj, const vec3& eyePosition)
+    {
+        viewProjection = viewProj;
+        cameraPosition = eyePosition;
+        candidates.clear();
+        occludersDrawn = 0;
+        depth.clearDepth();
+    }
+
+    /**
+     * @brief Offer an occluder; the largest ones on screen are drawn in finishOccluders()
+     * @param mesh Occluder geometry (must stay alive until finishOccluders)
+     * @param modelMatrix Mesh-to-world transform
+     * @param worldBounds World bounds, used to rank occluders by screen size
+     */
+    void addOccluder(const Mesh& mesh, const mat4& modelMatrix, const AABB& worldBounds)
+    {
+        if (!worldBounds.isValid())
+            return;
+        float radiusSq = worldBounds.getExtents().lengthSquared();
+        float distanceSq = std::max(worldBounds.distanceSquared(cameraPosition), 1e-4f);
+        candidates.push_back({ &mesh, modelMatrix, radiusSq / distanceSq });
+    }
+
+    /**
+     * @brief Rasterize the chosen occluders and build the depth hierarchy
+     */
+    void finishOccluders()
+    {
+        if (candidates.size() > maxOccluders)
+        {
+            std::partial_sort(candidates.begin(), candidates.begin() + maxOccluders, candidates.end(),
+                [](const Candidate& a, const Candidate& b) { return a.screenSize > b.screenSize; });
+            candidates.resize(maxOccluders);
+        }
+
+        for (const auto& candidate : candidates)
+        {
+            rasterizer.drawMeshDepth(depth, *candidate.mesh, viewProjection * candidate.modelMatrix);
+        }
+        occludersDrawn = candidates.size();
+        candidates.clear();
+
+        buildHierarchy();
+    }
+
+    /**
+     * @brief Test world bounds against the occluders
+     * @return false only if the box is certainly hidden
+     */
+    bool isVisible(const AABB& worldBounds) const
+    {
+        if (occludersDrawn == 0 || !worldBounds.isValid())
+            return true;
+
+        // Project the corners; boxes reaching behind the camera can't be bounded on screen
+        float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+        float nearestDepth = FLT_MAX;
+        const float (*m)[4] = viewProjection.m;
+        for (int corner = 0; corner < 8; corner++)
+        {
+            vec3 p((corner & 1) ? worldBounds.max.x : worldBounds.min.x,
+                   (corner & 2) ? worldBounds.max.y : worldBounds.min.y,
+                   (corner & 4) ? worldBounds.max.z : worldBounds.min.z);
+            float w = m[3][0] * p.x + m[3][1] * p.y + m[3][2] * p.z + m[3][3];
+            if (w <= 1e-5f)
+                return true;
+            float invW = 1.0f / w;
+            float x = (m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3]) * invW;
+            float y = (m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3]) * invW;
+            float z = (m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3]) * invW;
+            minX = std::min(minX, x); maxX = std::max(maxX, x);
+            minY = std::min(minY, y); maxY = std::max(maxY, y);
+            nearestDepth = std::min(nearestDepth, (z + 1.0f) * 0.5f);
+        }
+        if (nearestDepth <= 0.0f)
+            return true;
+
+        // Screen rectangle in depth-buffer pixels (y flipped like the rasterizer)
+        int x0 = std::max(0, (int)std::floor((minX + 1.0f) * 0.5f * depth.width));
+        int x1 = std::min(depth.width - 1, (int)std::floor((maxX + 1.0f) * 0.5f * depth.width));
+        int y0 = std::max(0, (int)std::floor((1.0f - maxY) * 0.5f * depth.height));
+        int y1 = std::min(depth.height - 1, (int)std::floor((1.0f - minY) * 0.5f * depth.height));
+        if (x0 > x1 || y0 > y1)
+            return true;  // Off screen: leave it to frustum culling
+
+        // Coarsest level where the rectangle spans at most a few texels
+        size_t level = 0;
+        int span = std::max(x1 - x0, y1 - y0) + 1;
+        while (span > 4 && level + 1 < levels.size())
+        {
+            span = (span + 1) / 2;
+            level++;
+        }
+
+        const Level& mip = levels[level];
+        for (int y = y0 >> level; y <= (y1 >> level); y++)
+        {
+            for (int x = x0 >> level; x <= (x1 >> level); x++)
+            {
+                if (nearestDepth <= mip.maxDepth[y * mip.width + x])
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Occluders rasterized this frame
+     */
+    size_t getOccluderCount() const { return occludersDrawn; }
+
+    /**
+     * @brief Occluder depth buffer (for debugging)
+     */
+    const Framebuffer& getDepthBuffer() const { return depth; }
+
+private:
+    struct Candidate
+    {
+        const Mesh* mesh;
+        mat4 modelMatrix;
+        float screenSize;  // Squared radius over squared distance
+    };
+
+    /**
+     * @brief One level of the max-depth hierarchy (level 0 is full resolution)
+     */
+    struct Level
+    {
+        int width, height;
+        std::vector<float> maxDepth;
+    };
+
+    Framebuffer depth;
+    Rasterizer rasterizer;
+    mat4 viewProjection;
+    vec3 cameraPosition;
+    std::vector<Candidate> candidates;
+    std::vector<Level> levels;
+    size_t occludersDrawn;
+
+    void allocateHierarchy()
+    {
+        levels.clear();
+        int w = depth.width, h = depth.height;
+        while (true)
+        {
+            levels.push_back({ w, h, std::vector<float>(static_cast<size_t>(w) * h, 1.0f) });
+            if (w == 1 && h == 1)
+                break;
+            w = std::max(1, (w + 1) / 2);
+            h = std::max(1, (h + 1) / 2);
+        }
+    }
+
+    /**
+     * @brief Each texel keeps the farthest depth of the 2x2 texels below it
+     */
+    void buildHierarchy()
+    {
+        levels[0].maxDepth.assign(depth.depthBuffer.begin(), depth.depthBuffer.end());
+        for (size_t l = 1; l < levels.size(); l++)
+        {
+            const Level& src = levels[l - 1];
+            Level& dst = levels[l];
+            for (int y = 0; y < dst.height; y++)
+            {
+                int sy0 = y * 2, sy1 = std::min(y * 2 + 1, src.height - 1);
+                for (int x = 0; x < dst.width; x++)
+                {
+                    int sx0 = x * 2, sx1 = std::min(x * 2 + 1, src.width - 1);
+                    dst.maxDepth[y * dst.width + x] = std::max(
+                        std::max(src.maxDepth[sy0 * src.width + sx0], src.maxDepth[sy0 * src.width + sx1]),
+                        std::max(src.maxDepth[sy1 * src.width + sx0], src.maxDepth[sy1 * src.width + sx1]));
+                }
+            }
+        }
+    }
+};
+
+#endif // OCCLUSION_CULLER_H
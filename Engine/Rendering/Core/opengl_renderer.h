@@ -1,12 +1,7 @@
 #ifndef OPENGL_RENDERER_H
 #define OPENGL_RENDERER_H
 
-#ifdef __APPLE__
-#define GL_SILENCE_DEPRECATION
-#include <OpenGL/gl3.h>
-#else
-#include <GL/glew.h>
-#endif
+#include "gl_dispatch.h"
 
 #include "../Primitives/mesh.h"
 #include "../camera.h"
@@ -14,26 +9,38 @@
 #include "../Shaders/shader.h"
 #include "../Shaders/default_shaders.h"
 #include "../../Math/mat4.h"
+#include "../../Math/bounds.h"
 #include "render_types.h"
 #include "uniform_buffer.h"
+#include "clustered_lighting.h"
+#include "cascaded_shadow_maps.h"
 #include "render_command.h"
+#include "render_backend.h"
+#include "vertex_packing.h"
+#include "vertex_transform.h"
 #include <vector>
 #include <string>
 #include <iostream>
 #include <unordered_map>
 #include <memory>
 #include <algorithm>
+#include <mutex>
 
 // Configuration constants
 namespace RenderConfig
 {
-    constexpr int MAX_LIGHTS = 8;  // Maximum lights supported in shaders
+    constexpr int MAX_LIGHTS = 8;  // Lights in LightsUBO (custom shaders); built-in shaders use ClusteredLighting
+    constexpr int MAX_TEXTURE_UNITS = 16;  // Units with cached bindings (GL guarantees 16)
+    constexpr uint64_t FRAMES_IN_FLIGHT = 2;  // Frames the GPU may still be reading
+    constexpr size_t DYNAMIC_BATCH_MAX_VERTICES = 300;  // Default per-mesh limit for dynamic batching
+    constexpr float DEPTH_PREPASS_OVERDRAW = 2.5f;  // Auto pre-pass turns on at this depth complexity
 }
 
 /**
  * @struct MeshBuffer
  * @brief GPU buffer data for a mesh
- * Stores VAO, VBO, EBO handles and metadata
+ * Stores VAO, VBO, EBO handles and metadata, plus the optional
+ * position-only stream used by depth-only draws
  */
 struct MeshBuffer
 {
@@ -41,13 +48,53 @@ struct MeshBuffer
     GLuint VBO;             // Vertex Buffer Object
     GLuint EBO;             // Element Buffer Object
     size_t indexCount;      // Number of indices
+    size_t vertexCount;     // Number of vertices currently uploaded
+    size_t vertexCapacity;  // Vertices the VBO storage can hold
+    size_t indexCapacity;   // Indices the EBO storage can hold
     uint64_t meshID;        // Mesh unique ID
     BufferUsage usage;      // Usage hint
+    uint64_t lastUsedFrame; // Last frame this buffer was drawn (for LRU eviction)
+    
+    // Position-only stream (shares the EBO)
+    GLuint depthVAO;                     // VAO reading only positionVBO
+    GLuint positionVBO;                  // Deinterleaved positions
+    PositionStreamFormat positionFormat; // None = depth draws use VAO
+    vec3 positionOffset;                 // Dequantize: p = offset + q * scale
+    vec3 positionScale;
+    
+    AABB bounds;            // Local mesh bounds at the last upload (overdraw estimates)
     
     MeshBuffer()
-        : VAO(0), VBO(0), EBO(0), indexCount(0), meshID(0), usage(BufferUsage::Static)
+        : VAO(0), VBO(0), EBO(0), indexCount(0), vertexCount(0),
+          vertexCapacity(0), indexCapacity(0), meshID(0), usage(BufferUsage::Static),
+          lastUsedFrame(0), depthVAO(0), positionVBO(0), positionFormat(PositionStreamFormat::None),
+          positionOffset(vec3::zero), positionScale(vec3::one)
+    {
+    }
+
+    /**
+     * @brief GPU memory held by this buffer's VBO + EBO (+ position stream) storage
+     */
+    size_t getByteSize() const
     {
+        return vertexCapacity * (sizeof(PackedVertex) + positionStreamStride(positionFormat)) +
+               indexCapacity * sizeof(unsigned int);
     }
+    
+    /**
+     * @brief VAO to use for depth-only draws
+     */
+    GLuint getDepthVAO() const { return depthVAO != 0 ? depthVAO : VAO; }
+};
+
+/**
+ * @struct RetiredMeshBuffer
+ * @brief Mesh buffer waiting for in-flight frames to finish before deletion
+ */
+struct RetiredMeshBuffer
+{
+    MeshBuffer buffer;
+    uint64_t releaseFrame;  // Frame index at which GL objects may be deleted
 };
 
 /**
@@ -63,10 +110,16 @@ struct RenderState
     bool cullFaceEnabled;
     bool wireframeMode;
     
+    // Per-unit texture bindings (0 = unknown or none)
+    GLuint boundTextures[RenderConfig::MAX_TEXTURE_UNITS];
+    GLuint boundSamplers[RenderConfig::MAX_TEXTURE_UNITS];
+    int activeTextureUnit;  // -1 = unknown
+    
     RenderState()
         : boundVAO(0), boundShader(0), boundMaterial(nullptr),
           depthTestEnabled(false), cullFaceEnabled(false), wireframeMode(false)
     {
+        resetTextures();
     }
     
     void reset()
@@ -74,6 +127,18 @@ struct RenderState
         boundVAO = 0;
         boundShader = 0;
         boundMaterial = nullptr;
+        resetTextures();
+    }
+    
+    /**
+     * Forget texture bindings (code outside the renderer, e.g. texture
+     * creation, binds textures on whatever unit is active)
+     */
+    void resetTextures()
+    {
+        std::fill(std::begin(boundTextures), std::end(boundTextures), 0);
+        std::fill(std::begin(boundSamplers), std::end(boundSamplers), 0);
+        activeTextureUnit = -1;
     }
 };
 
@@ -84,201 +149,1029 @@ struct RenderState
  * Features:
  * - Uniform Buffer Objects (UBOs) for camera/lights
  * - Command-based rendering with batching
- * - Mesh ID tracking with dirty flags
+ * - Mesh ID tracking with dirty flags and partial (dirty-range) re-uploads
  * - Optimized packed vertex format (32 bytes vs 44 bytes)
  * - State caching to minimize GL calls
  * - Static/Dynamic/Streaming buffer hints
+ * - Optional position-only stream + depth-only pass (flushDepthOnly)
+ * - Front-to-back depth pre-pass when overdraw is high (setDepthPrepass)
+ * - Optional dynamic batching of small meshes (setDynamicBatching)
+ * - Clustered forward lighting (no limit on point/spot lights)
+ * - Cached cascaded shadow maps for the main directional light (submitShadows)
  */
-class OpenGLRenderer
+class OpenGLRenderer : public RenderBackend
 {
 private:
     std::shared_ptr<Shader> activeShader;
+    std::shared_ptr<Shader> depthShader;  // Position-only shader for depth passes
     std::unordered_map<uint64_t, MeshBuffer> meshBuffers;  // By mesh ID
     bool initialized;
     
     // Uniform Buffer Objects
     std::unique_ptr<UniformBuffer<CameraUBO>> cameraUBO;
     std::unique_ptr<UniformBuffer<LightsUBO>> lightsUBO;
+    ClusteredLighting clusteredLighting;  // Any number of lights, bound per program
+    std::vector<Light> frameLights;       // From beginFrame(); indexed by RenderCommand::lights
+    size_t mainLightIndex;                // First directional frame light (lightDir/lightColor)
+    CascadedShadowMaps shadowMaps;        // Shadows of the main light
+    const ShadowFrame* shadowFrame;       // From submitShadows(), drawn by the next flush
     
     // Command queue
     DrawCommandQueue renderQueue;
+    const std::vector<RenderCommand>* retainedCommands;  // Drawn instead of the queue (submitRetained)
     
     // State caching
     RenderState currentState;
+    SamplerCache samplers;  // Shared sampler objects by (filter, wrap)
+    
+    // Reusable upload staging (avoids per-upload allocations)
+    std::vector<PackedVertex> packScratch;
+    std::vector<unsigned int> indexScratch;
+    
+    // GPU resource lifetime
+    uint64_t frameIndex;                        // Incremented by beginFrame()
+    size_t meshMemoryUsage;                     // Bytes in live + retired mesh buffers
+    size_t meshMemoryBudget;                    // Eviction threshold (0 = unlimited)
+    std::vector<RetiredMeshBuffer> retiredBuffers;
+    size_t meshDestroyListener;                 // Handle from Mesh::addDestroyListener
+    std::mutex destroyedMeshMutex;              // Meshes may die on any thread
+    std::vector<uint64_t> destroyedMeshIDs;     // Drained on the GL thread
+    
+    // Position-only stream layout for newly prepared mesh buffers
+    PositionStreamFormat positionStreamFormat;
+    
+    // Set by prepareMeshes(): queued commands have up-to-date buffers, so
+    // flushes look them up by ID without reading mesh data
+    bool meshesPrepared;
+    
+    // Dynamic batching: runs of sorted commands with the same material and
+    // small meshes are baked to world space and drawn from one stream buffer
+    struct DynamicBatch
+    {
+        size_t firstIndex;  // Into the batch EBO
+        size_t indexCount;
+    };
+    struct DynamicBatchMember
+    {
+        size_t command;
+        size_t firstVertex;
+        size_t firstIndex;
+    };
+    static constexpr int32_t NOT_BATCHED = -1;
+    static constexpr int32_t BATCH_MEMBER = -2;  // Drawn by its run's first command
+    
+    bool dynamicBatching;
+    size_t dynamicBatchMaxVertices;
+    std::vector<int32_t> commandBatches;  // Per sorted command: batch index, NOT_BATCHED or BATCH_MEMBER
+    std::vector<DynamicBatch> dynamicBatches;
+    std::vector<DynamicBatchMember> batchMembers;
+    std::vector<Vertex> batchVertices;
+    std::vector<unsigned int> batchIndices;
+    GLuint batchVAO, batchVBO, batchEBO;
+    
+    // Depth pre-pass: opaque commands front to back before the color pass
+    DepthPrepassMode depthPrepassMode;
+    float depthPrepassThreshold;            // Auto: estimated overdraw that turns it on
+    bool depthPrepassActive;                // Used by the last flush
+    float overdrawEstimate;                 // Opaque screen coverage / screen area, last flush
+    std::vector<std::pair<float, uint32_t>> prepassOrder;  // (view depth, command)
+    
+    /**
+     * Delete GL objects for a mesh buffer and drop its bytes from the total
+     */
+    void deleteMeshBuffer(MeshBuffer& buffer)
+    {
+        if (currentState.boundVAO == buffer.VAO)
+            bindVAO(0);
+        GL::DeleteVertexArrays(1, &buffer.VAO);
+        GL::DeleteBuffers(1, &buffer.VBO);
+        GL::DeleteBuffers(1, &buffer.EBO);
+        meshMemoryUsage -= buffer.getByteSize();
+        destroyPositionStream(buffer);
+    }
+    
+    /**
+     * Move a live mesh buffer to the retired list
+     * Its GL objects are deleted once every frame that may reference it is done.
+     */
+    void retireMeshBuffer(std::unordered_map<uint64_t, MeshBuffer>::iterator it)
+    {
+        retiredBuffers.push_back({it->second, frameIndex + RenderConfig::FRAMES_IN_FLIGHT});
+        meshBuffers.erase(it);
+    }
+    
+    /**
+     * Retire buffers of destroyed meshes, evict LRU buffers over budget,
+     * and delete retired buffers whose frames have completed
+     */
+    void collectMeshBuffers()
+    {
+        // Destroyed meshes
+        std::vector<uint64_t> destroyed;
+        {
+            std::lock_guard<std::mutex> lock(destroyedMeshMutex);
+            destroyed.swap(destroyedMeshIDs);
+        }
+        for (uint64_t id : destroyed)
+        {
+            auto it = meshBuffers.find(id);
+            if (it != meshBuffers.end())
+                retireMeshBuffer(it);
+        }
+        
+        // Budget eviction: least recently drawn first, never anything in flight
+        if (meshMemoryBudget > 0 && meshMemoryUsage > meshMemoryBudget)
+        {
+            std::vector<std::pair<uint64_t, uint64_t>> candidates;  // (lastUsedFrame, meshID)
+            for (const auto& [id, buffer] : meshBuffers)
+            {
+                if (buffer.lastUsedFrame + RenderConfig::FRAMES_IN_FLIGHT <= frameIndex)
+                    candidates.emplace_back(buffer.lastUsedFrame, id);
+            }
+            std::sort(candidates.begin(), candidates.end());
+            
+            // Retired bytes only come back after release, so count them as freed now
+            size_t projected = meshMemoryUsage;
+            for (const auto& retired : retiredBuffers)
+                projected -= retired.buffer.getByteSize();
+            
+            for (const auto& candidate : candidates)
+            {
+                if (projected <= meshMemoryBudget)
+                    break;
+                auto it = meshBuffers.find(candidate.second);
+                projected -= it->second.getByteSize();
+                retireMeshBuffer(it);
+            }
+        }
+        
+        // Release retired buffers whose frames are done
+        size_t kept = 0;
+        for (auto& retired : retiredBuffers)
+        {
+            if (retired.releaseFrame <= frameIndex)
+                deleteMeshBuffer(retired.buffer);
+            else
+                retiredBuffers[kept++] = retired;
+        }
+        retiredBuffers.resize(kept);
+    }
+    
+    /**
+     * Pack a span of mesh vertices into the reusable scratch buffer
+     * (fallback when a buffer range cannot be mapped)
+     */
+    const PackedVertex* packVertices(const Mesh& mesh, size_t first, size_t count)
+    {
+        packScratch.resize(count);
+        VertexPacking::pack(mesh.vertices.data() + first, count, packScratch.data());
+        return packScratch.data();
+    }
+
+    /**
+     * Pack a span of vertices straight into the bound VBO
+     * Maps the destination range write-only and invalidated, so the packer
+     * writes GPU-visible memory directly with no intermediate copy.
+     * @param invalidateFlag GL_MAP_INVALIDATE_BUFFER_BIT or GL_MAP_INVALIDATE_RANGE_BIT
+     */
+    void writeVertices(const Mesh& mesh, size_t first, size_t count, GLbitfield invalidateFlag)
+    {
+        if (count == 0)
+            return;
+
+        GLintptr offset = static_cast<GLintptr>(first * sizeof(PackedVertex));
+        GLsizeiptr size = static_cast<GLsizeiptr>(count * sizeof(PackedVertex));
+        void* mapped = GL::MapBufferRange(GL_ARRAY_BUFFER, offset, size, GL_MAP_WRITE_BIT | invalidateFlag);
+        if (mapped)
+        {
+            VertexPacking::pack(mesh.vertices.data() + first, count, static_cast<PackedVertex*>(mapped));
+            if (GL::UnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE)
+                return;
+            // Storage was lost while mapped (rare) - fall through and resend
+        }
+        GL::BufferSubData(GL_ARRAY_BUFFER, offset, size, packVertices(mesh, first, count));
+    }
+
+    /**
+     * Flatten a span of mesh triangles into the reusable index scratch buffer
+     */
+    const unsigned int* packIndices(const Mesh& mesh, size_t firstTriangle, size_t triangleCount)
+    {
+        indexScratch.resize(triangleCount * 3);
+        for (size_t i = 0; i < triangleCount; i++)
+        {
+            const Triangle& tri = mesh.triangles[firstTriangle + i];
+            indexScratch[i * 3 + 0] = tri.v0;
+            indexScratch[i * 3 + 1] = tri.v1;
+            indexScratch[i * 3 + 2] = tri.v2;
+        }
+        return indexScratch.data();
+    }
+
+    /**
+     * (Re)allocate VBO storage and fill it with every vertex
+     * Streaming meshes hit this each update: passing the full size to
+     * glBufferData orphans the old storage so the driver never stalls
+     * waiting for in-flight draws that still read it.
+     */
+    void uploadAllVertices(const Mesh& mesh, MeshBuffer& buffer)
+    {
+        size_t count = mesh.vertices.size();
+        GL::BindBuffer(GL_ARRAY_BUFFER, buffer.VBO);
+        GL::BufferData(GL_ARRAY_BUFFER,
+                     count * sizeof(PackedVertex),
+                     nullptr,
+                     toGLUsage(buffer.usage));
+        writeVertices(mesh, 0, count, GL_MAP_INVALIDATE_BUFFER_BIT);
+        buffer.vertexCount = count;
+        buffer.vertexCapacity = count;
+    }
+
+    /**
+     * (Re)allocate EBO storage and fill it with every index
+     * Caller must have the mesh's VAO bound (EBO binding is VAO state)
+     */
+    void uploadAllIndices(const Mesh& mesh, MeshBuffer& buffer)
+    {
+        size_t triangleCount = mesh.triangles.size();
+        GL::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.EBO);
+        GL::BufferData(GL_ELEMENT_ARRAY_BUFFER,
+                     triangleCount * 3 * sizeof(unsigned int),
+                     triangleCount > 0 ? packIndices(mesh, 0, triangleCount) : nullptr,
+                     toGLUsage(buffer.usage));
+        buffer.indexCount = triangleCount * 3;
+        buffer.indexCapacity = triangleCount * 3;
+    }
+
+    /**
+     * Configure vertex attributes for the PackedVertex format
+     * (on the bound VAO, reading the bound GL_ARRAY_BUFFER)
+     */
+    void configureVertexAttributes()
+    {
+        // Position (location = 0): vec3 float
+        GL::VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PackedVertex), 
+                              (void*)offsetof(PackedVertex, position));
+        GL::EnableVertexAttribArray(0);
+
+        // Normal (location = 1): 2x int16 (normalized to [-1, 1])
+        GL::VertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), 
+                              (void*)offsetof(PackedVertex, normal));
+        GL::EnableVertexAttribArray(1);
+
+        // UV (location = 2): 2x uint16 half float
+        GL::VertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), 
+                              (void*)offsetof(PackedVertex, uv));
+        GL::EnableVertexAttribArray(2);
+
+        // Color (location = 3): 4x uint8 (normalized to [0, 1])
+        GL::VertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PackedVertex), 
+                              (void*)offsetof(PackedVertex, color));
+        GL::EnableVertexAttribArray(3);
+
+        // Tangent (location = 4): 4x int16 (octahedral xy, bitangent sign, unused)
+        GL::VertexAttribPointer(4, 4, GL_SHORT, GL_TRUE, sizeof(PackedVertex), 
+                              (void*)offsetof(PackedVertex, tangent));
+        GL::EnableVertexAttribArray(4);
+    }
+
+    /**
+     * Upload mesh data to GPU buffers (optimized format)
+     */
+    void uploadMesh(const Mesh& mesh, MeshBuffer& buffer)
+    {
+        buffer.meshID = mesh.getID();
+        buffer.usage = mesh.getUsage();
+
+        // Create VAO
+        GL::GenVertexArrays(1, &buffer.VAO);
+        bindVAO(buffer.VAO);
+
+        // Create and fill VBO
+        GL::GenBuffers(1, &buffer.VBO);
+        uploadAllVertices(mesh, buffer);
+
+        // Create and fill EBO
+        GL::GenBuffers(1, &buffer.EBO);
+        uploadAllIndices(mesh, buffer);
+
+        configureVertexAttributes();
+
+        bindVAO(0);
+    }
+    
+    /**
+     * Fit Snorm16 quantization to the mesh's current bounds
+     * (identity transform for Float3)
+     */
+    void fitPositionQuantization(const Mesh& mesh, MeshBuffer& buffer)
+    {
+        buffer.positionOffset = vec3::zero;
+        buffer.positionScale = vec3::one;
+        if (buffer.positionFormat != PositionStreamFormat::Snorm16 || mesh.vertices.empty())
+            return;
+
+        vec3 lo = mesh.vertices[0].position;
+        vec3 hi = lo;
+        for (const auto& v : mesh.vertices)
+        {
+            lo = vec3(std::min(lo.x, v.position.x), std::min(lo.y, v.position.y), std::min(lo.z, v.position.z));
+            hi = vec3(std::max(hi.x, v.position.x), std::max(hi.y, v.position.y), std::max(hi.z, v.position.z));
+        }
+        vec3 halfExtent = (hi - lo) * 0.5f;
+        buffer.positionOffset = (lo + hi) * 0.5f;
+        buffer.positionScale = vec3(std::max(halfExtent.x, 1e-6f),
+                                    std::max(halfExtent.y, 1e-6f),
+                                    std::max(halfExtent.z, 1e-6f));
+    }
+
+    /**
+     * Check whether a vertex span still fits the Snorm16 quantization box
+     */
+    bool positionsFitQuantization(const Mesh& mesh, const MeshBuffer& buffer, size_t first, size_t count) const
+    {
+        if (buffer.positionFormat != PositionStreamFormat::Snorm16)
+            return true;
+        vec3 lo = buffer.positionOffset - buffer.positionScale;
+        vec3 hi = buffer.positionOffset + buffer.positionScale;
+        for (size_t i = first; i < first + count; i++)
+        {
+            const vec3& p = mesh.vertices[i].position;
+            if (p.x < lo.x || p.y < lo.y || p.z < lo.z || p.x > hi.x || p.y > hi.y || p.z > hi.z)
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Pack a span of positions straight into the bound position VBO
+     */
+    void writePositions(const Mesh& mesh, const MeshBuffer& buffer, size_t first, size_t count, GLbitfield invalidateFlag)
+    {
+        if (count == 0)
+            return;
+
+        size_t stride = positionStreamStride(buffer.positionFormat);
+        GLintptr offset = static_cast<GLintptr>(first * stride);
+        GLsizeiptr size = static_cast<GLsizeiptr>(count * stride);
+        void* mapped = GL::MapBufferRange(GL_ARRAY_BUFFER, offset, size, GL_MAP_WRITE_BIT | invalidateFlag);
+        if (mapped)
+        {
+            VertexPacking::packPositions(mesh.vertices.data() + first, count, buffer.positionFormat,
+                                         buffer.positionOffset, buffer.positionScale, mapped);
+            if (GL::UnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE)
+                return;
+        }
+        std::vector<uint8_t> staging(size);
+        VertexPacking::packPositions(mesh.vertices.data() + first, count, buffer.positionFormat,
+                                     buffer.positionOffset, buffer.positionScale, staging.data());
+        GL::BufferSubData(GL_ARRAY_BUFFER, offset, size, staging.data());
+    }
+
+    /**
+     * (Re)allocate the position stream to the VBO's capacity and fill it
+     */
+    void uploadAllPositions(const Mesh& mesh, MeshBuffer& buffer)
+    {
+        fitPositionQuantization(mesh, buffer);
+        GL::BindBuffer(GL_ARRAY_BUFFER, buffer.positionVBO);
+        GL::BufferData(GL_ARRAY_BUFFER,
+                     buffer.vertexCapacity * positionStreamStride(buffer.positionFormat),
+                     nullptr,
+                     toGLUsage(buffer.usage));
+        writePositions(mesh, buffer, 0, mesh.vertices.size(), GL_MAP_INVALIDATE_BUFFER_BIT);
+    }
+
+    /**
+     * Create the position VBO and a depth-only VAO that shares the mesh's EBO
+     */
+    void createPositionStream(const Mesh& mesh, MeshBuffer& buffer, PositionStreamFormat format)
+    {
+        buffer.positionFormat = format;
+        GL::GenBuffers(1, &buffer.positionVBO);
+        GL::GenVertexArrays(1, &buffer.depthVAO);
+        bindVAO(buffer.depthVAO);
+        uploadAllPositions(mesh, buffer);
+
+        // Position (location = 0) only
+        if (format == PositionStreamFormat::Float3)
+            GL::VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, (GLsizei)positionStreamStride(format), (void*)0);
+        else
+            GL::VertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, (GLsizei)positionStreamStride(format), (void*)0);
+        GL::EnableVertexAttribArray(0);
+
+        GL::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.EBO);
+        bindVAO(0);
+        GL::BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    /**
+     * Delete the position stream (depth draws fall back to the full VAO)
+     */
+    void destroyPositionStream(MeshBuffer& buffer)
+    {
+        if (buffer.depthVAO != 0)
+        {
+            if (currentState.boundVAO == buffer.depthVAO)
+                bindVAO(0);
+            GL::DeleteVertexArrays(1, &buffer.depthVAO);
+            GL::DeleteBuffers(1, &buffer.positionVBO);
+        }
+        buffer.depthVAO = 0;
+        buffer.positionVBO = 0;
+        buffer.positionFormat = PositionStreamFormat::None;
+        buffer.positionOffset = vec3::zero;
+        buffer.positionScale = vec3::one;
+    }
+
+    /**
+     * Update mesh buffer if dirty
+     * Only the vertex/triangle spans marked on the mesh are repacked.
+     * Static/Dynamic meshes patch those spans with glBufferSubData;
+     * Streaming meshes (or meshes that outgrew their storage) orphan and
+     * refill the whole buffer. Index data is skipped when untouched.
+     */
+    void updateMeshIfDirty(const Mesh& mesh, MeshBuffer& buffer)
+    {
+        if (!mesh.getDirty())
+            return;
+
+        bool usageChanged = buffer.usage != mesh.getUsage();
+        buffer.usage = mesh.getUsage();
+        bool streaming = buffer.usage == BufferUsage::Streaming;
+
+        // EBO binding is VAO state - bind the mesh's own VAO before touching it
+        bindVAO(buffer.VAO);
+
+        // Vertices
+        size_t vertexCount = mesh.vertices.size();
+        DirtyRange vertexRange = mesh.getVertexDirtyRange();
+        if (vertexCount > buffer.vertexCount)
+            vertexRange.include(buffer.vertexCount, vertexCount - buffer.vertexCount);
+        vertexRange = vertexRange.clamped(vertexCount);
+
+        bool hasPositionStream = buffer.positionFormat != PositionStreamFormat::None;
+        if (usageChanged || vertexCount > buffer.vertexCapacity ||
+            (streaming && !vertexRange.empty()))
+        {
+            uploadAllVertices(mesh, buffer);
+            if (hasPositionStream)
+                uploadAllPositions(mesh, buffer);
+        }
+        else if (!vertexRange.empty())
+        {
+            GL::BindBuffer(GL_ARRAY_BUFFER, buffer.VBO);
+            writeVertices(mesh, vertexRange.begin, vertexRange.size(), GL_MAP_INVALIDATE_RANGE_BIT);
+            buffer.vertexCount = vertexCount;
+
+            if (hasPositionStream)
+            {
+                // Edits that leave the quantization box force a refit of the whole stream
+                if (positionsFitQuantization(mesh, buffer, vertexRange.begin, vertexRange.size()))
+                {
+                    GL::BindBuffer(GL_ARRAY_BUFFER, buffer.positionVBO);
+                    writePositions(mesh, buffer, vertexRange.begin, vertexRange.size(), GL_MAP_INVALIDATE_RANGE_BIT);
+                }
+                else
+                {
+                    uploadAllPositions(mesh, buffer);
+                }
+            }
+        }
+        else
+        {
+            buffer.vertexCount = vertexCount;
+        }
+
+        // Indices
+        size_t triangleCount = mesh.triangles.size();
+        size_t uploadedTriangles = buffer.indexCount / 3;
+        DirtyRange triangleRange = mesh.getTriangleDirtyRange();
+        if (triangleCount > uploadedTriangles)
+            triangleRange.include(uploadedTriangles, triangleCount - uploadedTriangles);
+        triangleRange = triangleRange.clamped(triangleCount);
+
+        if (usageChanged || triangleCount * 3 > buffer.indexCapacity ||
+            (streaming && !triangleRange.empty()))
+        {
+            uploadAllIndices(mesh, buffer);
+        }
+        else if (!triangleRange.empty())
+        {
+            GL::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.EBO);
+            GL::BufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                            triangleRange.begin * 3 * sizeof(unsigned int),
+                            triangleRange.size() * 3 * sizeof(unsigned int),
+                            packIndices(mesh, triangleRange.begin, triangleRange.size()));
+            buffer.indexCount = triangleCount * 3;
+        }
+        else
+        {
+            buffer.indexCount = triangleCount * 3;
+        }
+
+        GL::BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    
+    /**
+     * Get a mesh's GPU buffer, uploading, updating and (re)building its
+     * position stream as needed. Keeps memory accounting current.
+     */
+    MeshBuffer& prepareMeshBuffer(const Mesh& mesh)
+    {
+        uint64_t meshID = mesh.getID();
+        auto it = meshBuffers.find(meshID);
+        
+        if (it == meshBuffers.end())
+        {
+            // Upload new (or previously evicted) mesh
+            MeshBuffer buffer;
+            uploadMesh(mesh, buffer);
+            buffer.bounds = mesh.getBounds();
+            meshMemoryUsage += buffer.getByteSize();
+            it = meshBuffers.emplace(meshID, buffer).first;
+            const_cast<Mesh&>(mesh).clearDirty();
+        }
+        else if (mesh.getDirty())
+        {
+            // Re-upload dirty mesh
+            size_t previousBytes = it->second.getByteSize();
+            updateMeshIfDirty(mesh, it->second);
+            it->second.bounds = mesh.getBounds();
+            meshMemoryUsage = meshMemoryUsage - previousBytes + it->second.getByteSize();
+            const_cast<Mesh&>(mesh).clearDirty();
+        }
+        
+        // Position stream follows the renderer-wide setting
+        MeshBuffer& buffer = it->second;
+        if (buffer.positionFormat != positionStreamFormat)
+        {
+            size_t previousBytes = buffer.getByteSize();
+            destroyPositionStream(buffer);
+            if (positionStreamFormat != PositionStreamFormat::None)
+                createPositionStream(mesh, buffer, positionStreamFormat);
+            meshMemoryUsage = meshMemoryUsage - previousBytes + buffer.getByteSize();
+        }
+        
+        buffer.lastUsedFrame = frameIndex;
+        return buffer;
+    }
+
+    /**
+     * Commands drawn this frame: the retained list if one was submitted
+     * (it comes sorted), otherwise the queue, sorted here for batching
+     */
+    const std::vector<RenderCommand>& frameCommands()
+    {
+        return retainedCommands ? *retainedCommands : renderQueue.getCommands();
+    }
     
     /**
-     * Convert Vertex to PackedVertex format (27% smaller)
+     * Buffer for a queued command (skips the dirty check after prepareMeshes)
      */
-    PackedVertex packVertex(const Vertex& v)
+    MeshBuffer& commandBuffer(const RenderCommand& cmd)
     {
-        PackedVertex pv;
+        if (meshesPrepared)
+        {
+            auto it = meshBuffers.find(cmd.mesh->getID());
+            if (it != meshBuffers.end())
+                return it->second;
+        }
+        return prepareMeshBuffer(*cmd.mesh);
+    }
+
+    bool isDynamicBatchable(const RenderCommand& cmd) const
+    {
+        return cmd.mesh && !cmd.mesh->triangles.empty() &&
+               cmd.mesh->vertices.size() <= dynamicBatchMaxVertices;
+    }
+
+    /**
+     * Find runs of batchable commands in the sorted queue, bake them to
+     * world space and upload them to the stream buffer
+     * 
+     * Reads CPU mesh data, so it runs in prepareMeshes() when that is used.
+     * Runs need the same material, property block, lights and shadow
+     * receiving (their uniforms are shared) and at least two commands.
+     */
+    void buildDynamicBatches()
+    {
+        const auto& commands = frameCommands();
+        commandBatches.assign(commands.size(), NOT_BATCHED);
+        dynamicBatches.clear();
+        batchMembers.clear();
+        if (!dynamicBatching)
+            return;
         
-        // Position (full precision)
-        pv.position[0] = v.position.x;
-        pv.position[1] = v.position.y;
-        pv.position[2] = v.position.z;
+        size_t totalVertices = 0;
+        size_t totalIndices = 0;
+        for (size_t i = 0; i < commands.size();)
+        {
+            if (!isDynamicBatchable(commands[i]))
+            {
+                i++;
+                continue;
+            }
+            size_t end = i + 1;
+            while (end < commands.size() && isDynamicBatchable(commands[end]) &&
+                   commands[end].material == commands[i].material &&
+                   commands[end].properties == commands[i].properties &&
+                   commands[end].lights == commands[i].lights &&
+                   commands[end].receiveShadows == commands[i].receiveShadows)
+                end++;
+            
+            if (end - i >= 2)
+            {
+                DynamicBatch batch{ totalIndices, 0 };
+                for (size_t c = i; c < end; c++)
+                {
+                    batchMembers.push_back({ c, totalVertices, totalIndices });
+                    totalVertices += commands[c].mesh->vertices.size();
+                    totalIndices += commands[c].mesh->triangles.size() * 3;
+                    commandBatches[c] = BATCH_MEMBER;
+                }
+                batch.indexCount = totalIndices - batch.firstIndex;
+                commandBatches[i] = static_cast<int32_t>(dynamicBatches.size());
+                dynamicBatches.push_back(batch);
+            }
+            i = end;
+        }
+        if (dynamicBatches.empty())
+            return;
         
-        // Normal (octahedron packed)
-        packNormal(v.normal.x, v.normal.y, v.normal.z, pv.normal);
+        // Bake transforms across the job system (members write disjoint ranges)
+        batchVertices.resize(totalVertices);
+        batchIndices.resize(totalIndices);
+        JobSystem::getInstance().parallelFor(batchMembers.size(), 64, [&](size_t begin, size_t end) {
+            for (size_t m = begin; m < end; m++)
+            {
+                const DynamicBatchMember& member = batchMembers[m];
+                const RenderCommand& cmd = commands[member.command];
+                bool mirrored = VertexTransform::transformMesh(*cmd.mesh, cmd.modelMatrix,
+                                                               batchVertices.data() + member.firstVertex);
+                VertexTransform::copyIndices(*cmd.mesh, static_cast<unsigned int>(member.firstVertex),
+                                             mirrored, batchIndices.data() + member.firstIndex);
+            }
+        });
         
-        // UV (half float)
-        pv.uv[0] = floatToHalf(v.uv.x);
-        pv.uv[1] = floatToHalf(v.uv.y);
+        if (batchVAO == 0)
+        {
+            GL::GenVertexArrays(1, &batchVAO);
+            GL::GenBuffers(1, &batchVBO);
+            GL::GenBuffers(1, &batchEBO);
+            bindVAO(batchVAO);
+            GL::BindBuffer(GL_ARRAY_BUFFER, batchVBO);
+            configureVertexAttributes();
+        }
+        bindVAO(batchVAO);
         
-        // Color (8-bit per channel)
-        pv.color[0] = static_cast<uint8_t>(std::clamp(v.vertexColor.x * 255.0f, 0.0f, 255.0f));
-        pv.color[1] = static_cast<uint8_t>(std::clamp(v.vertexColor.y * 255.0f, 0.0f, 255.0f));
-        pv.color[2] = static_cast<uint8_t>(std::clamp(v.vertexColor.z * 255.0f, 0.0f, 255.0f));
-        pv.color[3] = 255; // Alpha
+        // Full-size glBufferData orphans last frame's storage (no stall)
+        GLsizeiptr vertexBytes = static_cast<GLsizeiptr>(totalVertices * sizeof(PackedVertex));
+        GL::BindBuffer(GL_ARRAY_BUFFER, batchVBO);
+        GL::BufferData(GL_ARRAY_BUFFER, vertexBytes, nullptr, GL_STREAM_DRAW);
+        void* mapped = GL::MapBufferRange(GL_ARRAY_BUFFER, 0, vertexBytes,
+                                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        bool written = false;
+        if (mapped)
+        {
+            VertexPacking::pack(batchVertices.data(), totalVertices, static_cast<PackedVertex*>(mapped));
+            written = GL::UnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+        }
+        if (!written)
+        {
+            packScratch.resize(totalVertices);
+            VertexPacking::pack(batchVertices.data(), totalVertices, packScratch.data());
+            GL::BufferSubData(GL_ARRAY_BUFFER, 0, vertexBytes, packScratch.data());
+        }
         
-        // Padding for future use
-        pv.padding[0] = 0.0f;
-        pv.padding[1] = 0.0f;
+        GL::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, batchEBO);
+        GL::BufferData(GL_ELEMENT_ARRAY_BUFFER, totalIndices * sizeof(unsigned int),
+                       batchIndices.data(), GL_STREAM_DRAW);
+        GL::BindBuffer(GL_ARRAY_BUFFER, 0);
+        bindVAO(0);
+    }
+
+    /**
+     * Bind VAO with state caching
+     */
+    void bindVAO(GLuint vao)
+    {
+        if (currentState.boundVAO != vao)
+        {
+            GL::BindVertexArray(vao);
+            currentState.boundVAO = vao;
+        }
+    }
+    
+    /**
+     * Use shader with state caching
+     */
+    void useShader(GLuint shaderID)
+    {
+        if (currentState.boundShader != shaderID)
+        {
+            GL::UseProgram(shaderID);
+            currentState.boundShader = shaderID;
+        }
+    }
+    
+    /**
+     * Uniform names of one lights[] element, built once (no per-draw strings)
+     */
+    struct LightUniformNames
+    {
+        std::string type, position, direction, color, intensity;
+    };
+    
+    static const std::vector<LightUniformNames>& lightUniformNames()
+    {
+        static const std::vector<LightUniformNames> names = []() {
+            std::vector<LightUniformNames> table(RenderConfig::MAX_LIGHTS);
+            for (int i = 0; i < RenderConfig::MAX_LIGHTS; i++)
+            {
+                std::string base = "lights[" + std::to_string(i) + "]";
+                table[i] = { base + ".type", base + ".position", base + ".direction",
+                             base + ".color", base + ".intensity" };
+            }
+            return table;
+        }();
+        return names;
+    }
+    
+    /**
+     * Set the legacy lights[] uniform array of the program in use
+     * @param set Lights to set; the default set means the first MAX_LIGHTS frame lights
+     */
+    void setLightUniforms(Shader& shader, const LightSet& set)
+    {
+        static const std::string numLightsName = "numLights";
+        const auto& names = lightUniformNames();
+        const auto& lightData = lightsUBO->get();
+        int count = std::min(set.isAll() ? lightData.numLights : set.count, RenderConfig::MAX_LIGHTS);
+        shader.setInt(numLightsName, count);
+        for (int i = 0; i < count; i++)
+        {
+            LightData light = {};
+            if (set.isAll())
+                light = lightData.lights[i];
+            else if (set.indices[i] < frameLights.size())
+            {
+                const Light& source = frameLights[set.indices[i]];
+                light.position = source.position;
+                light.type = source.type == Light::Type::Directional ? 0 : 1;
+                light.direction = source.direction;
+                light.intensity = source.intensity;
+                light.color = source.color;
+            }
+            
+            shader.setInt(names[i].type, light.type);
+            shader.setVec3(names[i].position, light.position);
+            shader.setVec3(names[i].direction, light.direction);
+            shader.setVec3(names[i].color, light.color);
+            shader.setFloat(names[i].intensity, light.intensity);
+        }
+    }
+    
+    /**
+     * Bind a texture object to a unit with state caching (no sampler)
+     */
+    void bindTextureID(GLenum target, GLuint texture, int unit)
+    {
+        bool cached = unit >= 0 && unit < RenderConfig::MAX_TEXTURE_UNITS;
+        if (cached && currentState.boundTextures[unit] == texture)
+            return;
         
-        return pv;
+        if (currentState.activeTextureUnit != unit)
+        {
+            GL::ActiveTexture(GL_TEXTURE0 + unit);
+            currentState.activeTextureUnit = unit;
+        }
+        GL::BindTexture(target, texture);
+        if (cached)
+            currentState.boundTextures[unit] = texture;
     }
-
+    
     /**
-     * Upload mesh data to GPU buffers (optimized format)
+     * Bind a texture object and a sampler object to a unit with state caching
      */
-    void uploadMesh(const Mesh& mesh, MeshBuffer& buffer)
+    void bindTextureID(GLenum target, GLuint texture, int unit, GLuint sampler)
     {
-        // Pack vertices into optimized format
-        std::vector<PackedVertex> packedVertices;
-        packedVertices.reserve(mesh.vertices.size());
-        
-        for (const auto& v : mesh.vertices)
+        bindTextureID(target, texture, unit);
+        if (unit < 0 || unit >= RenderConfig::MAX_TEXTURE_UNITS)
         {
-            packedVertices.push_back(packVertex(v));
+            GL::BindSampler(unit, sampler);
+            return;
         }
-
-        // Prepare index data
-        std::vector<unsigned int> indices;
-        indices.reserve(mesh.triangles.size() * 3);
-
-        for (const auto& tri : mesh.triangles)
+        if (currentState.boundSamplers[unit] != sampler)
         {
-            indices.push_back(tri.v0);
-            indices.push_back(tri.v1);
-            indices.push_back(tri.v2);
+            GL::BindSampler(unit, sampler);
+            currentState.boundSamplers[unit] = sampler;
+        }
+    }
+    
+    /**
+     * Bind a texture and its shared sampler to a unit with state caching
+     */
+    void bindTexture(const Texture& texture, int unit)
+    {
+        if (unit < 0 || unit >= RenderConfig::MAX_TEXTURE_UNITS)
+        {
+            texture.bind(unit);
+            currentState.activeTextureUnit = unit;
+            return;
         }
-
-        buffer.indexCount = indices.size();
-        buffer.meshID = mesh.getID();
-        buffer.usage = mesh.getUsage();
-
-        // Create VAO
-        glGenVertexArrays(1, &buffer.VAO);
-        glBindVertexArray(buffer.VAO);
-
-        // Create and fill VBO
-        glGenBuffers(1, &buffer.VBO);
-        glBindBuffer(GL_ARRAY_BUFFER, buffer.VBO);
-        glBufferData(GL_ARRAY_BUFFER, 
-                     packedVertices.size() * sizeof(PackedVertex), 
-                     packedVertices.data(), 
-                     toGLUsage(buffer.usage));
-
-        // Create and fill EBO
-        glGenBuffers(1, &buffer.EBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, 
-                     indices.size() * sizeof(unsigned int), 
-                     indices.data(), 
-                     toGLUsage(buffer.usage));
-
-        // Configure vertex attributes for PackedVertex format
         
-        // Position (location = 0): vec3 float
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PackedVertex), 
-                              (void*)offsetof(PackedVertex, position));
-        glEnableVertexAttribArray(0);
-
-        // Normal (location = 1): 2x int16 (normalized to [-1, 1])
-        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), 
-                              (void*)offsetof(PackedVertex, normal));
-        glEnableVertexAttribArray(1);
-
-        // UV (location = 2): 2x uint16 half float
-        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), 
-                              (void*)offsetof(PackedVertex, uv));
-        glEnableVertexAttribArray(2);
-
-        // Color (location = 3): 4x uint8 (normalized to [0, 1])
-        glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PackedVertex), 
-                              (void*)offsetof(PackedVertex, color));
-        glEnableVertexAttribArray(3);
-
-        glBindVertexArray(0);
+        bindTextureID(texture.getTarget(), texture.getID(), unit, samplers.get(texture));
     }
     
     /**
-     * Update mesh buffer if dirty
+     * Draw commands into the bound depth buffer with the position-only shader
      */
-    void updateMeshIfDirty(const Mesh& mesh, MeshBuffer& buffer)
+    void drawDepth(const std::vector<RenderCommand>& commands, const mat4& viewProjection)
     {
-        if (!mesh.getDirty())
+        if (commands.empty() || !depthShader || !depthShader->isValid())
             return;
-            
-        // Re-upload vertex and index data
-        std::vector<PackedVertex> packedVertices;
-        packedVertices.reserve(mesh.vertices.size());
         
-        for (const auto& v : mesh.vertices)
+        useShader(depthShader->getID());
+        depthShader->setMat4("depthViewProjection", viewProjection);
+        GL::ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        
+        for (const auto& cmd : commands)
         {
-            packedVertices.push_back(packVertex(v));
+            if (!cmd.mesh)
+                continue;
+            
+            MeshBuffer& buffer = commandBuffer(cmd);
+            depthShader->setMat4("model", cmd.modelMatrix);
+            depthShader->setVec3("positionScale", buffer.positionScale);
+            depthShader->setVec3("positionOffset", buffer.positionOffset);
+            
+            bindVAO(buffer.getDepthVAO());
+            GL::DrawElements(GL_TRIANGLES, buffer.indexCount, GL_UNSIGNED_INT, 0);
         }
         
-        std::vector<unsigned int> indices;
-        indices.reserve(mesh.triangles.size() * 3);
+        GL::ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        bindVAO(0);
+    }
+    
+    /**
+     * Commands whose depth the pre-pass may lay down (no alpha test or blending)
+     */
+    static bool isOpaque(const RenderCommand& cmd)
+    {
+        return cmd.mesh && (!cmd.material || cmd.material->getRenderQueue() == RenderQueue::Geometry);
+    }
+    
+    /**
+     * Sum of the opaque commands' screen rectangles (projected world bounds)
+     * over the screen area: roughly how many times each pixel is shaded
+     * without a pre-pass
+     */
+    float estimateOverdraw(const std::vector<RenderCommand>& commands)
+    {
+        const mat4& viewProjection = cameraUBO->get().viewProjection;
         
-        for (const auto& tri : mesh.triangles)
+        float coverage = 0.0f;
+        for (const auto& cmd : commands)
         {
-            indices.push_back(tri.v0);
-            indices.push_back(tri.v1);
-            indices.push_back(tri.v2);
+            if (!isOpaque(cmd))
+                continue;
+            const AABB& bounds = commandBuffer(cmd).bounds;
+            if (!bounds.isValid())
+                continue;
+            
+            AABB world = bounds.transformed(cmd.modelMatrix);
+            float minX = 1.0f, minY = 1.0f, maxX = -1.0f, maxY = -1.0f;
+            bool crossesNear = false;
+            for (int corner = 0; corner < 8 && !crossesNear; corner++)
+            {
+                vec3 p((corner & 1) ? world.max.x : world.min.x,
+                       (corner & 2) ? world.max.y : world.min.y,
+                       (corner & 4) ? world.max.z : world.min.z);
+                const auto& m = viewProjection.m;
+                float w = m[3][0] * p.x + m[3][1] * p.y + m[3][2] * p.z + m[3][3];
+                float z = m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3];
+                if (z < -w)
+                {
+                    crossesNear = true;
+                    break;
+                }
+                float x = (m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3]) / w;
+                float y = (m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3]) / w;
+                minX = std::min(minX, x); maxX = std::max(maxX, x);
+                minY = std::min(minY, y); maxY = std::max(maxY, y);
+            }
+            if (crossesNear)
+            {
+                coverage += 4.0f;  // Around the camera: assume it fills the screen
+                continue;
+            }
+            
+            // Clip the rectangle to the screen (NDC area is 4)
+            float width = std::min(maxX, 1.0f) - std::max(minX, -1.0f);
+            float height = std::min(maxY, 1.0f) - std::max(minY, -1.0f);
+            if (width > 0.0f && height > 0.0f)
+                coverage += width * height;
         }
+        return coverage / 4.0f;
+    }
+    
+    /**
+     * Whether this flush uses the pre-pass (Auto has some hysteresis, so it
+     * doesn't flip every frame around the threshold)
+     */
+    bool updateDepthPrepass(const std::vector<RenderCommand>& commands)
+    {
+        overdrawEstimate = 0.0f;
+        if (depthPrepassMode == DepthPrepassMode::Off || !depthShader || !depthShader->isValid())
+            return depthPrepassActive = false;
+        if (depthPrepassMode == DepthPrepassMode::On)
+            return depthPrepassActive = true;
         
-        buffer.indexCount = indices.size();
-        
-        glBindBuffer(GL_ARRAY_BUFFER, buffer.VBO);
-        glBufferData(GL_ARRAY_BUFFER, 
-                     packedVertices.size() * sizeof(PackedVertex), 
-                     packedVertices.data(), 
-                     toGLUsage(buffer.usage));
-        
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, 
-                     indices.size() * sizeof(unsigned int), 
-                     indices.data(), 
-                     toGLUsage(buffer.usage));
-        
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        overdrawEstimate = estimateOverdraw(commands);
+        float threshold = depthPrepassActive ? depthPrepassThreshold * 0.75f : depthPrepassThreshold;
+        return depthPrepassActive = overdrawEstimate >= threshold;
     }
     
     /**
-     * Bind VAO with state caching
+     * Lay down the opaque commands' depth, nearest first
+     * 
+     * Reads the same vertex positions as the color pass (the full VAO or
+     * an exact Float3 stream). Depth is pushed back slightly with a polygon
+     * offset, so the color pass passes GL_LEQUAL even where its shaders
+     * compute a position a rounding error farther away.
      */
-    void bindVAO(GLuint vao)
+    void drawDepthPrepass(const std::vector<RenderCommand>& commands)
     {
-        if (currentState.boundVAO != vao)
+        const auto& camData = cameraUBO->get();
+        prepassOrder.clear();
+        for (size_t i = 0; i < commands.size(); i++)
         {
-            glBindVertexArray(vao);
-            currentState.boundVAO = vao;
+            const RenderCommand& cmd = commands[i];
+            if (!isOpaque(cmd) || commandBatches[i] == BATCH_MEMBER)
+                continue;
+            vec3 origin(cmd.modelMatrix.m[0][3], cmd.modelMatrix.m[1][3], cmd.modelMatrix.m[2][3]);
+            prepassOrder.emplace_back(-camData.view.transformPoint(origin).z, static_cast<uint32_t>(i));
+        }
+        std::sort(prepassOrder.begin(), prepassOrder.end());
+        
+        useShader(depthShader->getID());
+        depthShader->setMat4("depthViewProjection", camData.viewProjection);
+        GL::ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        GL::Enable(GL_POLYGON_OFFSET_FILL);
+        GL::PolygonOffset(1.0f, 1.0f);
+        
+        for (const auto& entry : prepassOrder)
+        {
+            const RenderCommand& cmd = commands[entry.second];
+            int32_t batch = commandBatches[entry.second];
+            if (batch >= 0)
+            {
+                // Already in world space
+                const DynamicBatch& dynamicBatch = dynamicBatches[batch];
+                depthShader->setMat4("model", mat4::identity());
+                depthShader->setVec3("positionScale", vec3::one);
+                depthShader->setVec3("positionOffset", vec3::zero);
+                bindVAO(batchVAO);
+                GL::DrawElements(GL_TRIANGLES, (GLsizei)dynamicBatch.indexCount, GL_UNSIGNED_INT,
+                                 (void*)(dynamicBatch.firstIndex * sizeof(unsigned int)));
+                continue;
+            }
+            
+            MeshBuffer& buffer = commandBuffer(cmd);
+            bool exactStream = buffer.positionFormat == PositionStreamFormat::Float3;
+            depthShader->setMat4("model", cmd.modelMatrix);
+            depthShader->setVec3("positionScale", exactStream ? buffer.positionScale : vec3::one);
+            depthShader->setVec3("positionOffset", exactStream ? buffer.positionOffset : vec3::zero);
+            bindVAO(exactStream ? buffer.depthVAO : buffer.VAO);
+            GL::DrawElements(GL_TRIANGLES, buffer.indexCount, GL_UNSIGNED_INT, 0);
         }
+        
+        GL::Disable(GL_POLYGON_OFFSET_FILL);
+        GL::ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     }
     
     /**
-     * Use shader with state caching
+     * Draw the submitted shadow frame's casters (once per submitShadows)
      */
-    void useShader(GLuint shaderID)
+    void renderShadows()
     {
-        if (currentState.boundShader != shaderID)
+        if (!shadowFrame)
+            return;
+        const ShadowFrame& frame = *shadowFrame;
+        shadowFrame = nullptr;
+        if (frame.empty())
         {
-            glUseProgram(shaderID);
-            currentState.boundShader = shaderID;
+            shadowMaps.disable();
+            return;
         }
+        
+        // Recreated textures are bound on the active unit; flush() forgets
+        // texture bindings afterwards anyway
+        shadowMaps.resize(frame.resolution, frame.cascadeCount);
+        shadowMaps.render(frame, [this](const std::vector<RenderCommand>& casters, const mat4& viewProjection) {
+            drawDepth(casters, viewProjection);
+        });
     }
 
 public:
@@ -286,7 +1179,14 @@ public:
      * @brief Constructor - initializes member variables
      */
     OpenGLRenderer()
-        : activeShader(nullptr), initialized(false)
+        : activeShader(nullptr), initialized(false), mainLightIndex(0), shadowFrame(nullptr),
+          retainedCommands(nullptr), frameIndex(0),
+          meshMemoryUsage(0), meshMemoryBudget(0), meshDestroyListener(0),
+          positionStreamFormat(PositionStreamFormat::None), meshesPrepared(false),
+          dynamicBatching(false), dynamicBatchMaxVertices(RenderConfig::DYNAMIC_BATCH_MAX_VERTICES),
+          batchVAO(0), batchVBO(0), batchEBO(0),
+          depthPrepassMode(DepthPrepassMode::Auto), depthPrepassThreshold(RenderConfig::DEPTH_PREPASS_OVERDRAW),
+          depthPrepassActive(false), overdrawEstimate(0.0f)
     {
     }
 
@@ -298,6 +1198,8 @@ public:
         cleanup();
     }
 
+    const char* getName() const override { return "OpenGL"; }
+
     /**
      * @brief Initialize renderer with default shader and UBOs
      * Must be called after OpenGL context is created
@@ -311,12 +1213,22 @@ public:
         activeShader = std::make_shared<Shader>();
         if (!activeShader->compileFromSource(
             DefaultShaders::BLINN_PHONG_VERTEX,
-            DefaultShaders::BLINN_PHONG_FRAGMENT))
+            DefaultShaders::withLighting(DefaultShaders::BLINN_PHONG_FRAGMENT).c_str()))
         {
             std::cerr << "Failed to compile default shader" << std::endl;
             return false;
         }
         
+        // Depth-only shader (pre-pass, shadows, picking)
+        depthShader = std::make_shared<Shader>();
+        if (!depthShader->compileFromSource(
+            DefaultShaders::DEPTH_ONLY_VERTEX,
+            DefaultShaders::DEPTH_ONLY_FRAGMENT))
+        {
+            std::cerr << "Failed to compile depth-only shader" << std::endl;
+            return false;
+        }
+        
         // Bind UBO blocks in default shader
         activeShader->use();
         activeShader->bindUniformBlock("CameraData", UBOBindings::CAMERA);
@@ -325,17 +1237,25 @@ public:
         // Create UBOs
         cameraUBO = std::make_unique<UniformBuffer<CameraUBO>>(UBOBindings::CAMERA);
         lightsUBO = std::make_unique<UniformBuffer<LightsUBO>>(UBOBindings::LIGHTS);
+        clusteredLighting.initialize();
+        shadowMaps.initialize();
+        
+        // Release GPU buffers when their Mesh is destroyed
+        meshDestroyListener = Mesh::addDestroyListener([this](uint64_t meshID) {
+            std::lock_guard<std::mutex> lock(destroyedMeshMutex);
+            destroyedMeshIDs.push_back(meshID);
+        });
 
         // Enable depth testing
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        GL::Enable(GL_DEPTH_TEST);
+        GL::DepthFunc(GL_LESS);
         currentState.depthTestEnabled = true;
 
         // Disable backface culling by default (can be enabled per-material)
         // Ground planes and other double-sided geometry need this off
-        glDisable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
-        glFrontFace(GL_CCW);  // Counter-clockwise winding = front face
+        GL::Disable(GL_CULL_FACE);
+        GL::CullFace(GL_BACK);
+        GL::FrontFace(GL_CCW);  // Counter-clockwise winding = front face
         currentState.cullFaceEnabled = false;
 
         initialized = true;
@@ -379,20 +1299,41 @@ public:
     {
         if (!initialized) return;
 
-        // Delete all mesh buffers
+        Mesh::removeDestroyListener(meshDestroyListener);
+        meshDestroyListener = 0;
+        destroyedMeshIDs.clear();
+        
+        // Delete all mesh buffers (live and retired)
+        bindVAO(0);
         for (auto& pair : meshBuffers)
         {
-            glDeleteVertexArrays(1, &pair.second.VAO);
-            glDeleteBuffers(1, &pair.second.VBO);
-            glDeleteBuffers(1, &pair.second.EBO);
+            deleteMeshBuffer(pair.second);
         }
         meshBuffers.clear();
+        for (auto& retired : retiredBuffers)
+        {
+            deleteMeshBuffer(retired.buffer);
+        }
+        retiredBuffers.clear();
+        
+        if (batchVAO != 0)
+        {
+            GL::DeleteVertexArrays(1, &batchVAO);
+            GL::DeleteBuffers(1, &batchVBO);
+            GL::DeleteBuffers(1, &batchEBO);
+            batchVAO = batchVBO = batchEBO = 0;
+        }
         
         // UBOs cleaned up by unique_ptr
         cameraUBO.reset();
         lightsUBO.reset();
+        clusteredLighting.cleanup();
+        shadowMaps.cleanup();
+        samplers.clear();
+        currentState.resetTextures();
 
         activeShader.reset();
+        depthShader.reset();
         initialized = false;
     }
 
@@ -401,8 +1342,13 @@ public:
      */
     void clear(float r = 0.1f, float g = 0.1f, float b = 0.15f)
     {
-        glClearColor(r, g, b, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        GL::ClearColor(r, g, b, 1.0f);
+        GL::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    void clear(const color& clearColor) override
+    {
+        clear(clearColor.x, clearColor.y, clearColor.z);
     }
     
     /**
@@ -410,8 +1356,12 @@ public:
      * @param camera Camera for view/projection
      * @param lights Array of scene lights
      */
-    void beginFrame(const Camera& camera, const std::vector<Light>& lights)
+    void beginFrame(const Camera& camera, const std::vector<Light>& lights) override
     {
+        // Advance frame and release GPU buffers that are no longer needed
+        frameIndex++;
+        collectMeshBuffers();
+        
         // Update camera UBO
         auto& camData = cameraUBO->get();
         camData.view = camera.getViewMatrix();
@@ -433,9 +1383,26 @@ public:
             lightData.lights[i].color = lights[i].color;
         }
         lightsUBO->upload();
+        frameLights = lights;
+        mainLightIndex = 0;
+        for (size_t i = 0; i < lights.size(); i++)
+        {
+            if (lights[i].type == Light::Type::Directional)
+            {
+                mainLightIndex = i;
+                break;
+            }
+        }
+        
+        // All lights, assigned to the view's clusters
+        clusteredLighting.update(camera, lights);
         
         // Clear render queue
         renderQueue.clear();
+        retainedCommands = nullptr;
+        shadowFrame = nullptr;
+        shadowMaps.disable();
+        meshesPrepared = false;
     }
     
     /**
@@ -446,68 +1413,145 @@ public:
      */
     void submit(const Mesh& mesh, const mat4& modelMatrix, Material* material = nullptr)
     {
-        // Calculate depth for sorting (extract translation from matrix)
-        // Matrix is row-major in our engine, translation is in row 3
-        vec3 worldPos(modelMatrix.m[3][0], modelMatrix.m[3][1], modelMatrix.m[3][2]);
-        
-        // Use Z depth for sorting
-        float depth = worldPos.z;
-        
-        renderQueue.submit(&mesh, material, modelMatrix, depth);
+        renderQueue.submit(RenderCommand::create(&mesh, material, modelMatrix));
+        meshesPrepared = false;
+    }
+
+    /**
+     * @brief Submit pre-recorded commands (e.g. from DrawCommandQueue::recordParallel)
+     * A sorted queue submitted into an empty frame isn't sorted again.
+     * Meshes and materials must stay alive until flush().
+     */
+    void submit(const DrawCommandQueue& commands) override
+    {
+        renderQueue.append(commands);
+        meshesPrepared = false;
+    }
+
+    /**
+     * @brief Draw a caller-owned sorted list this frame (see RenderBackend)
+     * Skips the per-frame copy and sort; dynamic batches are still rebuilt
+     * from it when batching is enabled.
+     */
+    void submitRetained(const std::vector<RenderCommand>& commands) override
+    {
+        retainedCommands = &commands;
+        meshesPrepared = false;
+    }
+
+    /**
+     * @brief Shadow casters for this frame (see ShadowView)
+     * The next flush() draws them before the scene; cascades not marked
+     * staticDirty reuse the static depth cached by earlier frames.
+     */
+    void submitShadows(const ShadowFrame& shadows) override
+    {
+        shadowFrame = &shadows;
+        meshesPrepared = false;
+    }
+
+    /**
+     * @brief Upload new or changed meshes for every submitted command
+     * 
+     * Optional: flushes do this lazily. Calling it first confines all reads
+     * of CPU mesh data to this call, so another thread may edit meshes
+     * while the following flush() is still issuing draws.
+     */
+    void prepareMeshes()
+    {
+        if (!initialized)
+            return;
+        for (const auto& cmd : frameCommands())
+        {
+            if (cmd.mesh)
+                prepareMeshBuffer(*cmd.mesh);
+        }
+        if (shadowFrame)
+        {
+            for (int i = 0; i < shadowFrame->cascadeCount; i++)
+            {
+                for (const auto& cmd : shadowFrame->cascades[i].staticCasters)
+                    prepareMeshBuffer(*cmd.mesh);
+                for (const auto& cmd : shadowFrame->cascades[i].dynamicCasters)
+                    prepareMeshBuffer(*cmd.mesh);
+            }
+        }
+        buildDynamicBatches();
+        meshesPrepared = true;
     }
 
     /**
      * @brief Flush render queue - execute all submitted commands
      */
-    void flush()
+    void flush() override
     {
-        if (!initialized || renderQueue.empty())
+        if (!initialized)
+            return;
+        
+        // Shadow casters first, so cached layers stay in step with ShadowView
+        renderShadows();
+        if (frameCommands().empty())
             return;
         
         // Get camera/light data for legacy uniforms
         auto& camData = cameraUBO->get();
-        auto& lightData = lightsUBO->get();
         
-        // Sort commands for optimal batching
-        renderQueue.sort();
+        if (!meshesPrepared)
+            buildDynamicBatches();
+        
+        const auto& commands = frameCommands();
+        
+        // Opaque depth first: the color pass then shades each pixel about once
+        bool prepass = updateDepthPrepass(commands);
+        if (prepass)
+        {
+            drawDepthPrepass(commands);
+            GL::DepthFunc(GL_LEQUAL);
+        }
         
-        const auto& commands = renderQueue.getCommands();
+        // Texture bindings may have changed since the last flush (uploads)
+        currentState.resetTextures();
+        auto bindTextureCached = [this](const Texture& texture, int unit) { bindTexture(texture, unit); };
         
         // Track last bound states to minimize changes
         Material* lastMaterial = nullptr;
+        bool materialBound = false;  // nullptr is a valid (default) material
         const Mesh* lastMesh = nullptr;
+        const MaterialPropertyBlock* boundProperties = nullptr;  // Overrides currently set
+        Shader* propertiesShader = nullptr;                      // ...on this program
+        LightSet boundLights;                                    // In the program's lights[] array
+        float boundShadowStrength = -1.0f;                       // -1 = not set on this program
         
-        for (const auto& cmd : commands)
+        for (size_t commandIndex = 0; commandIndex < commands.size(); commandIndex++)
         {
-            if (!cmd.mesh)
+            const RenderCommand& cmd = commands[commandIndex];
+            int32_t batch = commandBatches[commandIndex];
+            if (!cmd.mesh || batch == BATCH_MEMBER)
                 continue;
             
-            // Get or create mesh buffer
-            uint64_t meshID = cmd.mesh->getID();
-            auto it = meshBuffers.find(meshID);
-            
-            if (it == meshBuffers.end())
-            {
-                // Upload new mesh
-                MeshBuffer buffer;
-                uploadMesh(*cmd.mesh, buffer);
-                meshBuffers[meshID] = buffer;
-                it = meshBuffers.find(meshID);
-                const_cast<Mesh*>(cmd.mesh)->clearDirty();
-            }
-            else if (cmd.mesh->getDirty())
-            {
-                // Re-upload dirty mesh
-                updateMeshIfDirty(*cmd.mesh, it->second);
-                const_cast<Mesh*>(cmd.mesh)->clearDirty();
-            }
-            
-            const MeshBuffer& buffer = it->second;
+            // Get or create mesh buffer (dynamic batches draw from the stream buffer)
+            MeshBuffer* buffer = batch == NOT_BATCHED ? &commandBuffer(cmd) : nullptr;
             
             // Bind material/shader (minimize state changes)
             std::shared_ptr<Shader> shaderToUse;
-            if (cmd.material != lastMaterial)
+            if (materialBound && lastMaterial && cmd.material && cmd.material != lastMaterial &&
+                cmd.material->getShader() && cmd.material->getShader()->isValid() &&
+                cmd.material->isBatchCompatible(*lastMaterial))
+            {
+                // Same program, uniforms and textures: only the array layer differs
+                shaderToUse = cmd.material->getShader();
+                shaderToUse->setFloat("_MainTexLayer", cmd.material->getFloat("_MainTexLayer"));
+                lastMaterial = cmd.material;
+            }
+            else if (!materialBound || cmd.material != lastMaterial)
             {
+                // Undo overrides on the outgoing program before leaving it
+                if (boundProperties)
+                {
+                    boundProperties->restoreShader(*propertiesShader, lastMaterial);
+                    boundProperties = nullptr;
+                }
+                
                 if (cmd.material && cmd.material->getShader() && cmd.material->getShader()->isValid())
                 {
                     shaderToUse = cmd.material->getShader();
@@ -515,7 +1559,7 @@ public:
                     
                     // Apply material properties - check for validity first
                     try {
-                        cmd.material->applyToShader();
+                        cmd.material->applyToShader(bindTextureCached);
                     } catch (...) {
                         // Fallback to default shader if material application fails
                         shaderToUse = activeShader;
@@ -550,26 +1594,31 @@ public:
                 shaderToUse->setVec3("viewPos", camData.position);
                 
                 // Set light uniforms
-                shaderToUse->setInt("numLights", lightData.numLights);
-                for (int i = 0; i < lightData.numLights; i++)
-                {
-                    std::string base = "lights[" + std::to_string(i) + "]";
-                    shaderToUse->setInt(base + ".type", lightData.lights[i].type);
-                    shaderToUse->setVec3(base + ".position", lightData.lights[i].position);
-                    shaderToUse->setVec3(base + ".direction", lightData.lights[i].direction);
-                    shaderToUse->setVec3(base + ".color", lightData.lights[i].color);
-                    shaderToUse->setFloat(base + ".intensity", lightData.lights[i].intensity);
-                }
+                setLightUniforms(*shaderToUse, LightSet());
+                boundLights = LightSet();
+                
+                // Clustered point/spot lights (built-in shaders)
+                clusteredLighting.bind(*shaderToUse, [this](GLenum target, GLuint texture, int unit) {
+                    bindTextureID(target, texture, unit);
+                });
+                
+                // Directional shadows (built-in shaders)
+                shadowMaps.bind(*shaderToUse, [this](GLenum target, GLuint texture, GLuint sampler, int unit) {
+                    bindTextureID(target, texture, unit, sampler);
+                });
+                boundShadowStrength = -1.0f;
                 
-                // Simple lighting uniforms (for Standard/Unlit shaders)
-                if (lightData.numLights > 0)
+                // Simple lighting uniforms (for Standard/Unlit shaders): the
+                // main directional light, which is the one that casts shadows
+                if (!frameLights.empty())
                 {
-                    shaderToUse->setVec3("lightDir", lightData.lights[0].direction);
-                    shaderToUse->setVec3("lightColor", lightData.lights[0].color);
+                    shaderToUse->setVec3("lightDir", frameLights[mainLightIndex].direction);
+                    shaderToUse->setVec3("lightColor", frameLights[mainLightIndex].color);
                     shaderToUse->setVec3("ambientColor", vec3(0.1f, 0.1f, 0.15f));
                 }
                 
                 lastMaterial = cmd.material;
+                materialBound = true;
             }
             else
             {
@@ -581,23 +1630,108 @@ public:
             if (!shaderToUse || !shaderToUse->isValid())
                 continue;
             
+            // Per-renderer overrides (MaterialPropertyBlock): only the changed
+            // uniforms are set, the material itself stays bound
+            if (cmd.properties != boundProperties)
+            {
+                if (boundProperties)
+                    boundProperties->restoreShader(*shaderToUse, cmd.material, cmd.properties);
+                if (cmd.properties)
+                    cmd.properties->applyToShader(*shaderToUse);
+                boundProperties = cmd.properties;
+                propertiesShader = shaderToUse.get();
+            }
+            
+            // Per-object lights, for shaders with a lights[] array (the
+            // built-in shaders get every light from the clusters instead)
+            if (cmd.lights != boundLights && shaderToUse->hasUniform("numLights"))
+            {
+                setLightUniforms(*shaderToUse, cmd.lights);
+                boundLights = cmd.lights;
+            }
+            
+            float shadowStrength = cmd.receiveShadows ? 1.0f : 0.0f;
+            if (shadowStrength != boundShadowStrength && shadowMaps.isActive())
+            {
+                shaderToUse->setFloat("shadowStrength", shadowStrength);
+                boundShadowStrength = shadowStrength;
+            }
+            
+            if (!buffer)
+            {
+                // Whole run at once, already in world space
+                const DynamicBatch& dynamicBatch = dynamicBatches[batch];
+                shaderToUse->setMat4("model", mat4::identity());
+                bindVAO(batchVAO);
+                GL::DrawElements(GL_TRIANGLES, (GLsizei)dynamicBatch.indexCount, GL_UNSIGNED_INT,
+                                 (void*)(dynamicBatch.firstIndex * sizeof(unsigned int)));
+                lastMesh = cmd.mesh;
+                continue;
+            }
+            
             // Set model matrix (per-object uniform)
             shaderToUse->setMat4("model", cmd.modelMatrix);
             
             // Bind VAO and draw (cached)
-            bindVAO(buffer.VAO);
-            glDrawElements(GL_TRIANGLES, buffer.indexCount, GL_UNSIGNED_INT, 0);
+            bindVAO(buffer->VAO);
+            GL::DrawElements(GL_TRIANGLES, buffer->indexCount, GL_UNSIGNED_INT, 0);
             
             lastMesh = cmd.mesh;
         }
         
+        // Leave the program with its material's values for the next frame
+        if (boundProperties)
+            boundProperties->restoreShader(*propertiesShader, lastMaterial);
+        
+        if (prepass)
+            GL::DepthFunc(GL_LESS);
+        
         // Unbind VAO
         bindVAO(0);
         
         // Clear queue for next frame
         renderQueue.clear();
+        retainedCommands = nullptr;
+        meshesPrepared = false;
+    }
+    
+    /**
+     * @brief Draw submitted commands into the depth buffer only
+     * 
+     * Uses each mesh's position-only stream when enabled (see
+     * setPositionStreamFormat), otherwise the full vertex VAO. Color writes
+     * are masked and materials are ignored. The queue is left intact so a
+     * following flush() can shade the same commands.
+     * 
+     * @param viewProjection View-projection to render with (camera, light, ...)
+     */
+    void flushDepthOnly(const mat4& viewProjection)
+    {
+        if (!initialized)
+            return;
+        drawDepth(frameCommands(), viewProjection);
+    }
+    
+    /**
+     * @brief Depth-only pass from the camera set in beginFrame()
+     */
+    void flushDepthOnly()
+    {
+        if (!initialized)
+            return;
+        flushDepthOnly(cameraUBO->get().viewProjection);
     }
     
+    /**
+     * @brief Shadow maps from the last flush (for debugging and stats)
+     */
+    const CascadedShadowMaps& getShadowMaps() const { return shadowMaps; }
+    
+    /**
+     * @brief Depth bias used while drawing shadow casters
+     */
+    void setShadowDepthBias(float slope, float constant) { shadowMaps.setDepthBias(slope, constant); }
+    
     /**
      * @brief Legacy immediate draw (for backward compatibility)
      * Prefer submit() + flush() for better performance
@@ -627,11 +1761,11 @@ public:
         {
             if (enabled)
             {
-                glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+                GL::PolygonMode(GL_FRONT_AND_BACK, GL_LINE);
             }
             else
             {
-                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+                GL::PolygonMode(GL_FRONT_AND_BACK, GL_FILL);
             }
             currentState.wireframeMode = enabled;
         }
@@ -646,11 +1780,11 @@ public:
         {
             if (enabled)
             {
-                glEnable(GL_CULL_FACE);
+                GL::Enable(GL_CULL_FACE);
             }
             else
             {
-                glDisable(GL_CULL_FACE);
+                GL::Disable(GL_CULL_FACE);
             }
             currentState.cullFaceEnabled = enabled;
         }
@@ -666,10 +1800,99 @@ public:
      */
     size_t getMeshBufferCount() const { return meshBuffers.size(); }
     
+    /**
+     * Get GPU bytes held by mesh buffers (including ones awaiting release)
+     */
+    size_t getMeshMemoryUsage() const { return meshMemoryUsage; }
+    
+    /**
+     * Set mesh memory budget in bytes (0 = unlimited)
+     * When exceeded, buffers of meshes not drawn recently are evicted
+     * least-recently-used first and re-uploaded if drawn again.
+     */
+    void setMeshMemoryBudget(size_t bytes) { meshMemoryBudget = bytes; }
+    
+    /**
+     * Get mesh memory budget in bytes (0 = unlimited)
+     */
+    size_t getMeshMemoryBudget() const { return meshMemoryBudget; }
+    
+    /**
+     * Get number of mesh buffers waiting for in-flight frames before deletion
+     */
+    size_t getRetiredBufferCount() const { return retiredBuffers.size(); }
+    
+    /**
+     * Choose the position-only stream kept alongside each mesh's VBO
+     * Float3 (12 bytes) is exact; Snorm16 (8 bytes) quantizes to the mesh
+     * bounds and suits shadow/picking passes. Existing buffers switch
+     * format the next time they are drawn. None frees the streams.
+     */
+    void setPositionStreamFormat(PositionStreamFormat format) { positionStreamFormat = format; }
+    
+    /**
+     * @brief Merge consecutive draws of small meshes sharing a material
+     * @param enabled Off by default
+     * @param maxVertices Meshes above this stay separate draws; baking
+     *        large meshes on the CPU each frame costs more than the draw
+     * 
+     * Batched meshes are transformed to world space on the CPU every
+     * frame (SIMD, across the job system) and drawn from one streaming
+     * buffer. Pays off for many small moving meshes; static geometry is
+     * better served by StaticBatcher.
+     */
+    void setDynamicBatching(bool enabled, size_t maxVertices = RenderConfig::DYNAMIC_BATCH_MAX_VERTICES)
+    {
+        dynamicBatching = enabled;
+        dynamicBatchMaxVertices = maxVertices;
+        meshesPrepared = false;
+    }
+    
+    bool isDynamicBatching() const { return dynamicBatching; }
+    
+    /**
+     * @brief Dynamic batches drawn by the last flush
+     */
+    size_t getDynamicBatchCount() const { return dynamicBatches.size(); }
+    
+    /**
+     * @brief Depth pre-pass for opaque commands
+     * @param mode On/Off, or Auto: only when the estimated overdraw reaches the threshold
+     * @param overdrawThreshold Average opaque layers per pixel that turn Auto on
+     * 
+     * The pre-pass draws opaque (Geometry queue) depth front to back with the
+     * depth-only shader; the color pass then tests GL_LEQUAL, so early-Z
+     * rejects every hidden fragment before the material shader runs. It
+     * pays off for expensive shaders and deep scenes, and costs a second
+     * vertex pass otherwise.
+     */
+    void setDepthPrepass(DepthPrepassMode mode, float overdrawThreshold = RenderConfig::DEPTH_PREPASS_OVERDRAW)
+    {
+        depthPrepassMode = mode;
+        depthPrepassThreshold = overdrawThreshold;
+    }
+    
+    DepthPrepassMode getDepthPrepass() const { return depthPrepassMode; }
+    
+    /**
+     * @brief Whether the last flush ran the pre-pass
+     */
+    bool isDepthPrepassActive() const { return depthPrepassActive; }
+    
+    /**
+     * @brief Estimated opaque layers per pixel in the last flush (Auto mode only)
+     */
+    float getOverdrawEstimate() const { return overdrawEstimate; }
+    
+    /**
+     * Get the position-only stream format
+     */
+    PositionStreamFormat getPositionStreamFormat() const { return positionStreamFormat; }
+    
     /**
      * Get number of pending draw commands
      */
-    size_t getPendingCommandCount() const { return renderQueue.size(); }
+    size_t getPendingCommandCount() const { return retainedCommands ? retainedCommands->size() : renderQueue.size(); }
 };
 
 #endif //OPENGL_RENDERER_H
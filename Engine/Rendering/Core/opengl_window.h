@@ -5,12 +5,7 @@
 #include <string>
 #include <iostream>
 
-#ifdef __APPLE__
-#define GL_SILENCE_DEPRECATION
-#include <OpenGL/gl3.h>
-#else
-#include <GL/glew.h>
-#endif
+#include "gl_dispatch.h"
 
 /**
  * @class OpenGLWindow
@@ -18,6 +13,12 @@
  * 
  * Handles window creation, OpenGL context setup, event polling,
  * and buffer swapping for rendering.
+ *
+ * A hidden window (visible = false) only provides the context, e.g. for
+ * rendering into a RenderTarget on a server. Without a display, run under
+ * Xvfb, or set SDL_VIDEODRIVER=offscreen for SDL's EGL-based driver (GLEW
+ * must then be built with EGL support). LIBGL_ALWAYS_SOFTWARE=1 selects
+ * Mesa's llvmpipe.
  */
 class OpenGLWindow
 {
@@ -28,19 +29,22 @@ public:
     int width;
     int height;
     bool isOpen;
+    bool visible;
 
     /**
      * @brief Construct a new OpenGLWindow object
      * @param w Width of the window
      * @param h Height of the window
      * @param title Title of the window
+     * @param show false for a hidden window (offscreen rendering, no vsync)
      */
-    OpenGLWindow(int w, int h, const std::string& title = "CPP Graphics Engine - OpenGL")
+    OpenGLWindow(int w, int h, const std::string& title = "CPP Graphics Engine - OpenGL", bool show = true)
         : window(nullptr),
           glContext(nullptr),
           width(w),
           height(h),
-          isOpen(false)
+          isOpen(false),
+          visible(show)
     {
         if (SDL_Init(SDL_INIT_VIDEO) < 0)
         {
@@ -67,7 +71,8 @@ public:
             SDL_WINDOWPOS_CENTERED,
             width,
             height,
-            SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
+            visible ? SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
+                    : SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN
         );
 
         if (!window)
@@ -86,8 +91,8 @@ public:
             return;
         }
 
-        // Enable VSync
-        SDL_GL_SetSwapInterval(1);
+        // Enable VSync (nothing to sync to when hidden)
+        SDL_GL_SetSwapInterval(visible ? 1 : 0);
 
 #ifndef __APPLE__
         // Initialize GLEW (not needed on macOS)
@@ -106,11 +111,11 @@ public:
         isOpen = true;
         
         // Set initial viewport
-        glViewport(0, 0, width, height);
+        GL::Viewport(0, 0, width, height);
         
         std::cout << "OpenGL Window created: " << width << "x" << height << std::endl;
-        std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
-        std::cout << "GLSL Version: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << std::endl;
+        std::cout << "OpenGL Version: " << GL::GetString(GL_VERSION) << std::endl;
+        std::cout << "GLSL Version: " << GL::GetString(GL_SHADING_LANGUAGE_VERSION) << std::endl;
     }
 
     /**
@@ -140,6 +145,27 @@ public:
         isOpen = false;
     }
 
+    /**
+     * @brief Make the OpenGL context current on the calling thread
+     * @return true on success
+     */
+    bool makeCurrent()
+    {
+        if (!window || !glContext) return false;
+        return SDL_GL_MakeCurrent(window, glContext) == 0;
+    }
+
+    /**
+     * @brief Detach the OpenGL context from the calling thread
+     * A context can only be current on one thread; call this before
+     * another thread calls makeCurrent().
+     */
+    void releaseContext()
+    {
+        if (window)
+            SDL_GL_MakeCurrent(window, nullptr);
+    }
+
     /**
      * @brief Swap the front and back buffers
      */
@@ -177,7 +203,9 @@ public:
                 {
                     width = event.window.data1;
                     height = event.window.data2;
-                    glViewport(0, 0, width, height);
+                    // With a render thread the context lives there; it sets the viewport itself
+                    if (SDL_GL_GetCurrentContext() == glContext)
+                        GL::Viewport(0, 0, width, height);
                 }
             }
         }
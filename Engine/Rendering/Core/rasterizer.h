@@ -10,6 +10,7 @@
 #include "../camera.h"
 #include "../light.h"
 #include "../../Math/mat4.h"
+#include "../../Math/frustum.h"
 #include <algorithm>
 #include <cmath>
 
@@ -46,6 +47,7 @@ public:
 
     RenderMode renderMode;
     bool backfaceCulling;
+    bool frustumCulling;   // Skip meshes whose bounds are outside the view
     color wireframeColor;
 
     /**
@@ -54,6 +56,7 @@ public:
     Rasterizer()
         : renderMode(RenderMode::Solid),
           backfaceCulling(true),
+          frustumCulling(true),
           wireframeColor(1, 1, 1) {}
 
     /**
@@ -63,11 +66,18 @@ public:
      * @param modelMatrix Model transformation matrix
      * @param camera Camera for view and projection
      * @param lights Scene lights for shading
+     * @param tint Multiplied into the vertex colors (e.g. a material's _Color)
      */
     void drawMesh(Framebuffer& fb, const Mesh& mesh, const mat4& modelMatrix, 
-                  const Camera& camera, const std::vector<Light>& lights)
+                  const Camera& camera, const std::vector<Light>& lights,
+                  const color& tint = color(1, 1, 1))
     {
         mat4 mvp = camera.getViewProjectionMatrix() * modelMatrix;
+
+        // Planes from the MVP are in object space, so the cached local bounds test directly
+        if (frustumCulling && !Frustum::fromMatrix(mvp).intersects(mesh.getBounds()))
+            return;
+
         mat4 mv = camera.getViewMatrix() * modelMatrix;
 
         // Transform vertices
@@ -146,15 +156,147 @@ public:
                     screenPositions[tri.v0], screenPositions[tri.v1], screenPositions[tri.v2],
                     transformedNormals[tri.v0], transformedNormals[tri.v1], transformedNormals[tri.v2],
                     worldPositions[tri.v0], worldPositions[tri.v1], worldPositions[tri.v2],
-                    mesh.vertices[tri.v0].vertexColor, 
-                    mesh.vertices[tri.v1].vertexColor, 
-                    mesh.vertices[tri.v2].vertexColor,
+                    mesh.vertices[tri.v0].vertexColor * tint, 
+                    mesh.vertices[tri.v1].vertexColor * tint, 
+                    mesh.vertices[tri.v2].vertexColor * tint,
                     camera, lights);
             }
         }
     }
 
+    /**
+     * @brief Rasterize a mesh into the depth buffer only (no shading)
+     * @param fb Target framebuffer (may be depth-only)
+     * @param mesh Mesh to draw
+     * @param mvp Model-view-projection matrix
+     *
+     * Triangles are clipped against the near plane, so meshes that pass
+     * the camera are handled. A pixel is covered when its center is inside
+     * a triangle. Used to render occluders (see OcclusionCuller).
+     */
+    void drawMeshDepth(Framebuffer& fb, const Mesh& mesh, const mat4& mvp)
+    {
+        if (frustumCulling && !Frustum::fromMatrix(mvp).intersects(mesh.getBounds()))
+            return;
+
+        clipPositions.resize(mesh.vertices.size());
+        for (size_t i = 0; i < mesh.vertices.size(); i++)
+        {
+            const vec3& p = mesh.vertices[i].position;
+            ClipVertex& c = clipPositions[i];
+            c.x = mvp.m[0][0] * p.x + mvp.m[0][1] * p.y + mvp.m[0][2] * p.z + mvp.m[0][3];
+            c.y = mvp.m[1][0] * p.x + mvp.m[1][1] * p.y + mvp.m[1][2] * p.z + mvp.m[1][3];
+            c.z = mvp.m[2][0] * p.x + mvp.m[2][1] * p.y + mvp.m[2][2] * p.z + mvp.m[2][3];
+            c.w = mvp.m[3][0] * p.x + mvp.m[3][1] * p.y + mvp.m[3][2] * p.z + mvp.m[3][3];
+        }
+
+        for (const auto& tri : mesh.triangles)
+        {
+            const ClipVertex in[3] = { clipPositions[tri.v0], clipPositions[tri.v1], clipPositions[tri.v2] };
+
+            // Near plane is z = -w (inside when z + w >= 0)
+            float dist[3] = { in[0].z + in[0].w, in[1].z + in[1].w, in[2].z + in[2].w };
+            if (dist[0] < 0.0f && dist[1] < 0.0f && dist[2] < 0.0f)
+                continue;
+
+            ClipVertex polygon[4];
+            int count = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                int next = (k + 1) % 3;
+                if (dist[k] >= 0.0f)
+                    polygon[count++] = in[k];
+                if ((dist[k] >= 0.0f) != (dist[next] >= 0.0f))
+                {
+                    float t = dist[k] / (dist[k] - dist[next]);
+                    polygon[count++] = ClipVertex::lerp(in[k], in[next], t);
+                }
+            }
+
+            vec3 screen[4];
+            for (int k = 0; k < count; k++)
+            {
+                float invW = 1.0f / polygon[k].w;
+                screen[k] = vec3((polygon[k].x * invW + 1.0f) * 0.5f * fb.width,
+                                 (1.0f - polygon[k].y * invW) * 0.5f * fb.height,
+                                 (polygon[k].z * invW + 1.0f) * 0.5f);
+            }
+
+            for (int k = 1; k + 1 < count; k++)
+                drawDepthTriangle(fb, screen[0], screen[k], screen[k + 1]);
+        }
+    }
+
 private:
+    /**
+     * @brief Homogeneous clip-space position
+     */
+    struct ClipVertex
+    {
+        float x, y, z, w;
+
+        static ClipVertex lerp(const ClipVertex& a, const ClipVertex& b, float t)
+        {
+            return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t,
+                     a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t };
+        }
+    };
+
+    std::vector<ClipVertex> clipPositions;  // Scratch for drawMeshDepth
+
+    /**
+     * @brief Depth-only triangle fill using edge functions (screen-space input)
+     */
+    void drawDepthTriangle(Framebuffer& fb, vec3 v0, vec3 v1, vec3 v2)
+    {
+        // Same winding test as drawMesh (positive = front-facing on screen)
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        if (area <= 0.0f)
+        {
+            if (backfaceCulling || area == 0.0f)
+                return;
+            std::swap(v1, v2);
+            area = -area;
+        }
+
+        int minX = std::max(0, (int)std::floor(std::min({v0.x, v1.x, v2.x})));
+        int maxX = std::min(fb.width - 1, (int)std::ceil(std::max({v0.x, v1.x, v2.x})));
+        int minY = std::max(0, (int)std::floor(std::min({v0.y, v1.y, v2.y})));
+        int maxY = std::min(fb.height - 1, (int)std::ceil(std::max({v0.y, v1.y, v2.y})));
+        if (minX > maxX || minY > maxY)
+            return;
+
+        // Edge function e(a, b, p) = (b - a) x (p - a), stepped per pixel
+        float invArea = 1.0f / area;
+        auto edge = [](const vec3& a, const vec3& b, float px, float py) {
+            return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+        };
+        float startX = minX + 0.5f, startY = minY + 0.5f;
+        float row0 = edge(v1, v2, startX, startY);
+        float row1 = edge(v2, v0, startX, startY);
+        float row2 = edge(v0, v1, startX, startY);
+        float stepX0 = -(v2.y - v1.y), stepY0 = v2.x - v1.x;
+        float stepX1 = -(v0.y - v2.y), stepY1 = v0.x - v2.x;
+        float stepX2 = -(v1.y - v0.y), stepY2 = v1.x - v0.x;
+
+        for (int y = minY; y <= maxY; y++)
+        {
+            float w0 = row0, w1 = row1, w2 = row2;
+            float* depthRow = fb.depthBuffer.data() + y * fb.width;
+            for (int x = minX; x <= maxX; x++)
+            {
+                if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f)
+                {
+                    float depth = (w0 * v0.z + w1 * v1.z + w2 * v2.z) * invArea;
+                    if (depth < depthRow[x])
+                        depthRow[x] = depth;
+                }
+                w0 += stepX0; w1 += stepX1; w2 += stepX2;
+            }
+            row0 += stepY0; row1 += stepY1; row2 += stepY2;
+        }
+    }
+
     // Bresenham's line algorithm
     // https://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm
     void drawLine(Framebuffer& fb, int x0, int y0, int x1, int y1, const color& col)
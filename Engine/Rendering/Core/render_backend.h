@@ -0,0 +1,80 @@
+#ifndef RENDER_BACKEND_H
+#define RENDER_BACKEND_H
+
+#include "render_command.h"
+#include "shadow_frame.h"
+#include "../camera.h"
+#include "../light.h"
+#include "../color.h"
+#include <vector>
+
+/**
+ * @file render_backend.h
+ * @brief Renderer-agnostic interface shared by the GPU and CPU renderers
+ *
+ * Front-end code (culling, LOD selection, command recording; see SceneView)
+ * produces a sorted DrawCommandQueue plus camera and lights. Any backend
+ * can consume that, so improvements to the front-end apply to both
+ * OpenGLRenderer and SoftwareRenderer.
+ *
+ * Frame sequence:
+ * @code
+ * backend.beginFrame(camera, lights);
+ * backend.submit(commands);
+ * backend.clear(background);
+ * backend.flush();
+ * @endcode
+ */
+
+/**
+ * @class RenderBackend
+ * @brief Executes sorted draw commands for one view
+ */
+class RenderBackend
+{
+public:
+    virtual ~RenderBackend() = default;
+
+    /**
+     * @brief Backend name for logs ("OpenGL", "Software")
+     */
+    virtual const char* getName() const = 0;
+
+    /**
+     * @brief Start a frame with this view (drops commands from the previous frame)
+     */
+    virtual void beginFrame(const Camera& camera, const std::vector<Light>& lights) = 0;
+
+    /**
+     * @brief Add commands for the current frame
+     * Meshes and materials they point to must stay alive until flush().
+     */
+    virtual void submit(const DrawCommandQueue& commands) = 0;
+
+    /**
+     * @brief Draw a command list the caller keeps sorted across frames
+     * Replaces submitted commands for this frame; the list is read in place
+     * (not copied or re-sorted) and must stay alive and unchanged until
+     * flush(). Commands with a null mesh are skipped.
+     */
+    virtual void submitRetained(const std::vector<RenderCommand>& commands) = 0;
+
+    /**
+     * @brief Shadow maps for this frame (see ShadowView)
+     * Call after beginFrame(); the frame must stay alive and unchanged until
+     * flush(). Backends without shadow support ignore it.
+     */
+    virtual void submitShadows(const ShadowFrame& /*shadows*/) {}
+
+    /**
+     * @brief Clear color and depth of the render target
+     */
+    virtual void clear(const color& clearColor) = 0;
+
+    /**
+     * @brief Draw everything submitted since beginFrame()
+     */
+    virtual void flush() = 0;
+};
+
+#endif // RENDER_BACKEND_H
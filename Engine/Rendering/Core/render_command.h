@@ -4,6 +4,10 @@
 #include "../../Math/mat4.h"
 #include "../Primitives/mesh.h"
 #include "../Materials/material.h"
+#include "../Materials/materialPropertyBlock.h"
+#include "../light.h"
+#include "../../Core/Systems/jobSystem.h"
+#include <algorithm>
 #include <vector>
 #include <memory>
 
@@ -23,14 +27,41 @@ struct RenderCommand
 {
     const Mesh* mesh;              // Mesh to draw
     Material* material;            // Material (nullptr = default)
+    const MaterialPropertyBlock* properties;  // Per-renderer overrides (nullptr = none)
     mat4 modelMatrix;              // Model transformation
     uint64_t sortKey;              // For batching and sorting
+    LightSet lights;               // Lights reaching the object (default = all frame lights)
+    bool receiveShadows;           // Darken by the directional shadow map
     
     RenderCommand()
-        : mesh(nullptr), material(nullptr), modelMatrix(mat4::identity()), sortKey(0)
+        : mesh(nullptr), material(nullptr), properties(nullptr), modelMatrix(mat4::identity()), sortKey(0),
+          receiveShadows(true)
     {
     }
     
+    /**
+     * @brief Build a command, sorting by the object's world Z
+     * Property blocks don't affect the sort key, so overridden draws stay
+     * batched with the rest of their material.
+     */
+    static RenderCommand create(const Mesh* mesh, Material* mat, const mat4& model,
+                                const MaterialPropertyBlock* properties = nullptr)
+    {
+        RenderCommand cmd;
+        cmd.mesh = mesh;
+        cmd.material = mat;
+        cmd.properties = properties;
+        cmd.modelMatrix = model;
+        // Translation lives in column 3 (column vectors)
+        cmd.sortKey = generateSortKey(mesh, mat, model.m[2][3]);
+        return cmd;
+    }
+    
+    static bool sortKeyLess(const RenderCommand& a, const RenderCommand& b)
+    {
+        return a.sortKey < b.sortKey;
+    }
+    
     /**
      * @brief Generate sort key for batching
      * Key layout (64 bits):
@@ -74,6 +105,70 @@ private:
     std::vector<RenderCommand> commands;
     bool needsSort;
     
+    // Parallel recording: one buffer per chunk of items, kept between
+    // frames so steady-state recording doesn't allocate
+    std::vector<std::vector<RenderCommand>> chunkBuffers;
+    std::vector<RenderCommand> mergeScratch;
+    std::vector<size_t> runStarts;
+    
+    static constexpr size_t MIN_RECORD_CHUNK = 256;  // Items worth a separate job
+    
+    /**
+     * @brief Concatenate the sorted chunk buffers and merge them into one sorted run
+     */
+    void mergeChunks(size_t chunkCount)
+    {
+        if (chunkCount == 1)
+        {
+            commands.swap(chunkBuffers[0]);
+            return;
+        }
+        
+        runStarts.assign(1, 0);
+        for (size_t c = 0; c < chunkCount; c++)
+            runStarts.push_back(runStarts.back() + chunkBuffers[c].size());
+        commands.resize(runStarts.back());
+        mergeScratch.resize(runStarts.back());
+        
+        JobSystem& jobs = JobSystem::getInstance();
+        jobs.parallelFor(chunkCount, 1, [this](size_t first, size_t last) {
+            for (size_t c = first; c < last; c++)
+                std::copy(chunkBuffers[c].begin(), chunkBuffers[c].end(), commands.begin() + runStarts[c]);
+        });
+        
+        // Merge neighbouring runs pairwise (log2(chunks) rounds, pairs in parallel)
+        std::vector<RenderCommand>* src = &commands;
+        std::vector<RenderCommand>* dst = &mergeScratch;
+        while (runStarts.size() > 2)
+        {
+            size_t runCount = runStarts.size() - 1;
+            size_t pairCount = (runCount + 1) / 2;
+            jobs.parallelFor(pairCount, 1, [&](size_t first, size_t last) {
+                for (size_t p = first; p < last; p++)
+                {
+                    size_t begin = runStarts[p * 2];
+                    size_t middle = runStarts[std::min(p * 2 + 1, runCount)];
+                    size_t end = runStarts[std::min(p * 2 + 2, runCount)];
+                    std::merge(src->begin() + begin, src->begin() + middle,
+                               src->begin() + middle, src->begin() + end,
+                               dst->begin() + begin, RenderCommand::sortKeyLess);
+                }
+            });
+            
+            // Every other boundary disappears
+            size_t kept = 0;
+            for (size_t i = 0; i < runStarts.size(); i += 2)
+                runStarts[kept++] = runStarts[i];
+            if (runStarts[kept - 1] != runStarts.back())
+                runStarts[kept++] = runStarts.back();
+            runStarts.resize(kept);
+            std::swap(src, dst);
+        }
+        
+        if (src != &commands)
+            commands.swap(mergeScratch);
+    }
+    
 public:
     DrawCommandQueue()
         : needsSort(false)
@@ -104,6 +199,58 @@ public:
         needsSort = true;
     }
     
+    /**
+     * @brief Append another queue's commands (keeps it sorted if this one was empty)
+     */
+    void append(const DrawCommandQueue& other)
+    {
+        if (commands.empty())
+        {
+            commands = other.commands;
+            needsSort = other.needsSort;
+            return;
+        }
+        commands.insert(commands.end(), other.commands.begin(), other.commands.end());
+        needsSort = needsSort || !other.commands.empty();
+    }
+    
+    /**
+     * @brief Record commands for many items on the job system, replacing the queue
+     * @param count Number of items (e.g. visible objects)
+     * @param record Callable record(index, std::vector<RenderCommand>& out)
+     *        appending zero or more commands for one item; runs concurrently
+     *        for different items
+     * 
+     * Items are split into contiguous chunks that record into their own
+     * buffers and sort them, so threads never share a container. The sorted
+     * chunks are then merged; the queue ends up sorted.
+     */
+    template<typename Fn>
+    void recordParallel(size_t count, Fn&& record)
+    {
+        JobSystem& jobs = JobSystem::getInstance();
+        size_t chunkCount = std::max<size_t>(1, (count + MIN_RECORD_CHUNK - 1) / MIN_RECORD_CHUNK);
+        chunkCount = std::min(chunkCount, jobs.getThreadCount() * 4);
+        size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+        if (chunkBuffers.size() < chunkCount)
+            chunkBuffers.resize(chunkCount);
+        
+        jobs.parallelFor(chunkCount, 1, [&](size_t first, size_t last) {
+            for (size_t c = first; c < last; c++)
+            {
+                auto& buffer = chunkBuffers[c];
+                buffer.clear();
+                size_t end = std::min(count, (c + 1) * chunkSize);
+                for (size_t i = c * chunkSize; i < end; i++)
+                    record(i, buffer);
+                std::sort(buffer.begin(), buffer.end(), RenderCommand::sortKeyLess);
+            }
+        });
+        
+        mergeChunks(chunkCount);
+        needsSort = false;
+    }
+    
     /**
      * @brief Sort commands by sort key (minimizes state changes)
      */
@@ -111,11 +258,7 @@ public:
     {
         if (needsSort)
         {
-            std::sort(commands.begin(), commands.end(),
-                [](const RenderCommand& a, const RenderCommand& b)
-                {
-                    return a.sortKey < b.sortKey;
-                });
+            std::sort(commands.begin(), commands.end(), RenderCommand::sortKeyLess);
             needsSort = false;
         }
     }
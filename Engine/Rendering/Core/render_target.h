@@ -0,0 +1,158 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include "gl_dispatch.h"
+
+#include <iostream>
+
+/**
+ * @file render_target.h
+ * @brief Offscreen framebuffer to render the GL path into
+ *
+ * An RGBA8 color texture and a 24-bit depth texture behind one FBO. Bind
+ * it before OpenGLRenderer::clear/flush and everything draws there
+ * instead of the window, so a hidden or headless context (whose default
+ * framebuffer may have no pixels at all) still produces an image. Read it
+ * back with FrameCapture, or sample getColorTexture() in a later pass.
+ *
+ * @code
+ * RenderTarget target;
+ * target.create(1920, 1080);
+ * target.bind();
+ * renderer.clear(0.1f, 0.1f, 0.15f);
+ * renderer.flush();
+ * capture.capture(target.getFramebuffer(), target.getWidth(), target.getHeight());
+ * target.unbind();
+ * @endcode
+ */
+class RenderTarget
+{
+private:
+    GLuint framebuffer;
+    GLuint colorTexture;
+    GLuint depthTexture;
+    int width;
+    int height;
+
+    // State bind() replaced, put back by unbind()
+    bool bound;
+    GLint previousFramebuffer;
+    GLint previousViewport[4];
+
+    static GLuint createTexture(GLint internalFormat, int w, int h, GLenum format, GLenum type)
+    {
+        GLuint texture = 0;
+        GL::GenTextures(1, &texture);
+        GL::BindTexture(GL_TEXTURE_2D, texture);
+        GL::TexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, nullptr);
+        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        GL::BindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+public:
+    RenderTarget()
+        : framebuffer(0), colorTexture(0), depthTexture(0), width(0), height(0),
+          bound(false), previousFramebuffer(0), previousViewport{0, 0, 0, 0}
+    {
+    }
+
+    ~RenderTarget()
+    {
+        destroy();
+    }
+
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    /**
+     * @brief Create (or recreate at a new size) the framebuffer (needs a GL context)
+     * @return false if the driver reports the framebuffer incomplete
+     */
+    bool create(int w, int h)
+    {
+        if (w <= 0 || h <= 0)
+            return false;
+        if (framebuffer != 0 && w == width && h == height)
+            return true;
+        destroy();
+
+        width = w;
+        height = h;
+        colorTexture = createTexture(GL_RGBA8, width, height, GL_RGBA, GL_UNSIGNED_BYTE);
+        depthTexture = createTexture(GL_DEPTH_COMPONENT24, width, height, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
+
+        GLint previous = 0;
+        GL::GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+        GL::GenFramebuffers(1, &framebuffer);
+        GL::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        GL::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+        GL::FramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+        GLenum status = GL::CheckFramebufferStatus(GL_FRAMEBUFFER);
+        GL::BindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previous));
+
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cerr << "Render target " << width << "x" << height << " incomplete (0x"
+                      << std::hex << status << std::dec << ")" << std::endl;
+            destroy();
+            return false;
+        }
+        return true;
+    }
+
+    void destroy()
+    {
+        if (framebuffer != 0)
+            GL::DeleteFramebuffers(1, &framebuffer);
+        if (colorTexture != 0)
+            GL::DeleteTextures(1, &colorTexture);
+        if (depthTexture != 0)
+            GL::DeleteTextures(1, &depthTexture);
+        framebuffer = colorTexture = depthTexture = 0;
+        width = height = 0;
+        bound = false;
+    }
+
+    /**
+     * @brief Draw into this target (sets the viewport to its size)
+     * Remembers the framebuffer and viewport it replaces for unbind().
+     */
+    void bind()
+    {
+        if (framebuffer == 0)
+            return;
+        if (!bound)
+        {
+            GL::GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+            GL::GetIntegerv(GL_VIEWPORT, previousViewport);
+            bound = true;
+        }
+        GL::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        GL::Viewport(0, 0, width, height);
+    }
+
+    /**
+     * @brief Go back to the framebuffer and viewport bind() replaced
+     */
+    void unbind()
+    {
+        if (!bound)
+            return;
+        GL::BindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+        GL::Viewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+        bound = false;
+    }
+
+    bool isValid() const { return framebuffer != 0; }
+    GLuint getFramebuffer() const { return framebuffer; }
+    GLuint getColorTexture() const { return colorTexture; }
+    GLuint getDepthTexture() const { return depthTexture; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+};
+
+#endif // RENDER_TARGET_H
@@ -0,0 +1,605 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include "opengl_window.h"
+#include "opengl_renderer.h"
+#include "render_command.h"
+#include "render_target.h"
+#include "frame_capture.h"
+#include "shadow_frame.h"
+#include "../camera.h"
+#include "../light.h"
+#include "../color.h"
+#include "../Primitives/mesh.h"
+#include "../Materials/material.h"
+#include "../../Math/mat4.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct FramePacket
+ * @brief Everything the render thread needs to draw one frame
+ *
+ * Built by the main thread, then only read by the render thread. Meshes
+ * and materials are held by shared_ptr so they outlive the frame even if
+ * the scene drops them meanwhile; materials should be snapshots (see
+ * RenderThread::snapshotMaterial) so scripts can keep editing the originals.
+ * Draw commands are recorded (and sorted) while the packet is built, so
+ * the render thread only copies them into the renderer. Shadow casters
+ * come as a ShadowFrame, whose meshes list keeps their meshes alive.
+ */
+struct FramePacket
+{
+    struct DrawItem
+    {
+        std::shared_ptr<const Mesh> mesh;
+        std::shared_ptr<Material> material;  // nullptr = default shader
+        mat4 modelMatrix;
+        std::shared_ptr<const MaterialPropertyBlock> properties;  // Immutable, so safe to share
+        LightSet lights;                     // Indices into the packet's lights
+        bool receiveShadows = true;
+    };
+
+    uint64_t frameNumber;
+    bool hasCamera;            // false: clear and present only
+    Camera camera;
+    std::vector<Light> lights;
+    color clearColor;
+    int viewportWidth;
+    int viewportHeight;
+    std::vector<DrawItem> draws;  // Owns what the commands point to
+    DrawCommandQueue commands;
+    ShadowFrame shadows;          // Empty = no shadows
+
+    FramePacket()
+        : frameNumber(0), hasCamera(false), clearColor(0.1f, 0.1f, 0.15f),
+          viewportWidth(0), viewportHeight(0)
+    {
+    }
+
+    void addDraw(std::shared_ptr<const Mesh> mesh, std::shared_ptr<Material> material, const mat4& modelMatrix,
+                 std::shared_ptr<const MaterialPropertyBlock> properties = nullptr)
+    {
+        if (!mesh)
+            return;
+        commands.submit(RenderCommand::create(mesh.get(), material.get(), modelMatrix, properties.get()));
+        draws.push_back({ std::move(mesh), std::move(material), modelMatrix, std::move(properties), LightSet(), true });
+    }
+
+    /**
+     * @brief Record many draws in parallel, replacing the packet's draws
+     * @param count Number of items
+     * @param makeDraw Callable makeDraw(index, DrawItem& out); leave out.mesh
+     *        null to skip an item. Runs concurrently for different items.
+     */
+    template<typename Fn>
+    void recordDraws(size_t count, Fn&& makeDraw)
+    {
+        draws.clear();
+        draws.resize(count);
+        commands.recordParallel(count, [&](size_t index, std::vector<RenderCommand>& out) {
+            DrawItem& item = draws[index];
+            makeDraw(index, item);
+            if (item.mesh)
+            {
+                out.push_back(RenderCommand::create(item.mesh.get(), item.material.get(), item.modelMatrix,
+                                                    item.properties.get()));
+                out.back().lights = item.lights;
+                out.back().receiveShadows = item.receiveShadows;
+            }
+        });
+    }
+
+    /**
+     * @brief Drop last frame's contents (keeps capacity)
+     */
+    void reset()
+    {
+        hasCamera = false;
+        lights.clear();
+        draws.clear();
+        commands.clear();
+        shadows.cascadeCount = 0;
+        shadows.meshes.clear();
+    }
+};
+
+/**
+ * @class RenderThread
+ * @brief Owns the GL context on a dedicated thread and draws FramePackets
+ *
+ * Packets rotate through a small pool: while the render thread issues the
+ * draw calls and swaps buffers for frame N, the main thread simulates and
+ * builds frame N+1. The only hand-off wait is the upload step: submitPacket()
+ * returns once the render thread has uploaded the packet's new or changed
+ * meshes, because those read CPU mesh data the next update may modify.
+ *
+ * GL resources (textures, shaders) must be created on the render thread
+ * while it runs; queue that work with enqueue()/invoke().
+ *
+ * Without start() (or if it fails) the same interface renders inline on
+ * the calling thread, which keeps the context.
+ *
+ * Example:
+ * @code
+ * RenderThread renderThread(window, renderer);
+ * renderThread.start();
+ * while (running) {
+ *     scene.update(dt);
+ *     FramePacket& packet = renderThread.beginPacket();
+ *     ... fill packet ...
+ *     renderThread.submitPacket();
+ * }
+ * renderThread.stop();
+ * @endcode
+ */
+class RenderThread
+{
+public:
+    /**
+     * @param window Window whose context the thread takes over
+     * @param renderer Initialized renderer (used only by the render thread once started)
+     * @param packetCount Packets in rotation (2 = double buffering, 3 = triple)
+     */
+    RenderThread(OpenGLWindow& targetWindow, OpenGLRenderer& targetRenderer, size_t packetCount = 2)
+        : window(targetWindow), renderer(targetRenderer), packets(std::max<size_t>(packetCount, 2)),
+          building(nullptr), running(false), stopping(false),
+          nextFrameNumber(1), syncedFrame(0), commandsQueued(0), commandsExecuted(0),
+          viewportWidth(0), viewportHeight(0), renderTarget(nullptr), frameCapture(nullptr)
+    {
+        for (auto& packet : packets)
+            freePackets.push_back(&packet);
+    }
+
+    ~RenderThread()
+    {
+        stop();
+    }
+
+    // Non-copyable
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    /**
+     * @brief Hand the GL context to a new render thread
+     * Call from the thread that currently owns the context, after setup
+     * code that creates GL resources has run.
+     * @return false if the context could not be moved (rendering stays inline)
+     */
+    bool start()
+    {
+        if (running)
+            return true;
+
+        window.releaseContext();
+        bool acquired = false;
+        bool answered = false;
+        stopping = false;
+        thread = std::thread([this, &acquired, &answered]() {
+            bool ok = window.makeCurrent();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                acquired = ok;
+                answered = true;
+            }
+            signal.notify_all();
+            if (ok)
+            {
+                renderLoop();
+                window.releaseContext();
+            }
+        });
+
+        std::unique_lock<std::mutex> lock(mutex);
+        signal.wait(lock, [&]() { return answered; });
+        if (!acquired)
+        {
+            lock.unlock();
+            thread.join();
+            window.makeCurrent();
+            std::cerr << "Render thread could not take the GL context; rendering inline" << std::endl;
+            return false;
+        }
+
+        running = true;
+        setActive(this);
+        return true;
+    }
+
+    /**
+     * @brief Finish queued frames and commands, join the thread and give
+     * the GL context back to the caller
+     */
+    void stop()
+    {
+        if (!running)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        signal.notify_all();
+        thread.join();
+
+        running = false;
+        if (getActive() == this)
+            setActive(nullptr);
+        window.makeCurrent();
+
+        // Anything queued after the loop drained runs here, now that we own the context
+        runCommands();
+    }
+
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief Draw frames into an offscreen target instead of the window
+     * @param target Created target (nullptr = window again); set while not running
+     */
+    void setRenderTarget(RenderTarget* target) { renderTarget = target; }
+
+    /**
+     * @brief Read every drawn frame back (after flush, before the swap)
+     * @param capture Initialized capture, polled once per frame; its callback
+     *        runs on the render thread while it runs. Set while not running.
+     */
+    void setFrameCapture(FrameCapture* capture) { frameCapture = capture; }
+
+    /**
+     * @brief Get a free packet to fill for the next frame
+     * Blocks while every packet is queued or being drawn.
+     */
+    FramePacket& beginPacket()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            signal.wait(lock, [this]() { return !freePackets.empty(); });
+            building = freePackets.front();
+            freePackets.pop_front();
+        }
+
+        building->reset();
+        building->frameNumber = nextFrameNumber++;
+        pruneMaterialSnapshots();
+        releaseRetiredSnapshots();
+        return *building;
+    }
+
+    /**
+     * @brief Hand the packet from beginPacket() to the render thread
+     * Returns once its meshes are uploaded, after which the caller may
+     * modify scene meshes again. Renders inline when not running.
+     */
+    void submitPacket()
+    {
+        FramePacket* packet = building;
+        building = nullptr;
+        if (!packet)
+            return;
+
+        for (auto& entry : newSnapshots)
+        {
+            MaterialSnapshot& cached = materialSnapshots[entry.first];
+            if (cached.snapshot)
+                retiredSnapshots.push_back(std::move(cached.snapshot));
+            cached = std::move(entry.second);
+        }
+        newSnapshots.clear();
+        releaseRetiredSnapshots();
+
+        if (!running)
+        {
+            runCommands();
+            uploadPacket(*packet);
+            drawPacket(*packet);
+            releasePacket(*packet);
+            return;
+        }
+
+        uint64_t frame = packet->frameNumber;
+        std::unique_lock<std::mutex> lock(mutex);
+        pendingPackets.push_back(packet);
+        signal.notify_all();
+        signal.wait(lock, [this, frame]() { return syncedFrame >= frame; });
+    }
+
+    /**
+     * @brief Run a function on the render thread before its next frame
+     * Runs immediately when the render thread isn't running.
+     */
+    void enqueue(std::function<void()> command)
+    {
+        if (!running)
+        {
+            command();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            commands.push_back(std::move(command));
+            commandsQueued++;
+        }
+        signal.notify_all();
+    }
+
+    /**
+     * @brief Run a function on the render thread and wait for it
+     * Use for resource creation whose result is needed right away.
+     */
+    void invoke(std::function<void()> command)
+    {
+        if (!running)
+        {
+            command();
+            return;
+        }
+
+        uint64_t ticket;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            commands.push_back(std::move(command));
+            ticket = ++commandsQueued;
+        }
+        signal.notify_all();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        signal.wait(lock, [this, ticket]() { return commandsExecuted >= ticket; });
+    }
+
+    /**
+     * @brief Immutable copy of a material for a packet
+     * A new copy is taken only when the material's version changed, so
+     * unchanged materials cost one lookup. Returns the material itself when
+     * rendering inline.
+     *
+     * Safe to call from recording jobs between beginPacket() and
+     * submitPacket(), as long as nothing edits materials meanwhile.
+     */
+    std::shared_ptr<Material> snapshotMaterial(const std::shared_ptr<Material>& material)
+    {
+        if (!material || !running)
+            return material;
+
+        // Known and unchanged: read-only lookup, no lock
+        auto it = materialSnapshots.find(material.get());
+        if (it != materialSnapshots.end() && isCurrent(it->second, material))
+            return it->second.snapshot;
+
+        // New or edited: copy under the lock; folded into the cache in submitPacket
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        auto& entry = newSnapshots[material.get()];
+        if (!isCurrent(entry, material))
+        {
+            if (entry.snapshot)
+                retiredSnapshots.push_back(std::move(entry.snapshot));
+            entry.source = material;
+            entry.version = material->getVersion();
+            entry.snapshot = material->clone();
+        }
+        return entry.snapshot;
+    }
+
+    /**
+     * @brief Render thread currently running, if any (for queuing GL work from scripts)
+     */
+    static RenderThread* getActive()
+    {
+        return activeInstance().load();
+    }
+
+private:
+    struct MaterialSnapshot
+    {
+        std::weak_ptr<Material> source;
+        uint64_t version = 0;
+        std::shared_ptr<Material> snapshot;
+    };
+
+    OpenGLWindow& window;
+    OpenGLRenderer& renderer;
+    std::vector<FramePacket> packets;
+    std::deque<FramePacket*> freePackets;
+    std::deque<FramePacket*> pendingPackets;
+    FramePacket* building;  // Packet being filled by the main thread
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable signal;
+    bool running;
+    bool stopping;
+
+    uint64_t nextFrameNumber;
+    uint64_t syncedFrame;  // Last frame whose meshes are uploaded
+
+    std::deque<std::function<void()>> commands;
+    uint64_t commandsQueued;
+    uint64_t commandsExecuted;
+
+    std::unordered_map<const Material*, MaterialSnapshot> materialSnapshots;  // Written by the main thread only
+    std::unordered_map<const Material*, MaterialSnapshot> newSnapshots;       // Taken while recording a packet
+    std::vector<std::shared_ptr<Material>> retiredSnapshots;                  // Dropped from the cache, not yet released
+    std::mutex snapshotMutex;
+
+    static bool isCurrent(const MaterialSnapshot& entry, const std::shared_ptr<Material>& material)
+    {
+        return entry.snapshot && entry.version == material->getVersion() && entry.source.lock() == material;
+    }
+
+    int viewportWidth;   // Viewport last set on the render thread
+    int viewportHeight;
+
+    RenderTarget* renderTarget;  // Offscreen destination (nullptr = window)
+    FrameCapture* frameCapture;
+
+    static std::atomic<RenderThread*>& activeInstance()
+    {
+        static std::atomic<RenderThread*> instance(nullptr);
+        return instance;
+    }
+
+    static void setActive(RenderThread* instance)
+    {
+        activeInstance().store(instance);
+    }
+
+    void renderLoop()
+    {
+        while (true)
+        {
+            FramePacket* packet = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                signal.wait(lock, [this]() { return stopping || !pendingPackets.empty() || !commands.empty(); });
+                if (!pendingPackets.empty())
+                {
+                    packet = pendingPackets.front();
+                    pendingPackets.pop_front();
+                }
+                else if (commands.empty())
+                {
+                    return;  // Stopping with nothing left to do
+                }
+            }
+
+            runCommands();
+            if (!packet)
+                continue;
+
+            uploadPacket(*packet);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                syncedFrame = packet->frameNumber;
+            }
+            signal.notify_all();
+
+            drawPacket(*packet);
+            releasePacket(*packet);
+        }
+    }
+
+    /**
+     * @brief Execute queued resource commands (on the context thread)
+     */
+    void runCommands()
+    {
+        std::deque<std::function<void()>> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch.swap(commands);
+        }
+        for (auto& command : batch)
+            command();
+        if (!batch.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                commandsExecuted += batch.size();
+            }
+            signal.notify_all();
+        }
+    }
+
+    /**
+     * @brief Queue the packet's draws and upload mesh data (the only step
+     * that reads scene-owned meshes)
+     */
+    void uploadPacket(const FramePacket& packet)
+    {
+        if (!packet.hasCamera)
+            return;
+        renderer.beginFrame(packet.camera, packet.lights);
+        renderer.submit(packet.commands);
+        renderer.submitShadows(packet.shadows);
+        renderer.prepareMeshes();
+    }
+
+    void drawPacket(const FramePacket& packet)
+    {
+        if (packet.viewportWidth > 0 && packet.viewportHeight > 0 &&
+            (packet.viewportWidth != viewportWidth || packet.viewportHeight != viewportHeight))
+        {
+            viewportWidth = packet.viewportWidth;
+            viewportHeight = packet.viewportHeight;
+            GL::Viewport(0, 0, viewportWidth, viewportHeight);
+        }
+
+        if (renderTarget)
+            renderTarget->bind();
+        renderer.clear(packet.clearColor.x, packet.clearColor.y, packet.clearColor.z);
+        if (packet.hasCamera)
+            renderer.flush();
+
+        if (frameCapture)
+        {
+            if (renderTarget)
+                frameCapture->capture(renderTarget->getFramebuffer(), renderTarget->getWidth(), renderTarget->getHeight());
+            else
+                frameCapture->capture(0, viewportWidth, viewportHeight);
+            frameCapture->poll();
+        }
+        if (renderTarget)
+            renderTarget->unbind();
+        // Not swapBuffers(): its isOpen check belongs to the main thread's event loop
+        SDL_GL_SwapWindow(window.window);
+    }
+
+    /**
+     * @brief Return a drawn packet to the pool (drops its mesh/material references)
+     */
+    void releasePacket(FramePacket& packet)
+    {
+        packet.reset();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freePackets.push_back(&packet);
+        }
+        signal.notify_all();
+    }
+
+    /**
+     * @brief Forget snapshots of materials that no longer exist
+     */
+    void pruneMaterialSnapshots()
+    {
+        for (auto it = materialSnapshots.begin(); it != materialSnapshots.end();)
+        {
+            if (it->second.source.expired())
+            {
+                retiredSnapshots.push_back(std::move(it->second.snapshot));
+                it = materialSnapshots.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    /**
+     * @brief Let go of retired snapshots on the context thread
+     * A snapshot may hold the last reference to a cloned shader or texture,
+     * whose destructor deletes GL objects, so the main thread must not be
+     * the one to drop it while the render thread owns the context.
+     */
+    void releaseRetiredSnapshots()
+    {
+        if (retiredSnapshots.empty())
+            return;
+        auto released = std::make_shared<std::vector<std::shared_ptr<Material>>>(std::move(retiredSnapshots));
+        retiredSnapshots.clear();
+        enqueue([released]() { released->clear(); });
+    }
+};
+
+#endif // RENDER_THREAD_H
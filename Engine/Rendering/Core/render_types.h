@@ -8,7 +8,10 @@
 #include <GL/glew.h>
 #endif
 
+#include "../../Math/simd.h"
 #include <cstdint>
+#include <cmath>
+#include <algorithm>
 
 /**
  * @file render_types.h
@@ -40,6 +43,45 @@ inline GLenum toGLUsage(BufferUsage usage)
     }
 }
 
+/**
+ * @enum PositionStreamFormat
+ * @brief Layout of the optional position-only vertex stream
+ * 
+ * Depth-only passes (pre-pass, shadows, picking) only need positions.
+ * A separate tightly packed stream lets them fetch 12 or 8 bytes per
+ * vertex instead of the full 32-byte PackedVertex.
+ */
+enum class PositionStreamFormat
+{
+    None,       // No extra stream - depth-only draws read the full vertex
+    Float3,     // 3x float (12 bytes), exact positions
+    Snorm16     // 3x int16 + pad (8 bytes), quantized to the mesh bounds
+};
+
+/**
+ * @enum DepthPrepassMode
+ * @brief When OpenGLRenderer lays down opaque depth before shading
+ */
+enum class DepthPrepassMode
+{
+    Off,
+    On,
+    Auto        // On while the estimated overdraw is high
+};
+
+/**
+ * @brief Bytes per vertex in a position-only stream
+ */
+inline size_t positionStreamStride(PositionStreamFormat format)
+{
+    switch (format)
+    {
+        case PositionStreamFormat::Float3: return sizeof(float) * 3;
+        case PositionStreamFormat::Snorm16: return sizeof(int16_t) * 4;
+        default: return 0;
+    }
+}
+
 /**
  * @struct PackedVertex
  * @brief Optimized vertex format (32 bytes per vertex)
@@ -49,7 +91,7 @@ inline GLenum toGLUsage(BufferUsage usage)
  * - Normal: 2x 16-bit packed (4 bytes) 
  * - UV: 2x 16-bit half float (4 bytes)
  * - Color: 4x 8-bit RGBA (4 bytes)
- * - Padding: 8 bytes for alignment
+ * - Tangent: 2x 16-bit octahedral + 16-bit handedness sign + 16 unused bits (8 bytes)
  * 
  * Previous format: 44 bytes per vertex (11 floats)
  * New format: 32 bytes per vertex (27% smaller)
@@ -60,9 +102,11 @@ struct PackedVertex
     int16_t normal[2];      // 4 bytes - octahedron encoding (x, y)
     uint16_t uv[2];         // 4 bytes - half float texture coordinates
     uint8_t color[4];       // 4 bytes - RGBA (0-255)
-    float padding[2];       // 8 bytes - future use (tangent, etc.)
+    int16_t tangent[4];     // 8 bytes - octahedral tangent (x, y), bitangent sign, unused
 };
 
+static_assert(sizeof(PackedVertex) == 32, "PackedVertex must stay 32 bytes");
+
 /**
  * @brief Encode normal to octahedron (2D projection of 3D normal)
  * @param nx, ny, nz Normal components [-1, 1]
@@ -71,21 +115,36 @@ struct PackedVertex
 inline void packNormal(float nx, float ny, float nz, int16_t out[2])
 {
     // Octahedron normal encoding
-    float invL1 = 1.0f / (std::abs(nx) + std::abs(ny) + std::abs(nz));
-    float px = nx * invL1;
-    float py = ny * invL1;
+    float l1 = std::max(std::abs(nx) + std::abs(ny) + std::abs(nz), 1e-20f);
+    float px = nx / l1;
+    float py = ny / l1;
     
     if (nz < 0.0f)
     {
+        // Fold lower hemisphere (both axes use the unfolded values)
         float signX = px >= 0.0f ? 1.0f : -1.0f;
         float signY = py >= 0.0f ? 1.0f : -1.0f;
+        float oldPx = px;
         px = (1.0f - std::abs(py)) * signX;
-        py = (1.0f - std::abs(px)) * signY;
+        py = (1.0f - std::abs(oldPx)) * signY;
     }
     
     // Scale to int16 range
-    out[0] = static_cast<int16_t>(px * 32767.0f);
-    out[1] = static_cast<int16_t>(py * 32767.0f);
+    out[0] = static_cast<int16_t>(std::nearbyint(px * 32767.0f));
+    out[1] = static_cast<int16_t>(std::nearbyint(py * 32767.0f));
+}
+
+/**
+ * @brief Encode tangent frame (octahedral direction + bitangent sign)
+ * @param tx, ty, tz Tangent components [-1, 1]
+ * @param sign Bitangent handedness (+1 or -1)
+ * @param out Output array [4]; out[3] is unused and zeroed
+ */
+inline void packTangent(float tx, float ty, float tz, float sign, int16_t out[4])
+{
+    packNormal(tx, ty, tz, out);
+    out[2] = sign < 0.0f ? -32767 : 32767;
+    out[3] = 0;
 }
 
 /**
@@ -125,28 +184,11 @@ inline void unpackNormal(const int16_t packed[2], float& nx, float& ny, float& n
 
 /**
  * @brief Convert float to half-float (16-bit)
- * Simplified version without proper rounding for performance
+ * Rounds to nearest even; see floatToHalfRounded in simd.h
  */
 inline uint16_t floatToHalf(float f)
 {
-    // Quick and dirty float to half conversion
-    uint32_t bits = *reinterpret_cast<uint32_t*>(&f);
-    uint16_t sign = (bits >> 16) & 0x8000;
-    int32_t exponent = ((bits >> 23) & 0xFF) - 127 + 15;
-    uint32_t mantissa = bits & 0x007FFFFF;
-    
-    if (exponent <= 0)
-    {
-        // Underflow
-        return sign;
-    }
-    else if (exponent >= 31)
-    {
-        // Overflow
-        return sign | 0x7C00;
-    }
-    
-    return sign | (exponent << 10) | (mantissa >> 13);
+    return floatToHalfRounded(f);
 }
 
 /**
@@ -0,0 +1,62 @@
+#ifndef SHADOW_FRAME_H
+#define SHADOW_FRAME_H
+
+#include "render_command.h"
+#include "../../Math/mat4.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @file shadow_frame.h
+ * @brief Per-frame cascaded shadow map description handed to a backend
+ *
+ * Produced by ShadowView on the main thread and consumed by a backend's
+ * submitShadows(). Casters are split per cascade: static ones are only
+ * listed when the cascade's cached depth must be redrawn (staticDirty),
+ * dynamic ones every frame and drawn on top of the cached depth.
+ */
+
+/**
+ * @struct ShadowCascade
+ * @brief One slice of the view frustum and the casters that reach it
+ */
+struct ShadowCascade
+{
+    mat4 viewProjection;                        // World -> light clip space
+    float splitDistance;                        // Far end of the slice (view depth)
+    float texelWorldSize;                       // World units per shadow texel
+    bool staticDirty;                           // Cached static depth must be redrawn
+    std::vector<RenderCommand> staticCasters;   // Only filled when staticDirty
+    std::vector<RenderCommand> dynamicCasters;
+
+    ShadowCascade()
+        : viewProjection(mat4::identity()), splitDistance(0.0f), texelWorldSize(0.0f), staticDirty(true)
+    {
+    }
+};
+
+/**
+ * @struct ShadowFrame
+ * @brief Shadow maps of the frame's main directional light
+ */
+struct ShadowFrame
+{
+    static constexpr int MAX_CASCADES = 4;
+
+    int cascadeCount;           // 0 = no shadows this frame
+    int resolution;             // Texels per side of each cascade
+    vec3 lightDirection;        // Direction the light travels
+    ShadowCascade cascades[MAX_CASCADES];
+
+    // Keeps caster meshes alive until a render thread has drawn them
+    std::vector<std::shared_ptr<const Mesh>> meshes;
+
+    ShadowFrame()
+        : cascadeCount(0), resolution(0), lightDirection(0, -1, 0)
+    {
+    }
+
+    bool empty() const { return cascadeCount == 0; }
+};
+
+#endif // SHADOW_FRAME_H
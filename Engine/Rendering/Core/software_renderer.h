@@ -0,0 +1,105 @@
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+#include "render_backend.h"
+#include "rasterizer.h"
+#include "framebuffer.h"
+#include "../Materials/material.h"
+
+/**
+ * @class SoftwareRenderer
+ * @brief RenderBackend that draws commands with the CPU Rasterizer
+ *
+ * Runs on machines without a GPU. Shading is the rasterizer's
+ * Blinn-Phong on vertex colors; of the material only _Color is used (as a
+ * tint, overridable per renderer with a MaterialPropertyBlock), shaders
+ * and textures are ignored. Each object is shaded with its command's
+ * LightSet only.
+ *
+ * Example:
+ * @code
+ * Framebuffer framebuffer(800, 600);
+ * Rasterizer rasterizer;
+ * SoftwareRenderer renderer(framebuffer, rasterizer);
+ * SceneView view;
+ * view.render(scene, renderer, scene.backgroundColor);
+ * framebuffer.saveToPPM("frame.ppm");
+ * @endcode
+ */
+class SoftwareRenderer : public RenderBackend
+{
+private:
+    Framebuffer& framebuffer;
+    Rasterizer& rasterizer;
+
+    Camera camera;
+    std::vector<Light> lights;
+    std::vector<Light> objectLights;  // Scratch: one command's LightSet
+    DrawCommandQueue renderQueue;
+    const std::vector<RenderCommand>* retainedCommands;  // Drawn instead of the queue
+
+public:
+    SoftwareRenderer(Framebuffer& target, Rasterizer& targetRasterizer)
+        : framebuffer(target), rasterizer(targetRasterizer), retainedCommands(nullptr)
+    {
+    }
+
+    const char* getName() const override { return "Software"; }
+
+    void beginFrame(const Camera& frameCamera, const std::vector<Light>& frameLights) override
+    {
+        camera = frameCamera;
+        lights = frameLights;
+        renderQueue.clear();
+        retainedCommands = nullptr;
+    }
+
+    void submit(const DrawCommandQueue& commands) override
+    {
+        renderQueue.append(commands);
+    }
+
+    void submitRetained(const std::vector<RenderCommand>& commands) override
+    {
+        retainedCommands = &commands;
+    }
+
+    void clear(const color& clearColor) override
+    {
+        framebuffer.clear(clearColor);
+    }
+
+    /**
+     * @brief The frame lights a command's LightSet selects
+     */
+    const std::vector<Light>& lightsFor(const RenderCommand& cmd)
+    {
+        if (cmd.lights.isAll())
+            return lights;
+        objectLights.clear();
+        for (int i = 0; i < cmd.lights.count; i++)
+        {
+            if (cmd.lights.indices[i] < lights.size())
+                objectLights.push_back(lights[cmd.lights.indices[i]]);
+        }
+        return objectLights;
+    }
+
+    void flush() override
+    {
+        const auto& commands = retainedCommands ? *retainedCommands : renderQueue.getCommands();
+        for (const auto& cmd : commands)
+        {
+            if (!cmd.mesh)
+                continue;
+            color tint = cmd.material ? cmd.material->getColor("_Color") : color(1, 1, 1);
+            if (cmd.properties)
+                tint = cmd.properties->getColor("_Color", tint);
+            rasterizer.drawMesh(framebuffer, *cmd.mesh, cmd.modelMatrix, camera, lightsFor(cmd), tint);
+        }
+    }
+
+    Framebuffer& getFramebuffer() { return framebuffer; }
+};
+
+#endif // SOFTWARE_RENDERER_H
@@ -1,12 +1,7 @@
 #ifndef UNIFORM_BUFFER_H
 #define UNIFORM_BUFFER_H
 
-#ifdef __APPLE__
-#define GL_SILENCE_DEPRECATION
-#include <OpenGL/gl3.h>
-#else
-#include <GL/glew.h>
-#endif
+#include "gl_dispatch.h"
 
 #include "../../Math/mat4.h"
 #include "../../Math/vec3.h"
@@ -92,18 +87,18 @@ public:
     UniformBuffer(GLuint binding)
         : ubo(0), bindingPoint(binding), dirty(true)
     {
-        glGenBuffers(1, &ubo);
-        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-        glBufferData(GL_UNIFORM_BUFFER, T::SIZE, nullptr, GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, ubo);
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        GL::GenBuffers(1, &ubo);
+        GL::BindBuffer(GL_UNIFORM_BUFFER, ubo);
+        GL::BufferData(GL_UNIFORM_BUFFER, T::SIZE, nullptr, GL_DYNAMIC_DRAW);
+        GL::BindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, ubo);
+        GL::BindBuffer(GL_UNIFORM_BUFFER, 0);
     }
     
     ~UniformBuffer()
     {
         if (ubo != 0)
         {
-            glDeleteBuffers(1, &ubo);
+            GL::DeleteBuffers(1, &ubo);
         }
     }
     
@@ -127,9 +122,9 @@ public:
     {
         if (dirty)
         {
-            glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-            glBufferSubData(GL_UNIFORM_BUFFER, 0, T::SIZE, &data);
-            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            GL::BindBuffer(GL_UNIFORM_BUFFER, ubo);
+            GL::BufferSubData(GL_UNIFORM_BUFFER, 0, T::SIZE, &data);
+            GL::BindBuffer(GL_UNIFORM_BUFFER, 0);
             dirty = false;
         }
     }
@@ -139,9 +134,9 @@ public:
      */
     void forceUpload()
     {
-        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, T::SIZE, &data);
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        GL::BindBuffer(GL_UNIFORM_BUFFER, ubo);
+        GL::BufferSubData(GL_UNIFORM_BUFFER, 0, T::SIZE, &data);
+        GL::BindBuffer(GL_UNIFORM_BUFFER, 0);
         dirty = false;
     }
     
@@ -150,7 +145,7 @@ public:
      */
     void bind() const
     {
-        glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, ubo);
+        GL::BindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, ubo);
     }
     
     GLuint getID() const { return ubo; }
@@ -0,0 +1,215 @@
+#ifndef VERTEX_PACKING_H
+#define VERTEX_PACKING_H
+
+#include "render_types.h"
+#include "../Primitives/mesh.h"
+#include "../../Math/simd.h"
+#include "../../Core/Systems/jobSystem.h"
+#include <cstring>
+
+/**
+ * @file vertex_packing.h
+ * @brief SIMD Vertex -> PackedVertex conversion
+ *
+ * Packs four vertices per iteration (octahedral normals and tangents,
+ * half-float UVs, 8-bit colors) and splits large meshes across the JobSystem. Output is
+ * written strictly in order, so the destination may be a mapped GPU
+ * buffer (write-combined memory).
+ */
+namespace VertexPacking
+{
+    constexpr size_t PARALLEL_THRESHOLD = 65536;  // Vertices before going multithreaded
+    constexpr size_t MIN_BATCH = 16384;           // Vertices per job
+
+    /**
+     * @brief Pack a single vertex (scalar path, used for tails)
+     */
+    inline void packOne(const Vertex& v, PackedVertex& out)
+    {
+        PackedVertex pv;
+        pv.position[0] = v.position.x;
+        pv.position[1] = v.position.y;
+        pv.position[2] = v.position.z;
+        packNormal(v.normal.x, v.normal.y, v.normal.z, pv.normal);
+        pv.uv[0] = floatToHalf(v.uv.x);
+        pv.uv[1] = floatToHalf(v.uv.y);
+        pv.color[0] = static_cast<uint8_t>(std::nearbyint(std::clamp(v.vertexColor.x, 0.0f, 1.0f) * 255.0f));
+        pv.color[1] = static_cast<uint8_t>(std::nearbyint(std::clamp(v.vertexColor.y, 0.0f, 1.0f) * 255.0f));
+        pv.color[2] = static_cast<uint8_t>(std::nearbyint(std::clamp(v.vertexColor.z, 0.0f, 1.0f) * 255.0f));
+        pv.color[3] = 255;
+        packTangent(v.tangent.x, v.tangent.y, v.tangent.z, v.tangentSign, pv.tangent);
+        std::memcpy(&out, &pv, sizeof(PackedVertex));
+    }
+
+    /**
+     * @brief Octahedral-encode four unit vectors to snorm16 (matches packNormal)
+     */
+    inline void encodeOctahedral4(float4 x, float4 y, float4 z, int32_t outX[4], int32_t outY[4])
+    {
+        const float4 zero(0.0f);
+        const float4 one(1.0f);
+        float4 l1 = float4::max(float4::abs(x) + float4::abs(y) + float4::abs(z), float4(1e-20f));
+        float4 px = x / l1;
+        float4 py = y / l1;
+        float4 lower = z < zero;
+        float4 foldedX = (one - float4::abs(py)) * float4::signNotZero(px);
+        float4 foldedY = (one - float4::abs(px)) * float4::signNotZero(py);
+        px = float4::select(lower, foldedX, px);
+        py = float4::select(lower, foldedY, py);
+
+        const float4 snormScale(32767.0f);
+        (px * snormScale).storeRoundedInt(outX);
+        (py * snormScale).storeRoundedInt(outY);
+    }
+
+    /**
+     * @brief Pack a contiguous range on the calling thread
+     * @param src Source vertices
+     * @param count Number of vertices
+     * @param dst Destination (may be mapped GPU memory)
+     */
+    inline void packRange(const Vertex* src, size_t count, PackedVertex* dst)
+    {
+        const float4 zero(0.0f);
+        const float4 one(1.0f);
+        const float4 byteScale(255.0f);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const Vertex* v = src + i;
+
+            alignas(16) int32_t normalX[4], normalY[4];
+            encodeOctahedral4(float4(v[0].normal.x, v[1].normal.x, v[2].normal.x, v[3].normal.x),
+                              float4(v[0].normal.y, v[1].normal.y, v[2].normal.y, v[3].normal.y),
+                              float4(v[0].normal.z, v[1].normal.z, v[2].normal.z, v[3].normal.z),
+                              normalX, normalY);
+
+            alignas(16) int32_t tangentX[4], tangentY[4];
+            encodeOctahedral4(float4(v[0].tangent.x, v[1].tangent.x, v[2].tangent.x, v[3].tangent.x),
+                              float4(v[0].tangent.y, v[1].tangent.y, v[2].tangent.y, v[3].tangent.y),
+                              float4(v[0].tangent.z, v[1].tangent.z, v[2].tangent.z, v[3].tangent.z),
+                              tangentX, tangentY);
+
+            // Half-float UVs
+            alignas(16) uint16_t uvU[4], uvV[4];
+            float4(v[0].uv.x, v[1].uv.x, v[2].uv.x, v[3].uv.x).storeHalf(uvU);
+            float4(v[0].uv.y, v[1].uv.y, v[2].uv.y, v[3].uv.y).storeHalf(uvV);
+
+            // 8-bit colors
+            alignas(16) int32_t colR[4], colG[4], colB[4];
+            (float4::clamp(float4(v[0].vertexColor.x, v[1].vertexColor.x, v[2].vertexColor.x, v[3].vertexColor.x), zero, one) * byteScale).storeRoundedInt(colR);
+            (float4::clamp(float4(v[0].vertexColor.y, v[1].vertexColor.y, v[2].vertexColor.y, v[3].vertexColor.y), zero, one) * byteScale).storeRoundedInt(colG);
+            (float4::clamp(float4(v[0].vertexColor.z, v[1].vertexColor.z, v[2].vertexColor.z, v[3].vertexColor.z), zero, one) * byteScale).storeRoundedInt(colB);
+
+            for (int k = 0; k < 4; k++)
+            {
+                PackedVertex pv;
+                pv.position[0] = v[k].position.x;
+                pv.position[1] = v[k].position.y;
+                pv.position[2] = v[k].position.z;
+                pv.normal[0] = static_cast<int16_t>(normalX[k]);
+                pv.normal[1] = static_cast<int16_t>(normalY[k]);
+                pv.uv[0] = uvU[k];
+                pv.uv[1] = uvV[k];
+                pv.color[0] = static_cast<uint8_t>(colR[k]);
+                pv.color[1] = static_cast<uint8_t>(colG[k]);
+                pv.color[2] = static_cast<uint8_t>(colB[k]);
+                pv.color[3] = 255;
+                pv.tangent[0] = static_cast<int16_t>(tangentX[k]);
+                pv.tangent[1] = static_cast<int16_t>(tangentY[k]);
+                pv.tangent[2] = v[k].tangentSign < 0.0f ? -32767 : 32767;
+                pv.tangent[3] = 0;
+                std::memcpy(dst + i + k, &pv, sizeof(PackedVertex));
+            }
+        }
+
+        for (; i < count; i++)
+        {
+            packOne(src[i], dst[i]);
+        }
+    }
+
+    /**
+     * @brief Copy positions into a tightly packed float3 stream
+     */
+    inline void packPositionsRange(const Vertex* src, size_t count, float* dst)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            float p[3] = { src[i].position.x, src[i].position.y, src[i].position.z };
+            std::memcpy(dst + i * 3, p, sizeof(p));
+        }
+    }
+
+    /**
+     * @brief Quantize positions to snorm16 relative to (offset, scale)
+     * Stores round(clamp((p - offset) / scale, -1, 1) * 32767), w = 0.
+     */
+    inline void packPositionsSnorm16Range(const Vertex* src, size_t count,
+                                          const vec3& offset, const vec3& invScale, int16_t* dst)
+    {
+        const float4 lo(-1.0f);
+        const float4 hi(1.0f);
+        const float4 snormScale(32767.0f);
+        const float4 off(offset.x, offset.y, offset.z, 0.0f);
+        const float4 inv(invScale.x, invScale.y, invScale.z, 0.0f);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            float4 p(src[i].position.x, src[i].position.y, src[i].position.z, 0.0f);
+            alignas(16) int32_t q[4];
+            (float4::clamp((p - off) * inv, lo, hi) * snormScale).storeRoundedInt(q);
+            int16_t packed[4] = { (int16_t)q[0], (int16_t)q[1], (int16_t)q[2], 0 };
+            std::memcpy(dst + i * 4, packed, sizeof(packed));
+        }
+    }
+
+    /**
+     * @brief Fill a position-only stream, in parallel for large meshes
+     * @param format Float3 or Snorm16 (None writes nothing)
+     * @param offset, scale Dequantization transform for Snorm16 (p = offset + q * scale)
+     */
+    inline void packPositions(const Vertex* src, size_t count, PositionStreamFormat format,
+                              const vec3& offset, const vec3& scale, void* dst)
+    {
+        if (format == PositionStreamFormat::None || count == 0)
+            return;
+
+        vec3 invScale(1.0f / scale.x, 1.0f / scale.y, 1.0f / scale.z);
+        auto packSpan = [=](size_t begin, size_t end) {
+            if (format == PositionStreamFormat::Float3)
+                packPositionsRange(src + begin, end - begin, static_cast<float*>(dst) + begin * 3);
+            else
+                packPositionsSnorm16Range(src + begin, end - begin, offset, invScale,
+                                          static_cast<int16_t*>(dst) + begin * 4);
+        };
+
+        if (count < PARALLEL_THRESHOLD)
+            packSpan(0, count);
+        else
+            JobSystem::getInstance().parallelFor(count, MIN_BATCH, packSpan);
+    }
+
+    /**
+     * @brief Pack vertices, spreading large ranges across worker threads
+     * @param src Source vertices
+     * @param count Number of vertices
+     * @param dst Destination (may be mapped GPU memory)
+     */
+    inline void pack(const Vertex* src, size_t count, PackedVertex* dst)
+    {
+        if (count < PARALLEL_THRESHOLD)
+        {
+            packRange(src, count, dst);
+            return;
+        }
+
+        JobSystem::getInstance().parallelFor(count, MIN_BATCH,
+            [src, dst](size_t begin, size_t end) {
+                packRange(src + begin, end - begin, dst + begin);
+            });
+    }
+}
+
+#endif // VERTEX_PACKING_H
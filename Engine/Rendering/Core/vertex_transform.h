@@ -0,0 +1,167 @@
+#ifndef VERTEX_TRANSFORM_H
+#define VERTEX_TRANSFORM_H
+
+#include "../Primitives/mesh.h"
+#include "../../Math/mat4.h"
+#include "../../Math/simd.h"
+
+/**
+ * @file vertex_transform.h
+ * @brief SIMD bake of a model matrix into vertex data
+ *
+ * Used where meshes are merged in world space (static and dynamic
+ * batching). Four vertices per iteration: positions by the model matrix,
+ * normals by its inverse transpose, tangents by its upper 3x3, both
+ * renormalized. Mirroring transforms flip the bitangent sign; callers
+ * must also flip triangle winding (see isMirrored).
+ */
+namespace VertexTransform
+{
+    /**
+     * @brief Whether the matrix mirrors (negative upper 3x3 determinant)
+     */
+    inline bool isMirrored(const mat4& model)
+    {
+        vec3 r0(model.m[0][0], model.m[0][1], model.m[0][2]);
+        vec3 r1(model.m[1][0], model.m[1][1], model.m[1][2]);
+        vec3 r2(model.m[2][0], model.m[2][1], model.m[2][2]);
+        return vec3::dot(r0, vec3::cross(r1, r2)) < 0.0f;
+    }
+
+    /**
+     * @brief Matrix for normals: inverse transpose of the upper 3x3, up to a
+     * positive scale (normals are renormalized anyway)
+     * Rows are the cofactors, r1 x r2, r2 x r0, r0 x r1, times sign(det),
+     * so it's far cheaper than a full inverse.
+     */
+    inline mat4 normalMatrix(const mat4& model)
+    {
+        vec3 r0(model.m[0][0], model.m[0][1], model.m[0][2]);
+        vec3 r1(model.m[1][0], model.m[1][1], model.m[1][2]);
+        vec3 r2(model.m[2][0], model.m[2][1], model.m[2][2]);
+        vec3 c0 = vec3::cross(r1, r2);
+        vec3 c1 = vec3::cross(r2, r0);
+        vec3 c2 = vec3::cross(r0, r1);
+        float sign = vec3::dot(r0, c0) < 0.0f ? -1.0f : 1.0f;
+
+        mat4 result = mat4::identity();
+        result.m[0][0] = c0.x * sign; result.m[0][1] = c0.y * sign; result.m[0][2] = c0.z * sign;
+        result.m[1][0] = c1.x * sign; result.m[1][1] = c1.y * sign; result.m[1][2] = c1.z * sign;
+        result.m[2][0] = c2.x * sign; result.m[2][1] = c2.y * sign; result.m[2][2] = c2.z * sign;
+        return result;
+    }
+
+    /**
+     * @brief Normalize four vectors in place (zero vectors stay zero)
+     */
+    inline void normalize4(float4& x, float4& y, float4& z)
+    {
+        float4 length = float4::sqrt(x * x + y * y + z * z);
+        float4 inv = float4(1.0f) / float4::max(length, float4(1e-20f));
+        x = x * inv;
+        y = y * inv;
+        z = z * inv;
+    }
+
+    /**
+     * @brief Transform a range of vertices into dst (may alias src)
+     * @param normalMatrix See VertexTransform::normalMatrix
+     */
+    inline void transformRange(const Vertex* src, size_t count, const mat4& model,
+                               const mat4& normalMatrix, bool mirrored, Vertex* dst)
+    {
+        const float4 m00(model.m[0][0]), m01(model.m[0][1]), m02(model.m[0][2]), m03(model.m[0][3]);
+        const float4 m10(model.m[1][0]), m11(model.m[1][1]), m12(model.m[1][2]), m13(model.m[1][3]);
+        const float4 m20(model.m[2][0]), m21(model.m[2][1]), m22(model.m[2][2]), m23(model.m[2][3]);
+        const float4 n00(normalMatrix.m[0][0]), n01(normalMatrix.m[0][1]), n02(normalMatrix.m[0][2]);
+        const float4 n10(normalMatrix.m[1][0]), n11(normalMatrix.m[1][1]), n12(normalMatrix.m[1][2]);
+        const float4 n20(normalMatrix.m[2][0]), n21(normalMatrix.m[2][1]), n22(normalMatrix.m[2][2]);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const Vertex* v = src + i;
+
+            float4 px(v[0].position.x, v[1].position.x, v[2].position.x, v[3].position.x);
+            float4 py(v[0].position.y, v[1].position.y, v[2].position.y, v[3].position.y);
+            float4 pz(v[0].position.z, v[1].position.z, v[2].position.z, v[3].position.z);
+            float4 nx(v[0].normal.x, v[1].normal.x, v[2].normal.x, v[3].normal.x);
+            float4 ny(v[0].normal.y, v[1].normal.y, v[2].normal.y, v[3].normal.y);
+            float4 nz(v[0].normal.z, v[1].normal.z, v[2].normal.z, v[3].normal.z);
+            float4 tx(v[0].tangent.x, v[1].tangent.x, v[2].tangent.x, v[3].tangent.x);
+            float4 ty(v[0].tangent.y, v[1].tangent.y, v[2].tangent.y, v[3].tangent.y);
+            float4 tz(v[0].tangent.z, v[1].tangent.z, v[2].tangent.z, v[3].tangent.z);
+
+            alignas(16) float outPos[3][4], outNormal[3][4], outTangent[3][4];
+            (m00 * px + m01 * py + m02 * pz + m03).store(outPos[0]);
+            (m10 * px + m11 * py + m12 * pz + m13).store(outPos[1]);
+            (m20 * px + m21 * py + m22 * pz + m23).store(outPos[2]);
+
+            float4 wnx = n00 * nx + n01 * ny + n02 * nz;
+            float4 wny = n10 * nx + n11 * ny + n12 * nz;
+            float4 wnz = n20 * nx + n21 * ny + n22 * nz;
+            normalize4(wnx, wny, wnz);
+            wnx.store(outNormal[0]);
+            wny.store(outNormal[1]);
+            wnz.store(outNormal[2]);
+
+            float4 wtx = m00 * tx + m01 * ty + m02 * tz;
+            float4 wty = m10 * tx + m11 * ty + m12 * tz;
+            float4 wtz = m20 * tx + m21 * ty + m22 * tz;
+            normalize4(wtx, wty, wtz);
+            wtx.store(outTangent[0]);
+            wty.store(outTangent[1]);
+            wtz.store(outTangent[2]);
+
+            for (int k = 0; k < 4; k++)
+            {
+                Vertex out = v[k];
+                out.position = vec3(outPos[0][k], outPos[1][k], outPos[2][k]);
+                out.normal = vec3(outNormal[0][k], outNormal[1][k], outNormal[2][k]);
+                out.tangent = vec3(outTangent[0][k], outTangent[1][k], outTangent[2][k]);
+                if (mirrored)
+                    out.tangentSign = -out.tangentSign;
+                dst[i + k] = out;
+            }
+        }
+
+        for (; i < count; i++)
+        {
+            Vertex out = src[i];
+            out.position = model.transformPoint(src[i].position);
+            out.normal = normalMatrix.transformDirection(src[i].normal).normalized();
+            out.tangent = model.transformDirection(src[i].tangent).normalized();
+            if (mirrored)
+                out.tangentSign = -out.tangentSign;
+            dst[i] = out;
+        }
+    }
+
+    /**
+     * @brief Transform all of a mesh's vertices into dst
+     * @return Whether the transform mirrors (flip winding when copying triangles)
+     */
+    inline bool transformMesh(const Mesh& mesh, const mat4& model, Vertex* dst)
+    {
+        bool mirrored = isMirrored(model);
+        transformRange(mesh.vertices.data(), mesh.vertices.size(), model,
+                       normalMatrix(model), mirrored, dst);
+        return mirrored;
+    }
+
+    /**
+     * @brief Copy a mesh's triangles as indices offset by baseVertex
+     * @param mirrored Swap two corners to keep faces front-facing
+     */
+    inline void copyIndices(const Mesh& mesh, unsigned int baseVertex, bool mirrored, unsigned int* dst)
+    {
+        for (const Triangle& t : mesh.triangles)
+        {
+            *dst++ = baseVertex + t.v0;
+            *dst++ = baseVertex + (mirrored ? t.v2 : t.v1);
+            *dst++ = baseVertex + (mirrored ? t.v1 : t.v2);
+        }
+    }
+}
+
+#endif // VERTEX_TRANSFORM_H
@@ -215,6 +215,9 @@ public:
             mesh->triangles.push_back(Triangle{(int)indices[i], (int)indices[i+1], (int)indices[i+2]});
         }
         
+        // Tangent frames for normal mapping
+        mesh->calculateTangents();
+        
         std::cout << "Loaded OBJ: " << filepath << std::endl;
         std::cout << "  Vertices: " << vertices.size() << std::endl;
         std::cout << "  Triangles: " << indices.size() / 3 << std::endl;
@@ -0,0 +1,172 @@
+//
+// TextureArrayPacker - Pack same-purpose textures into one texture array
+//
+
+#ifndef TEXTURE_ARRAY_PACKER_H
+#define TEXTURE_ARRAY_PACKER_H
+
+#include "textureLoader.h"
+#include "../Materials/material.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class TextureArrayPacker
+ * @brief Builds a GL_TEXTURE_2D_ARRAY from images of any size
+ *
+ * Every image is converted to RGBA and resized to the layer size, so
+ * materials that only differ by texture can share one array (and one
+ * binding) and select their image with a layer index.
+ *
+ * Example:
+ * @code
+ * // Rewrites the materials to sample _MainTexArray at their own layer
+ * auto array = TextureArrayPacker::packMaterials({ brick, stone, wood }, 512, 512);
+ * @endcode
+ */
+class TextureArrayPacker
+{
+private:
+    static constexpr int LAYER_CHANNELS = 4;
+
+    int layerWidth;
+    int layerHeight;
+    std::vector<std::vector<unsigned char>> layerPixels;
+    std::unordered_map<std::string, int> fileLayers;  // Path -> layer (a file is packed once)
+
+public:
+    TextureArrayPacker(int width, int height)
+        : layerWidth(width), layerHeight(height)
+    {
+    }
+
+    /**
+     * @brief Add an image as a new layer
+     * @param data Pixel data (1-4 channels, rows bottom to top like TextureLoader)
+     * @return Layer index, or -1 for invalid data
+     */
+    int addImage(const unsigned char* data, int width, int height, int channels)
+    {
+        if (!data || width <= 0 || height <= 0 || channels < 1 || channels > 4)
+            return -1;
+
+        // Expand to RGBA at the source size, then scale to the layer size
+        std::vector<unsigned char> rgba(static_cast<size_t>(width) * height * LAYER_CHANNELS);
+        for (int i = 0; i < width * height; i++)
+        {
+            const unsigned char* src = data + static_cast<size_t>(i) * channels;
+            unsigned char* dst = rgba.data() + static_cast<size_t>(i) * LAYER_CHANNELS;
+            dst[0] = src[0];
+            dst[1] = channels >= 3 ? src[1] : src[0];
+            dst[2] = channels >= 3 ? src[2] : src[0];
+            dst[3] = channels == 4 ? src[3] : (channels == 2 ? src[1] : 255);
+        }
+
+        unsigned char* resized = TextureLoader::resizeImage(rgba.data(), width, height,
+                                                            layerWidth, layerHeight, LAYER_CHANNELS);
+        layerPixels.emplace_back(resized, resized + static_cast<size_t>(layerWidth) * layerHeight * LAYER_CHANNELS);
+        delete[] resized;
+
+        return static_cast<int>(layerPixels.size()) - 1;
+    }
+
+    /**
+     * @brief Load an image file as a layer (a path already added returns its layer)
+     * @return Layer index, or -1 if the file could not be loaded
+     */
+    int addFile(const std::string& filepath)
+    {
+        auto it = fileLayers.find(filepath);
+        if (it != fileLayers.end())
+            return it->second;
+
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load(true);
+        unsigned char* data = stbi_load(filepath.c_str(), &width, &height, &channels, 0);
+        if (!data)
+        {
+            std::cerr << "Failed to load texture: " << filepath << std::endl;
+            std::cerr << "STB Error: " << stbi_failure_reason() << std::endl;
+            return -1;
+        }
+
+        int layer = addImage(data, width, height, channels);
+        stbi_image_free(data);
+
+        if (layer >= 0)
+            fileLayers[filepath] = layer;
+        return layer;
+    }
+
+    /**
+     * @brief Upload all layers as one texture array
+     * @return Texture array, or nullptr if there are no layers
+     */
+    std::shared_ptr<Texture> build(Texture::FilterMode filter = Texture::FilterMode::Bilinear,
+                                   Texture::WrapMode wrap = Texture::WrapMode::Repeat) const
+    {
+        if (layerPixels.empty())
+            return nullptr;
+
+        std::vector<const unsigned char*> layerData;
+        layerData.reserve(layerPixels.size());
+        for (const auto& pixels : layerPixels)
+            layerData.push_back(pixels.data());
+
+        auto texture = std::make_shared<Texture>();
+        if (!texture->createArray(layerData, layerWidth, layerHeight, LAYER_CHANNELS, filter, wrap))
+            return nullptr;
+        return texture;
+    }
+
+    int getLayerCount() const { return static_cast<int>(layerPixels.size()); }
+
+    /**
+     * @brief Move the _MainTex file textures of several materials into one texture array
+     * @param materials Materials to rewrite (usually sharing one shader); their
+     *        _MainTex needs a file path (see Material::setTexture)
+     * @return The array, or nullptr if no material had a loadable file
+     *
+     * Each packed material gets _MainTexArray, _MainTexLayer and
+     * _UseMainTexArray; its 2D _MainTex is removed. Only _MainTex has an
+     * array path in the built-in shaders. Materials that were
+     * identical apart from the texture then pass Material::isBatchCompatible
+     * and the renderer switches between them with one uniform.
+     */
+    static std::shared_ptr<Texture> packMaterials(const std::vector<std::shared_ptr<Material>>& materials,
+                                                  int layerWidth, int layerHeight)
+    {
+        TextureArrayPacker packer(layerWidth, layerHeight);
+        std::vector<std::pair<Material*, int>> packed;
+
+        for (const auto& material : materials)
+        {
+            if (!material)
+                continue;
+            std::string path = material->getTexturePath("_MainTex");
+            if (path.empty())
+                continue;
+
+            int layer = packer.addFile(path);
+            if (layer >= 0)
+                packed.emplace_back(material.get(), layer);
+        }
+
+        auto array = packer.build();
+        if (!array)
+            return nullptr;
+
+        for (const auto& [material, layer] : packed)
+        {
+            material->removeTexture("_MainTex");
+            material->setInt("_UseMainTex", 0);
+            material->setTexture("_MainTexArray", array);
+            material->setFloat("_MainTexLayer", static_cast<float>(layer));
+        }
+        return array;
+    }
+};
+
+#endif // TEXTURE_ARRAY_PACKER_H
@@ -29,7 +29,7 @@
  */
 class TextureLoader
 {
-private:
+public:
     /**
      * @brief Resize image data using bilinear interpolation
      * Proper game engine approach - handles any size mismatch
@@ -100,7 +100,6 @@ private:
         return outputData;
     }
 
-public:
     /**
      * @brief Load texture from file with automatic resizing to target dimensions
      * @param filepath Path to image file
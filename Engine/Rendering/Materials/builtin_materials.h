@@ -7,6 +7,7 @@
 
 #include "material.h"
 #include "../Shaders/shader.h"
+#include "../Shaders/default_shaders.h"
 #include "../texture.h"
 #include <memory>
 
@@ -19,13 +20,34 @@
  */
 class BuiltinMaterials
 {
+private:
+    /**
+     * Program shared by all live materials of one type, compiled on first use
+     * Materials on the same program sort and batch together (see
+     * Material::isBatchCompatible); the program is freed with the last of them.
+     */
+    static std::shared_ptr<Shader> getSharedShader(std::weak_ptr<Shader>& cache,
+                                                   const char* vertexShader, const char* fragmentShader)
+    {
+        if (auto shader = cache.lock())
+            return shader;
+
+        auto shader = std::make_shared<Shader>();
+        if (!shader->compileFromSource(vertexShader, fragmentShader))
+            return nullptr;
+        cache = shader;
+        return shader;
+    }
+
 public:
     /**
      * Create Standard (PBR) material
      * Supports albedo, metallic, roughness, normal, and occlusion maps
+     * Lit by the first directional light plus clustered point/spot lights
      * 
      * Properties:
      * - _MainTex: Albedo (diffuse) texture
+     * - _MainTexArray, _MainTexLayer: Texture array and layer used instead of _MainTex
      * - _Color: Albedo tint color
      * - _MetallicGlossMap: Metallic (R) and Smoothness (A) texture
      * - _Metallic: Metallic factor (0-1)
@@ -43,9 +65,12 @@ public:
             layout (location = 1) in vec2 aNormalPacked;
             layout (location = 2) in vec2 aTexCoord;
             layout (location = 3) in vec4 aColor;
+            layout (location = 4) in vec4 aTangentPacked;  // Octahedral tangent (xy), bitangent sign (z)
             
             out vec3 FragPos;
             out vec3 Normal;
+            out vec3 Tangent;
+            out float BitangentSign;
             out vec3 VertexColor;
             out vec2 TexCoord;
             
@@ -82,6 +107,8 @@ public:
                 vec3 localNormal = unpackNormal(aNormalPacked);
                 // Use mat3(model) which works for uniform scaling and identity transforms
                 Normal = normalize(mat3(model) * localNormal);
+                Tangent = normalize(mat3(model) * unpackNormal(aTangentPacked.xy));
+                BitangentSign = aTangentPacked.z < 0.0 ? -1.0 : 1.0;
                 VertexColor = aColor.rgb;
                 TexCoord = aTexCoord;
                 gl_Position = projection * view * vec4(FragPos, 1.0);
@@ -94,11 +121,15 @@ public:
             
             in vec3 FragPos;
             in vec3 Normal;
+            in vec3 Tangent;
+            in float BitangentSign;
             in vec3 VertexColor;
             in vec2 TexCoord;
             
             // Material properties
             uniform sampler2D _MainTex;
+            uniform sampler2DArray _MainTexArray;
+            uniform float _MainTexLayer;
             uniform vec3 _Color;
             uniform sampler2D _MetallicGlossMap;
             uniform float _Metallic;
@@ -109,6 +140,7 @@ public:
             uniform float _OcclusionStrength;
             
             uniform bool _UseMainTex;
+            uniform bool _UseMainTexArray;
             uniform bool _UseMetallicMap;
             uniform bool _UseBumpMap;
             uniform bool _UseOcclusionMap;
@@ -118,6 +150,8 @@ public:
             uniform vec3 lightColor;
             uniform vec3 viewPos;
             uniform vec3 ambientColor;
+            uniform mat4 view;
+            uniform mat4 projection;
             
             const float PI = 3.14159265359;
             
@@ -166,7 +200,9 @@ public:
             {
                 // Sample textures
                 vec3 albedo = _Color;
-                if (_UseMainTex) {
+                if (_UseMainTexArray) {
+                    albedo *= texture(_MainTexArray, vec3(TexCoord, _MainTexLayer)).rgb;
+                } else if (_UseMainTex) {
                     albedo *= texture(_MainTex, TexCoord).rgb;
                 }
                 
@@ -181,12 +217,12 @@ public:
                 
                 vec3 N = normalize(Normal);
                 if (_UseBumpMap) {
-                    // Simple normal mapping - improved for flat surfaces
+                    // Tangent-space normal map using the per-vertex tangent frame
                     vec3 normalMap = texture(_BumpMap, TexCoord).rgb * 2.0 - 1.0;
-                    // For flat surfaces, apply bump more carefully to avoid artifacts
-                    // Mix in the bump perturbation more subtly
-                    vec3 bumpPerturbation = normalMap * _BumpScale * 0.1; // Scale down the effect
-                    N = normalize(N + bumpPerturbation);
+                    normalMap.xy *= _BumpScale;
+                    vec3 T = normalize(Tangent - N * dot(N, Tangent));  // Re-orthogonalize after interpolation
+                    vec3 B = cross(N, T) * BitangentSign;
+                    N = normalize(mat3(T, B, N) * normalMap);
                 }
                 
                 float ao = 1.0;
@@ -218,7 +254,24 @@ public:
                 vec3 specular = numerator / denominator;
                 
                 float NdotL = max(dot(N,  L), 0.0);
-                vec3 Lo = (kD * albedo / PI + specular) * lightColor * NdotL;
+                float shadow = directionalShadow(FragPos, normalize(Normal), -(view * vec4(FragPos, 1.0)).z);
+                vec3 Lo = (kD * albedo / PI + specular) * lightColor * NdotL * shadow;
+                
+                // Point and spot lights of this fragment's cluster
+                uvec2 cluster = clusterLightRange(FragPos, view, projection);
+                for (uint i = 0u; i < cluster.y; i++)
+                {
+                    ClusterLight light = fetchClusterLight(clusterLightIndex(cluster.x + i));
+                    vec3 Li;
+                    float attenuation = clusterLightAttenuation(light, FragPos, Li);
+                    vec3 Hi = normalize(V + Li);
+                    float NdotLi = max(dot(N, Li), 0.0);
+                    vec3 Fi = fresnelSchlick(max(dot(Hi, V), 0.0), F0);
+                    vec3 kDi = (vec3(1.0) - Fi) * (1.0 - metallic);
+                    vec3 specularI = DistributionGGX(N, Hi, roughness) * GeometrySmith(N, V, Li, roughness) * Fi /
+                                     (4.0 * max(dot(N, V), 0.0) * NdotLi + 0.0001);
+                    Lo += (kDi * albedo / PI + specularI) * light.color * light.intensity * attenuation * NdotLi;
+                }
                 
                 // Ambient
                 vec3 ambient = ambientColor * albedo * ao;
@@ -233,8 +286,10 @@ public:
             }
         )";
 
-        auto shader = std::make_shared<Shader>();
-        if (!shader->compileFromSource(vertexShader, fragmentShader))
+        static std::weak_ptr<Shader> sharedShader;
+        auto shader = getSharedShader(sharedShader, vertexShader,
+                                      DefaultShaders::withLighting(fragmentShader).c_str());
+        if (!shader)
         {
             std::cerr << "ERROR: Failed to compile Standard material shader" << std::endl;
             return nullptr;
@@ -249,6 +304,8 @@ public:
         material->setFloat("_BumpScale", 1.0f);
         material->setFloat("_OcclusionStrength", 1.0f);
         material->setInt("_UseMainTex", 0);
+        material->setInt("_UseMainTexArray", 0);
+        material->setFloat("_MainTexLayer", 0.0f);
         material->setInt("_UseMetallicMap", 0);
         material->setInt("_UseBumpMap", 0);
         material->setInt("_UseOcclusionMap", 0);
@@ -262,6 +319,7 @@ public:
      * 
      * Properties:
      * - _MainTex: Main texture
+     * - _MainTexArray, _MainTexLayer: Texture array and layer used instead of _MainTex
      * - _Color: Tint color
      */
     static std::shared_ptr<Material> createUnlit()
@@ -296,21 +354,27 @@ public:
             in vec2 TexCoord;
             
             uniform sampler2D _MainTex;
+            uniform sampler2DArray _MainTexArray;
+            uniform float _MainTexLayer;
             uniform vec3 _Color;
             uniform bool _UseMainTex;
+            uniform bool _UseMainTexArray;
             
             void main()
             {
                 vec3 color = _Color;
-                if (_UseMainTex) {
+                if (_UseMainTexArray) {
+                    color *= texture(_MainTexArray, vec3(TexCoord, _MainTexLayer)).rgb;
+                } else if (_UseMainTex) {
                     color *= texture(_MainTex, TexCoord).rgb;
                 }
                 FragColor = vec4(color, 1.0);
             }
         )";
 
-        auto shader = std::make_shared<Shader>();
-        if (!shader->compileFromSource(vertexShader, fragmentShader))
+        static std::weak_ptr<Shader> sharedShader;
+        auto shader = getSharedShader(sharedShader, vertexShader, fragmentShader);
+        if (!shader)
         {
             std::cerr << "ERROR: Failed to compile Unlit material shader" << std::endl;
             return nullptr;
@@ -319,6 +383,8 @@ public:
         auto material = std::make_shared<Material>(shader, "Unlit");
         material->setColor("_Color", color(1, 1, 1));
         material->setInt("_UseMainTex", 0);
+        material->setInt("_UseMainTexArray", 0);
+        material->setFloat("_MainTexLayer", 0.0f);
 
         return material;
     }
@@ -326,9 +392,11 @@ public:
     /**
      * Create Standard Specular material (non-metallic workflow)
      * Uses specular color instead of metallic parameter
+     * Lit by the first directional light plus clustered point/spot lights
      * 
      * Properties:
      * - _MainTex: Albedo texture
+     * - _MainTexArray, _MainTexLayer: Texture array and layer used instead of _MainTex
      * - _Color: Albedo tint
      * - _SpecGlossMap: Specular (RGB) and Smoothness (A)
      * - _SpecColor: Specular tint
@@ -397,22 +465,29 @@ public:
             in vec2 TexCoord;
             
             uniform sampler2D _MainTex;
+            uniform sampler2DArray _MainTexArray;
+            uniform float _MainTexLayer;
             uniform vec3 _Color;
             uniform sampler2D _SpecGlossMap;
             uniform vec3 _SpecColor;
             uniform float _Glossiness;
             uniform bool _UseMainTex;
+            uniform bool _UseMainTexArray;
             uniform bool _UseSpecGlossMap;
             
             uniform vec3 lightDir;
             uniform vec3 lightColor;
             uniform vec3 viewPos;
             uniform vec3 ambientColor;
+            uniform mat4 view;
+            uniform mat4 projection;
             
             void main()
             {
                 vec3 albedo = _Color;
-                if (_UseMainTex) {
+                if (_UseMainTexArray) {
+                    albedo *= texture(_MainTexArray, vec3(TexCoord, _MainTexLayer)).rgb;
+                } else if (_UseMainTex) {
                     albedo *= texture(_MainTex, TexCoord).rgb;
                 }
                 
@@ -429,13 +504,27 @@ public:
                 vec3 V = normalize(viewPos - FragPos);
                 vec3 H = normalize(L + V);
                 
+                float shadow = directionalShadow(FragPos, N, -(view * vec4(FragPos, 1.0)).z);
+                
                 // Diffuse
                 float diff = max(dot(N, L), 0.0);
-                vec3 diffuse = diff * lightColor * albedo;
+                vec3 diffuse = diff * lightColor * albedo * shadow;
                 
                 // Specular (Blinn-Phong)
                 float spec = pow(max(dot(N,  H), 0.0), smoothness * 128.0);
-                vec3 specularColor = spec * lightColor * specular;
+                vec3 specularColor = spec * lightColor * specular * shadow;
+                
+                // Point and spot lights of this fragment's cluster
+                uvec2 cluster = clusterLightRange(FragPos, view, projection);
+                for (uint i = 0u; i < cluster.y; i++)
+                {
+                    ClusterLight light = fetchClusterLight(clusterLightIndex(cluster.x + i));
+                    vec3 Li;
+                    float attenuation = clusterLightAttenuation(light, FragPos, Li);
+                    vec3 radiance = light.color * light.intensity * attenuation;
+                    diffuse += max(dot(N, Li), 0.0) * radiance * albedo;
+                    specularColor += pow(max(dot(N, normalize(Li + V)), 0.0), smoothness * 128.0) * radiance * specular;
+                }
                 
                 // Ambient
                 vec3 ambient = ambientColor * albedo;
@@ -449,8 +538,10 @@ public:
             }
         )";
 
-        auto shader = std::make_shared<Shader>();
-        if (!shader->compileFromSource(vertexShader, fragmentShader))
+        static std::weak_ptr<Shader> sharedShader;
+        auto shader = getSharedShader(sharedShader, vertexShader,
+                                      DefaultShaders::withLighting(fragmentShader).c_str());
+        if (!shader)
         {
             std::cerr << "ERROR: Failed to compile Standard Specular material shader" << std::endl;
             return nullptr;
@@ -461,6 +552,8 @@ public:
         material->setColor("_SpecColor", color(0.2f, 0.2f, 0.2f));
         material->setFloat("_Glossiness", 0.5f);
         material->setInt("_UseMainTex", 0);
+        material->setInt("_UseMainTexArray", 0);
+        material->setFloat("_MainTexLayer", 0.0f);
         material->setInt("_UseSpecGlossMap", 0);
 
         return material;
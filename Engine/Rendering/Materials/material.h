@@ -9,6 +9,7 @@
 #include "../texture.h"
 #include "../../Math/vec3.h"
 #include "../color.h"
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -48,6 +49,8 @@ private:
     std::unordered_map<std::string, std::string> texturePaths;  // Track texture file paths for serialization
     std::unordered_map<std::string, int> intProperties;
     
+    uint64_t version;  // Bumped by every setter (lets render-thread snapshots detect edits)
+    
     // Default white texture for unbound samplers (prevents OpenGL warnings)
     static std::shared_ptr<Texture> getDefaultTexture()
     {
@@ -62,12 +65,12 @@ private:
 
 public:
     Material()
-        : name("Material"), renderQueue(RenderQueue::Geometry)
+        : name("Material"), renderQueue(RenderQueue::Geometry), version(0)
     {
     }
 
     Material(std::shared_ptr<Shader> shaderProgram, const std::string& materialName = "Material")
-        : shader(shaderProgram), name(materialName), renderQueue(RenderQueue::Geometry)
+        : shader(shaderProgram), name(materialName), renderQueue(RenderQueue::Geometry), version(0)
     {
     }
 
@@ -76,6 +79,7 @@ public:
     void setShader(std::shared_ptr<Shader> shaderProgram)
     {
         shader = shaderProgram;
+        version++;
     }
 
     std::shared_ptr<Shader> getShader() const
@@ -88,26 +92,31 @@ public:
     void setFloat(const std::string& propertyName, float value)
     {
         floatProperties[propertyName] = value;
+        version++;
     }
 
     void setInt(const std::string& propertyName, int value)
     {
         intProperties[propertyName] = value;
+        version++;
     }
 
     void setVector(const std::string& propertyName, const vec3& value)
     {
         vectorProperties[propertyName] = value;
+        version++;
     }
 
     void setColor(const std::string& propertyName, const color& value)
     {
         colorProperties[propertyName] = value;
+        version++;
     }
 
     void setTexture(const std::string& propertyName, std::shared_ptr<Texture> texture)
     {
         textureProperties[propertyName] = texture;
+        version++;
         
         // Automatically enable texture usage flags for common samplers
         if (propertyName == "_MainTex") {
@@ -118,12 +127,15 @@ public:
             setInt("_UseBumpMap", texture && texture->isLoaded() ? 1 : 0);
         } else if (propertyName == "_OcclusionMap") {
             setInt("_UseOcclusionMap", texture && texture->isLoaded() ? 1 : 0);
+        } else if (propertyName == "_MainTexArray") {
+            setInt("_UseMainTexArray", texture && texture->isLoaded() ? 1 : 0);
         }
     }
 
     void setTexture(const std::string& propertyName, std::shared_ptr<Texture> texture, const std::string& filepath)
     {
         textureProperties[propertyName] = texture;
+        version++;
         texturePaths[propertyName] = filepath;
         
         // Automatically enable texture usage flags for common samplers
@@ -135,9 +147,21 @@ public:
             setInt("_UseBumpMap", texture && texture->isLoaded() ? 1 : 0);
         } else if (propertyName == "_OcclusionMap") {
             setInt("_UseOcclusionMap", texture && texture->isLoaded() ? 1 : 0);
+        } else if (propertyName == "_MainTexArray") {
+            setInt("_UseMainTexArray", texture && texture->isLoaded() ? 1 : 0);
         }
     }
 
+    /**
+     * Remove a texture property (and its file path); the sampler's flag is left as is
+     */
+    void removeTexture(const std::string& propertyName)
+    {
+        textureProperties.erase(propertyName);
+        texturePaths.erase(propertyName);
+        version++;
+    }
+
     std::string getTexturePath(const std::string& propertyName) const
     {
         auto it = texturePaths.find(propertyName);
@@ -181,6 +205,7 @@ public:
     void setRenderQueue(RenderQueue queue)
     {
         renderQueue = queue;
+        version++;
     }
 
     RenderQueue getRenderQueue() const
@@ -188,6 +213,14 @@ public:
         return renderQueue;
     }
 
+    /**
+     * Change counter, incremented by every setter
+     */
+    uint64_t getVersion() const
+    {
+        return version;
+    }
+
     // ==================== Material Application ====================
     
     /**
@@ -195,6 +228,20 @@ public:
      * Call this before rendering with this material
      */
     void applyToShader()
+    {
+        applyToShader([](const Texture& texture, int unit) { texture.bind(unit); });
+    }
+
+    /**
+     * Apply properties, binding textures through a callback
+     * @param bindTexture Callable bindTexture(const Texture&, int unit), e.g.
+     *        the renderer's cached binder that skips textures already bound
+     * 
+     * Each sampler keeps a fixed unit per shader (Shader::getSamplerUnit),
+     * so sampler uniforms are only set the first time.
+     */
+    template<typename BindFn>
+    void applyToShader(BindFn&& bindTexture)
     {
         if (!shader || !shader->isValid())
             return;
@@ -226,8 +273,6 @@ public:
         }
 
         // Apply texture properties - only bind textures that are actually set
-        int textureUnit = 0;
-        
         for (const auto& [name, texture] : textureProperties)
         {
             // Add extra safety checks to prevent segfaults
@@ -235,11 +280,7 @@ public:
             {
                 try {
                     if (texture->isLoaded())
-                    {
-                        texture->bind(textureUnit);
-                        shader->setInt(name, textureUnit);
-                        textureUnit++;
-                    }
+                        bindTexture(*texture, shader->getSamplerUnit(name));
                 } catch (...) {
                     // Skip this texture if binding fails
                     continue;
@@ -248,6 +289,35 @@ public:
         }
     }
 
+    /**
+     * Whether the renderer can switch from other to this material by only
+     * updating _MainTexLayer
+     * True when both use the same shader and render queue and every other
+     * property (textures compared by identity) is equal, e.g. variants that
+     * sample different layers of one texture array (see TextureArrayPacker).
+     */
+    bool isBatchCompatible(const Material& other) const
+    {
+        if (shader != other.shader || renderQueue != other.renderQueue)
+            return false;
+        if (intProperties != other.intProperties ||
+            vectorProperties != other.vectorProperties ||
+            colorProperties != other.colorProperties ||
+            textureProperties != other.textureProperties)
+            return false;
+        if (floatProperties.size() != other.floatProperties.size())
+            return false;
+        for (const auto& [name, value] : floatProperties)
+        {
+            if (name == "_MainTexLayer")
+                continue;
+            auto it = other.floatProperties.find(name);
+            if (it == other.floatProperties.end() || it->second != value)
+                return false;
+        }
+        return true;
+    }
+
     // ==================== Utility ====================
     
     void setName(const std::string& materialName)
@@ -0,0 +1,146 @@
+//
+// MaterialPropertyBlock - Per-renderer overrides of material values
+//
+
+#ifndef MATERIAL_PROPERTY_BLOCK_H
+#define MATERIAL_PROPERTY_BLOCK_H
+
+#include "material.h"
+#include "../Shaders/shader.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class MaterialPropertyBlock
+ * @brief Float, vector and color values that override a material for one renderer
+ *
+ * Unlike Material::clone(), renderers using a block keep sharing one
+ * Material, so their draws still sort and batch together; the renderer
+ * only sets the overridden uniforms around each draw. Blocks hold a few
+ * values, so they are stored in small vectors rather than maps.
+ *
+ * Example:
+ * @code
+ * MaterialPropertyBlock block;
+ * block.setColor("_Color", color(1, 0, 0));
+ * meshRenderer->setPropertyBlock(block);
+ * @endcode
+ */
+class MaterialPropertyBlock
+{
+private:
+    std::vector<std::pair<std::string, float>> floatProperties;
+    std::vector<std::pair<std::string, vec3>> vectorProperties;
+    std::vector<std::pair<std::string, color>> colorProperties;
+
+    template<typename T>
+    static void setValue(std::vector<std::pair<std::string, T>>& values, const std::string& name, const T& value)
+    {
+        for (auto& entry : values)
+        {
+            if (entry.first == name)
+            {
+                entry.second = value;
+                return;
+            }
+        }
+        values.emplace_back(name, value);
+    }
+
+    template<typename T>
+    static const T* findValue(const std::vector<std::pair<std::string, T>>& values, const std::string& name)
+    {
+        for (const auto& entry : values)
+        {
+            if (entry.first == name)
+                return &entry.second;
+        }
+        return nullptr;
+    }
+
+public:
+    // ==================== Property Setters ====================
+
+    void setFloat(const std::string& name, float value) { setValue(floatProperties, name, value); }
+    void setVector(const std::string& name, const vec3& value) { setValue(vectorProperties, name, value); }
+    void setColor(const std::string& name, const color& value) { setValue(colorProperties, name, value); }
+
+    // ==================== Property Getters ====================
+
+    bool hasFloat(const std::string& name) const { return findValue(floatProperties, name) != nullptr; }
+    bool hasVector(const std::string& name) const { return findValue(vectorProperties, name) != nullptr; }
+    bool hasColor(const std::string& name) const { return findValue(colorProperties, name) != nullptr; }
+
+    float getFloat(const std::string& name, float defaultValue = 0.0f) const
+    {
+        const float* value = findValue(floatProperties, name);
+        return value ? *value : defaultValue;
+    }
+
+    vec3 getVector(const std::string& name, const vec3& defaultValue = vec3::zero) const
+    {
+        const vec3* value = findValue(vectorProperties, name);
+        return value ? *value : defaultValue;
+    }
+
+    color getColor(const std::string& name, const color& defaultValue = color(1,1,1)) const
+    {
+        const color* value = findValue(colorProperties, name);
+        return value ? *value : defaultValue;
+    }
+
+    void clear()
+    {
+        floatProperties.clear();
+        vectorProperties.clear();
+        colorProperties.clear();
+    }
+
+    bool isEmpty() const
+    {
+        return floatProperties.empty() && vectorProperties.empty() && colorProperties.empty();
+    }
+
+    // ==================== Application ====================
+
+    /**
+     * Set the overridden uniforms (the shader must be in use)
+     */
+    void applyToShader(Shader& shader) const
+    {
+        for (const auto& [name, value] : floatProperties)
+            shader.setFloat(name, value);
+        for (const auto& [name, value] : vectorProperties)
+            shader.setVec3(name, value);
+        for (const auto& [name, value] : colorProperties)
+            shader.setColor(name, value);
+    }
+
+    /**
+     * Put the material's values back for the uniforms this block overrode
+     * @param material Material whose values to restore; names it doesn't set
+     *        go back to zero, the value of a never-set uniform
+     * @param next Block applied next; names it sets again are skipped
+     */
+    void restoreShader(Shader& shader, const Material* material, const MaterialPropertyBlock* next = nullptr) const
+    {
+        for (const auto& [name, value] : floatProperties)
+        {
+            if (!next || !next->hasFloat(name))
+                shader.setFloat(name, material ? material->getFloat(name, 0.0f) : 0.0f);
+        }
+        for (const auto& [name, value] : vectorProperties)
+        {
+            if (!next || !next->hasVector(name))
+                shader.setVec3(name, material ? material->getVector(name, vec3::zero) : vec3::zero);
+        }
+        for (const auto& [name, value] : colorProperties)
+        {
+            if (!next || !next->hasColor(name))
+                shader.setColor(name, material ? material->getColor(name, color(0, 0, 0)) : color(0, 0, 0));
+        }
+    }
+};
+
+#endif // MATERIAL_PROPERTY_BLOCK_H
@@ -7,11 +7,17 @@
 
 #include "../../Math/vec3.h"
 #include "../../Math/vec2.h"
+#include "../../Math/bounds.h"
 #include "../color.h"
 #include "../Core/render_types.h"
+#include "../../Core/Systems/jobSystem.h"
 #include <vector>
 #include <memory>
 #include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <mutex>
 
 struct Vertex
 {
@@ -19,11 +25,14 @@ struct Vertex
     vec3 normal;
     vec3 uv; // Using vec3 but only x,y used for texture coords
     color vertexColor;
+    vec3 tangent;      // Direction of increasing U (see Mesh::calculateTangents)
+    float tangentSign; // Bitangent handedness: B = sign * cross(N, T)
 
-    Vertex() : position(vec3::zero), normal(vec3::up), uv(vec3::zero), vertexColor(1, 1, 1) {}
+    Vertex() : position(vec3::zero), normal(vec3::up), uv(vec3::zero), vertexColor(1, 1, 1),
+               tangent(vec3::right), tangentSign(1.0f) {}
     
     Vertex(const vec3& pos, const vec3& norm = vec3::up, const vec3& texCoord = vec3::zero, const color& col = color(1, 1, 1))
-        : position(pos), normal(norm), uv(texCoord), vertexColor(col) {}
+        : position(pos), normal(norm), uv(texCoord), vertexColor(col), tangent(vec3::right), tangentSign(1.0f) {}
     
     // Texture coordinate accessors (for convenience with vec2)
     vec2 getTexCoord() const { return vec2(uv.x, uv.y); }
@@ -38,21 +47,176 @@ struct Triangle
     Triangle(int a, int b, int c) : v0(a), v1(b), v2(c) {}
 };
 
+/**
+ * @struct DirtyRange
+ * @brief Half-open element range [begin, end) that needs re-upload
+ * 
+ * Ranges grow to cover every marked span (no gaps are tracked), so
+ * two small edits at opposite ends of a mesh upload everything between.
+ */
+struct DirtyRange
+{
+    static constexpr size_t WHOLE = SIZE_MAX;  // Covers any element count
+
+    size_t begin;
+    size_t end;
+
+    DirtyRange() : begin(0), end(0) {}
+
+    bool empty() const { return end <= begin; }
+
+    /**
+     * @brief Grow range to include [first, first + count)
+     */
+    void include(size_t first, size_t count)
+    {
+        if (count == 0) return;
+        size_t last = (count > WHOLE - first) ? WHOLE : first + count;
+        if (empty())
+        {
+            begin = first;
+            end = last;
+        }
+        else
+        {
+            begin = std::min(begin, first);
+            end = std::max(end, last);
+        }
+    }
+
+    /**
+     * @brief Get range limited to a concrete element count
+     */
+    DirtyRange clamped(size_t count) const
+    {
+        DirtyRange r;
+        r.begin = std::min(begin, count);
+        r.end = std::min(end, count);
+        return r;
+    }
+
+    size_t size() const { return empty() ? 0 : end - begin; }
+
+    void clear() { begin = end = 0; }
+};
+
 class Mesh
 {
+public:
+    using DestroyCallback = std::function<void(uint64_t meshID)>;
+
 private:
+    /**
+     * @brief Listeners told when a mesh ID goes away (e.g. GPU caches)
+     * Heap-allocated and never freed so meshes destroyed during static
+     * teardown can still safely notify.
+     */
+    struct DestroyListeners
+    {
+        std::mutex mutex;
+        std::vector<std::pair<size_t, DestroyCallback>> callbacks;
+        size_t nextHandle = 1;
+    };
+
+    static DestroyListeners& destroyListeners()
+    {
+        static DestroyListeners* listeners = new DestroyListeners();
+        return *listeners;
+    }
+
     static std::atomic<uint64_t> nextMeshID;
     uint64_t meshID;
     bool isDirty;
     BufferUsage usage;
+    DirtyRange vertexDirty;     // Vertices changed since last upload
+    DirtyRange triangleDirty;   // Triangles changed since last upload
+    
+    // Local-space bounds, recomputed lazily after vertices change
+    mutable AABB localBounds;
+    mutable BoundingSphere localSphere;
+    mutable bool boundsDirty;
+    uint64_t version;           // Bumped whenever vertex or triangle data is marked dirty
     
 public:
     std::vector<Vertex> vertices;
     std::vector<Triangle> triangles;
 
     Mesh(BufferUsage bufferUsage = BufferUsage::Static) 
-        : meshID(++nextMeshID), isDirty(true), usage(bufferUsage)
+        : meshID(++nextMeshID), isDirty(true), usage(bufferUsage), boundsDirty(true), version(0)
     {
+        vertexDirty.include(0, DirtyRange::WHOLE);
+        triangleDirty.include(0, DirtyRange::WHOLE);
+    }
+
+    /**
+     * @brief Copy mesh data under a fresh ID (copies get their own GPU buffers)
+     */
+    Mesh(const Mesh& other)
+        : meshID(++nextMeshID), isDirty(true), usage(other.usage), boundsDirty(true), version(0),
+          vertices(other.vertices), triangles(other.triangles)
+    {
+        vertexDirty.include(0, DirtyRange::WHOLE);
+        triangleDirty.include(0, DirtyRange::WHOLE);
+    }
+
+    /**
+     * @brief Copy mesh data, keeping this mesh's ID (marks dirty)
+     */
+    Mesh& operator=(const Mesh& other)
+    {
+        if (this != &other)
+        {
+            usage = other.usage;
+            vertices = other.vertices;
+            triangles = other.triangles;
+            markDirty();
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Destructor - notifies listeners so GPU copies can be released
+     */
+    ~Mesh()
+    {
+        auto& listeners = destroyListeners();
+        std::lock_guard<std::mutex> lock(listeners.mutex);
+        for (auto& entry : listeners.callbacks)
+        {
+            entry.second(meshID);
+        }
+    }
+
+    /**
+     * @brief Register a callback invoked with the ID of every destroyed mesh
+     * Callbacks may run on any thread that destroys a mesh and must not
+     * create or destroy meshes themselves.
+     * @return Handle for removeDestroyListener
+     */
+    static size_t addDestroyListener(DestroyCallback callback)
+    {
+        auto& listeners = destroyListeners();
+        std::lock_guard<std::mutex> lock(listeners.mutex);
+        size_t handle = listeners.nextHandle++;
+        listeners.callbacks.emplace_back(handle, std::move(callback));
+        return handle;
+    }
+
+    /**
+     * @brief Unregister a destroy callback
+     * @param handle Value returned by addDestroyListener
+     */
+    static void removeDestroyListener(size_t handle)
+    {
+        auto& listeners = destroyListeners();
+        std::lock_guard<std::mutex> lock(listeners.mutex);
+        auto& callbacks = listeners.callbacks;
+        callbacks.erase(
+            std::remove_if(callbacks.begin(), callbacks.end(),
+                [handle](const std::pair<size_t, DestroyCallback>& entry) {
+                    return entry.first == handle;
+                }),
+            callbacks.end());
     }
     
     /**
@@ -68,12 +232,109 @@ public:
     /**
      * @brief Mark mesh as clean (called by renderer after upload)
      */
-    void clearDirty() { isDirty = false; }
+    void clearDirty()
+    {
+        isDirty = false;
+        vertexDirty.clear();
+        triangleDirty.clear();
+    }
+    
+    /**
+     * @brief Mark mesh as dirty (needs full re-upload)
+     */
+    void markDirty()
+    {
+        isDirty = true;
+        boundsDirty = true;
+        version++;
+        vertexDirty.include(0, DirtyRange::WHOLE);
+        triangleDirty.include(0, DirtyRange::WHOLE);
+    }
+
+    /**
+     * @brief Mark a span of vertices as changed (index data untouched)
+     * @param first Index of first modified vertex
+     * @param count Number of modified vertices
+     */
+    void markVerticesDirty(size_t first, size_t count)
+    {
+        if (count == 0) return;
+        isDirty = true;
+        boundsDirty = true;
+        version++;
+        vertexDirty.include(first, count);
+    }
+
+    /**
+     * @brief Mark a span of triangles as changed
+     * @param first Index of first modified triangle
+     * @param count Number of modified triangles
+     */
+    void markTrianglesDirty(size_t first, size_t count)
+    {
+        if (count == 0) return;
+        isDirty = true;
+        version++;
+        triangleDirty.include(first, count);
+    }
+
+    /**
+     * @brief Get vertex span changed since last upload
+     */
+    const DirtyRange& getVertexDirtyRange() const { return vertexDirty; }
+
+    /**
+     * @brief Get triangle span changed since last upload
+     */
+    const DirtyRange& getTriangleDirtyRange() const { return triangleDirty; }
     
     /**
-     * @brief Mark mesh as dirty (needs re-upload)
+     * @brief Get local-space axis-aligned bounds
+     * Recomputed on first use after the mesh is marked dirty (not thread-safe
+     * against concurrent modification). Invalid for meshes without vertices.
      */
-    void markDirty() { isDirty = true; }
+    const AABB& getBounds() const
+    {
+        if (boundsDirty) recalculateBounds();
+        return localBounds;
+    }
+
+    /**
+     * @brief Get local-space bounding sphere (centered on the AABB)
+     */
+    const BoundingSphere& getBoundingSphere() const
+    {
+        if (boundsDirty) recalculateBounds();
+        return localSphere;
+    }
+
+    /**
+     * @brief Change counter, incremented whenever vertex or triangle data is marked dirty
+     * Unlike getDirty() it is never reset, so any number of CPU-side caches
+     * (bounds in the spatial index, ray-cast BVHs) can detect edits.
+     */
+    uint64_t getVersion() const { return version; }
+
+    /**
+     * @brief Recompute bounds from the current vertex positions
+     */
+    void recalculateBounds() const
+    {
+        localBounds = AABB();
+        for (const auto& v : vertices)
+            localBounds.expand(v.position);
+
+        localSphere = BoundingSphere();
+        if (localBounds.isValid())
+        {
+            vec3 center = localBounds.getCenter();
+            float maxDistSq = 0.0f;
+            for (const auto& v : vertices)
+                maxDistSq = std::max(maxDistSq, (v.position - center).lengthSquared());
+            localSphere = BoundingSphere(center, std::sqrt(maxDistSq));
+        }
+        boundsDirty = false;
+    }
     
     /**
      * @brief Get buffer usage hint
@@ -88,7 +349,7 @@ public:
         if (usage != newUsage)
         {
             usage = newUsage;
-            isDirty = true;
+            markDirty();
         }
     }
 
@@ -153,6 +414,7 @@ public:
             Triangle(20, 21, 22), Triangle(22, 23, 20)
         };
 
+        mesh->calculateTangents();
         return mesh;
     }
 
@@ -200,6 +462,7 @@ public:
             }
         }
 
+        mesh->calculateTangents();
         return mesh;
     }
 
@@ -242,6 +505,7 @@ public:
             v.vertexColor = color(0.8f, 0.3f, 0.3f);
         }
 
+        mesh->calculateTangents();
         return mesh;
     }
 
@@ -272,7 +536,156 @@ public:
                 v.normal = v.normal.normalized();
         }
         
-        markDirty(); // Normals changed
+        markVerticesDirty(0, vertices.size()); // Normals changed, indices did not
+    }
+
+    /**
+     * @brief Generate per-vertex tangent frames from positions, normals and UVs
+     * 
+     * MikkTSpace-style: each triangle's UV-space tangent and bitangent are
+     * projected onto every corner's normal plane and accumulated with the
+     * corner angle as weight, then Gram-Schmidt orthogonalized against the
+     * vertex normal. The bitangent is stored only as a handedness sign.
+     * Unlike full MikkTSpace, vertices are never split, so a vertex shared
+     * across a UV mirror seam gets a single averaged frame.
+     * 
+     * Faces and vertices are processed in parallel on the JobSystem; results
+     * are deterministic regardless of thread count. Call after changing
+     * normals or UVs.
+     */
+    void calculateTangents()
+    {
+        const size_t vertexCount = vertices.size();
+        const size_t triangleCount = triangles.size();
+        if (vertexCount == 0)
+            return;
+
+        constexpr size_t MIN_BATCH = 4096;
+
+        struct FaceFrame
+        {
+            vec3 tangent;
+            vec3 bitangent;
+            float angle[3];
+            bool valid;
+        };
+        std::vector<FaceFrame> faces(triangleCount);
+
+        // Pass 1: per-face UV gradients and corner angles
+        JobSystem::getInstance().parallelFor(triangleCount, MIN_BATCH,
+            [this, &faces, vertexCount](size_t begin, size_t end) {
+                for (size_t f = begin; f < end; f++)
+                {
+                    const Triangle& tri = triangles[f];
+                    FaceFrame& face = faces[f];
+                    face.valid = false;
+                    if (tri.v0 < 0 || tri.v1 < 0 || tri.v2 < 0 ||
+                        (size_t)tri.v0 >= vertexCount || (size_t)tri.v1 >= vertexCount || (size_t)tri.v2 >= vertexCount)
+                        continue;
+
+                    const Vertex& a = vertices[tri.v0];
+                    const Vertex& b = vertices[tri.v1];
+                    const Vertex& c = vertices[tri.v2];
+
+                    vec3 e1 = b.position - a.position;
+                    vec3 e2 = c.position - a.position;
+                    vec3 e3 = c.position - b.position;
+                    face.angle[0] = cornerAngle(e1, e2);
+                    face.angle[1] = cornerAngle(-e1, e3);
+                    face.angle[2] = cornerAngle(-e2, -e3);
+
+                    float du1 = b.uv.x - a.uv.x, dv1 = b.uv.y - a.uv.y;
+                    float du2 = c.uv.x - a.uv.x, dv2 = c.uv.y - a.uv.y;
+                    float det = du1 * dv2 - du2 * dv1;
+                    if (std::abs(det) < 1e-12f)
+                        continue;  // Degenerate UV mapping
+
+                    // Only directions matter (MikkTSpace normalizes these too),
+                    // so the sign of det decides orientation and its magnitude is dropped
+                    float s = det > 0.0f ? 1.0f : -1.0f;
+                    vec3 t = (e1 * dv2 - e2 * dv1) * s;
+                    vec3 bt = (e2 * du1 - e1 * du2) * s;
+                    if (t.lengthSquared() < 1e-20f || bt.lengthSquared() < 1e-20f)
+                        continue;
+
+                    face.tangent = t.normalized();
+                    face.bitangent = bt.normalized();
+                    face.valid = true;
+                }
+            });
+
+        // Vertex -> (face, corner) adjacency in CSR form so pass 2 needs no atomics
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (size_t f = 0; f < triangleCount; f++)
+        {
+            if (!faces[f].valid) continue;
+            offsets[triangles[f].v0 + 1]++;
+            offsets[triangles[f].v1 + 1]++;
+            offsets[triangles[f].v2 + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++)
+            offsets[v + 1] += offsets[v];
+
+        std::vector<uint32_t> corners(offsets[vertexCount]);
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t f = 0; f < triangleCount; f++)
+        {
+            if (!faces[f].valid) continue;
+            const Triangle& tri = triangles[f];
+            corners[cursor[tri.v0]++] = (uint32_t)(f * 3 + 0);
+            corners[cursor[tri.v1]++] = (uint32_t)(f * 3 + 1);
+            corners[cursor[tri.v2]++] = (uint32_t)(f * 3 + 2);
+        }
+
+        // Pass 2: gather weighted, normal-projected face frames per vertex
+        JobSystem::getInstance().parallelFor(vertexCount, MIN_BATCH,
+            [this, &faces, &offsets, &corners](size_t begin, size_t end) {
+                for (size_t v = begin; v < end; v++)
+                {
+                    Vertex& vert = vertices[v];
+                    vec3 n = vert.normal.lengthSquared() > 1e-12f ? vert.normal.normalized() : vec3::up;
+
+                    vec3 tangentSum = vec3::zero;
+                    vec3 bitangentSum = vec3::zero;
+                    for (uint32_t k = offsets[v]; k < offsets[v + 1]; k++)
+                    {
+                        const FaceFrame& face = faces[corners[k] / 3];
+                        float weight = face.angle[corners[k] % 3];
+                        tangentSum += projectOnPlane(face.tangent, n) * weight;
+                        bitangentSum += projectOnPlane(face.bitangent, n) * weight;
+                    }
+
+                    vec3 t = projectOnPlane(tangentSum, n);
+                    if (t.lengthSquared() < 1e-12f)
+                        t = anyPerpendicular(n);  // No usable UVs touch this vertex
+                    else
+                        t = t.normalized();
+
+                    vert.tangent = t;
+                    vert.tangentSign = vec3::dot(vec3::cross(n, t), bitangentSum) < 0.0f ? -1.0f : 1.0f;
+                }
+            });
+
+        markVerticesDirty(0, vertexCount);
+    }
+
+private:
+    static float cornerAngle(const vec3& a, const vec3& b)
+    {
+        float denom = std::sqrt(a.lengthSquared() * b.lengthSquared());
+        if (denom < 1e-20f) return 0.0f;
+        return std::acos(std::clamp(vec3::dot(a, b) / denom, -1.0f, 1.0f));
+    }
+
+    static vec3 projectOnPlane(const vec3& v, const vec3& n)
+    {
+        return v - n * vec3::dot(n, v);
+    }
+
+    static vec3 anyPerpendicular(const vec3& n)
+    {
+        vec3 axis = std::abs(n.x) < 0.9f ? vec3::right : vec3::up;
+        return projectOnPlane(axis, n).normalized();
     }
 };
 
@@ -0,0 +1,653 @@
+#ifndef MESH_BVH_H
+#define MESH_BVH_H
+
+#include "mesh.h"
+#include "../../Math/vec3.h"
+#include "../../Math/bounds.h"
+#include "../../Math/simd.h"
+#include "../../Core/Systems/jobSystem.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class MeshBVH
+ * @brief Static triangle BVH over one mesh for CPU ray casts
+ *
+ * Built top-down with a binned surface area heuristic. Every leaf holds
+ * at most four triangles, stored as one SoA packet (first vertex and two
+ * edges) so a leaf is tested with a single 4-wide Moller-Trumbore pass.
+ * Traversal visits the nearer child first and skips boxes beyond the
+ * closest hit so far.
+ *
+ * Works in the mesh's local space; callers transform the ray into it.
+ */
+class MeshBVH
+{
+public:
+    /**
+     * @brief Closest intersection found by intersect()
+     */
+    struct Hit
+    {
+        float distance;   // Ray parameter t
+        int triangle;     // Index into Mesh::triangles
+        float u, v;       // Barycentrics of v1 and v2 (v0 weight is 1 - u - v)
+    };
+
+    MeshBVH() = default;
+
+    explicit MeshBVH(const Mesh& mesh) { build(mesh); }
+
+    /**
+     * @brief (Re)build from the mesh's current vertices and triangles
+     */
+    void build(const Mesh& mesh)
+    {
+        nodes.clear();
+        packets.clear();
+
+        const size_t triangleCount = mesh.triangles.size();
+        if (triangleCount == 0)
+            return;
+
+        // Per-triangle bounds and centroids
+        std::vector<BuildTriangle> buildTris(triangleCount);
+        const Vertex* verts = mesh.vertices.data();
+        const Triangle* tris = mesh.triangles.data();
+        JobSystem::getInstance().parallelFor(triangleCount, 16384, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                const vec3& a = verts[tris[i].v0].position;
+                const vec3& b = verts[tris[i].v1].position;
+                const vec3& c = verts[tris[i].v2].position;
+                vec3 lo(std::min({ a.x, b.x, c.x }), std::min({ a.y, b.y, c.y }), std::min({ a.z, b.z, c.z }));
+                vec3 hi(std::max({ a.x, b.x, c.x }), std::max({ a.y, b.y, c.y }), std::max({ a.z, b.z, c.z }));
+                BuildTriangle& t = buildTris[i];
+                t.boxMin[0] = lo.x; t.boxMin[1] = lo.y; t.boxMin[2] = lo.z;
+                t.boxMax[0] = hi.x; t.boxMax[1] = hi.y; t.boxMax[2] = hi.z;
+                t.centroid[0] = (lo.x + hi.x) * 0.5f;
+                t.centroid[1] = (lo.y + hi.y) * 0.5f;
+                t.centroid[2] = (lo.z + hi.z) * 0.5f;
+                t.index = static_cast<int>(i);
+            }
+        });
+
+        // Split the big ranges here, then build the remaining subtrees in parallel
+        size_t subtreeSize = std::max<size_t>(MIN_PARALLEL_SUBTREE,
+            triangleCount / (JobSystem::getInstance().getThreadCount() * 4));
+        std::vector<BuildTask> pending;
+        std::vector<BuildTask> tasks;
+        nodes.emplace_back();
+        tasks.push_back({ 0, 0, triangleCount, 0 });
+
+        while (!tasks.empty())
+        {
+            BuildTask task = tasks.back();
+            tasks.pop_back();
+            if (task.end - task.begin <= subtreeSize)
+            {
+                pending.push_back(task);
+                continue;
+            }
+
+            size_t mid = splitRange(buildTris.data(), task, nodes[task.node].box);
+            uint32_t left = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back();
+            nodes.emplace_back();
+            nodes[task.node].first = left;
+            tasks.push_back({ left + 1, mid, task.end, task.depth + 1 });
+            tasks.push_back({ left, task.begin, mid, task.depth + 1 });
+        }
+
+        std::vector<Subtree> subtrees(pending.size());
+        JobSystem::getInstance().parallelFor(pending.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                buildSubtree(buildTris.data(), pending[i], mesh, subtrees[i]);
+        });
+
+        // Stitch: each subtree's root replaces its placeholder, the rest is appended
+        size_t totalNodes = nodes.size(), totalPackets = 0;
+        for (const auto& subtree : subtrees)
+        {
+            totalNodes += subtree.nodes.size() - 1;
+            totalPackets += subtree.packets.size();
+        }
+        nodes.reserve(totalNodes);
+        packets.reserve(totalPackets);
+
+        for (size_t i = 0; i < subtrees.size(); i++)
+        {
+            const Subtree& subtree = subtrees[i];
+            uint32_t nodeBase = static_cast<uint32_t>(nodes.size()) - 1;  // Local index 1 lands at size()
+            uint32_t packetBase = static_cast<uint32_t>(packets.size());
+            for (size_t k = 0; k < subtree.nodes.size(); k++)
+            {
+                Node node = subtree.nodes[k];
+                node.first += node.count > 0 ? packetBase : nodeBase;
+                if (k == 0)
+                    nodes[pending[i].node] = node;
+                else
+                    nodes.push_back(node);
+            }
+            packets.insert(packets.end(), subtree.packets.begin(), subtree.packets.end());
+        }
+    }
+
+    bool empty() const { return nodes.empty(); }
+    size_t getNodeCount() const { return nodes.size(); }
+
+    /**
+     * @brief Approximate heap memory held by the tree
+     */
+    size_t getByteSize() const
+    {
+        return nodes.capacity() * sizeof(Node) + packets.capacity() * sizeof(TrianglePacket);
+    }
+
+    /**
+     * @brief Closest triangle hit along a ray (both faces count)
+     * @param ray Ray in mesh space (t is measured in units of ray.direction)
+     * @param maxDistance Ignore hits beyond this t
+     * @param hit Receives the closest hit
+     * @return true if anything was hit
+     */
+    bool intersect(const Ray& ray, float maxDistance, Hit& hit) const
+    {
+        if (nodes.empty())
+            return false;
+
+        vec3 invDirection = ray.inverseDirection();
+        float entry;
+        if (!nodes[0].box.intersectRay(ray.origin, invDirection, maxDistance, entry))
+            return false;
+
+        const float4 ox(ray.origin.x), oy(ray.origin.y), oz(ray.origin.z);
+        const float4 dx(ray.direction.x), dy(ray.direction.y), dz(ray.direction.z);
+
+        bool found = false;
+        uint32_t stack[MAX_DEPTH];
+        int stackSize = 0;
+        uint32_t current = 0;
+
+        while (true)
+        {
+            const Node& node = nodes[current];
+            if (node.count > 0)
+            {
+                if (intersectPacket(packets[node.first], ox, oy, oz, dx, dy, dz, maxDistance, hit))
+                {
+                    maxDistance = hit.distance;
+                    found = true;
+                }
+            }
+            else
+            {
+                uint32_t nearChild = node.first;
+                uint32_t farChild = node.first + 1;
+                float entryNear, entryFar;
+                bool hitNear = nodes[nearChild].box.intersectRay(ray.origin, invDirection, maxDistance, entryNear);
+                bool hitFar = nodes[farChild].box.intersectRay(ray.origin, invDirection, maxDistance, entryFar);
+                if (hitNear && hitFar)
+                {
+                    if (entryFar < entryNear)
+                        std::swap(nearChild, farChild);
+                    stack[stackSize++] = farChild;
+                    current = nearChild;
+                    continue;
+                }
+                if (hitNear || hitFar)
+                {
+                    current = hitNear ? nearChild : farChild;
+                    continue;
+                }
+            }
+
+            if (stackSize == 0)
+                break;
+            current = stack[--stackSize];
+        }
+
+        return found;
+    }
+
+private:
+    static constexpr size_t LEAF_SIZE = 4;  // One SIMD packet per leaf
+    static constexpr int BIN_COUNT = 16;
+    static constexpr uint32_t MAX_SAH_DEPTH = 64;  // Deeper splits use the median, bounding the depth
+    static constexpr uint32_t MAX_DEPTH = 128;     // Traversal stack size (64 + log2 of any triangle count)
+    static constexpr size_t MIN_PARALLEL_SUBTREE = 16384;  // Triangles per independently built subtree
+
+    /**
+     * @brief Node: internal nodes point at two adjacent children, leaves at one packet
+     */
+    struct Node
+    {
+        AABB box;
+        uint32_t first = 0;  // Left child index, or packet index for leaves
+        uint32_t count = 0;  // Triangles in the leaf (0 = internal node)
+    };
+
+    /**
+     * @brief Up to four triangles as first vertex + edges, one lane each
+     * Unused lanes have zero edges and can never be hit.
+     */
+    struct TrianglePacket
+    {
+        alignas(16) float v0x[4], v0y[4], v0z[4];
+        alignas(16) float e1x[4], e1y[4], e1z[4];
+        alignas(16) float e2x[4], e2y[4], e2z[4];
+        int index[4];
+    };
+
+    struct BuildTriangle
+    {
+        float boxMin[3], boxMax[3];
+        float centroid[3];
+        int index;
+    };
+
+    /**
+     * @brief SAH bin: bounds and triangle count
+     */
+    struct Bin
+    {
+        float boxMin[3], boxMax[3];
+        size_t count;
+
+        void reset()
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                boxMin[axis] = FLT_MAX;
+                boxMax[axis] = -FLT_MAX;
+            }
+            count = 0;
+        }
+
+        void add(const BuildTriangle& t)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                boxMin[axis] = std::min(boxMin[axis], t.boxMin[axis]);
+                boxMax[axis] = std::max(boxMax[axis], t.boxMax[axis]);
+            }
+            count++;
+        }
+
+        void merge(const Bin& other)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                boxMin[axis] = std::min(boxMin[axis], other.boxMin[axis]);
+                boxMax[axis] = std::max(boxMax[axis], other.boxMax[axis]);
+            }
+            count += other.count;
+        }
+
+        float area() const
+        {
+            if (count == 0) return 0.0f;
+            float dx = boxMax[0] - boxMin[0], dy = boxMax[1] - boxMin[1], dz = boxMax[2] - boxMin[2];
+            return 2.0f * (dx * dy + dy * dz + dz * dx);
+        }
+    };
+
+    struct BuildTask
+    {
+        uint32_t node;
+        size_t begin, end;
+        uint32_t depth;
+    };
+
+    struct Subtree
+    {
+        std::vector<Node> nodes;  // Root at index 0
+        std::vector<TrianglePacket> packets;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<TrianglePacket> packets;
+
+    /**
+     * @brief Build one subtree into its own arrays (runs on a worker thread)
+     */
+    static void buildSubtree(BuildTriangle* tris, const BuildTask& rootTask, const Mesh& mesh, Subtree& out)
+    {
+        size_t count = rootTask.end - rootTask.begin;
+        out.nodes.reserve(count / 2 + 1);
+        out.packets.reserve(count / 3 + 1);
+        out.nodes.emplace_back();
+
+        std::vector<BuildTask> tasks;
+        tasks.push_back({ 0, rootTask.begin, rootTask.end, rootTask.depth });
+        while (!tasks.empty())
+        {
+            BuildTask task = tasks.back();
+            tasks.pop_back();
+
+            size_t mid = splitRange(tris, task, out.nodes[task.node].box);
+            if (mid == task.end)
+            {
+                out.nodes[task.node].first = static_cast<uint32_t>(out.packets.size());
+                out.nodes[task.node].count = static_cast<uint32_t>(task.end - task.begin);
+                out.packets.push_back(makePacket(tris + task.begin, task.end - task.begin, mesh));
+                continue;
+            }
+
+            uint32_t left = static_cast<uint32_t>(out.nodes.size());
+            out.nodes.emplace_back();
+            out.nodes.emplace_back();
+            out.nodes[task.node].first = left;
+            tasks.push_back({ left + 1, mid, task.end, task.depth + 1 });
+            tasks.push_back({ left, task.begin, mid, task.depth + 1 });
+        }
+    }
+
+    static TrianglePacket makePacket(const BuildTriangle* tris, size_t count, const Mesh& mesh)
+    {
+        TrianglePacket packet = {};
+        for (size_t k = 0; k < LEAF_SIZE; k++)
+        {
+            if (k >= count)
+            {
+                packet.index[k] = -1;
+                continue;
+            }
+            const Triangle& tri = mesh.triangles[tris[k].index];
+            vec3 p0 = mesh.vertices[tri.v0].position;
+            vec3 e1 = mesh.vertices[tri.v1].position - p0;
+            vec3 e2 = mesh.vertices[tri.v2].position - p0;
+            packet.v0x[k] = p0.x; packet.v0y[k] = p0.y; packet.v0z[k] = p0.z;
+            packet.e1x[k] = e1.x; packet.e1y[k] = e1.y; packet.e1z[k] = e1.z;
+            packet.e2x[k] = e2.x; packet.e2y[k] = e2.y; packet.e2z[k] = e2.z;
+            packet.index[k] = tris[k].index;
+        }
+        return packet;
+    }
+
+    /**
+     * @brief Compute a range's bounds and split it at the cheapest SAH bin boundary
+     * Falls back to a median split when the centroids can't be separated
+     * or the tree is already MAX_SAH_DEPTH deep.
+     * @param box Receives the bounds of the whole range
+     * @return First index of the right half, or task.end if the range fits a leaf
+     */
+    static size_t splitRange(BuildTriangle* tris, const BuildTask& task, AABB& box)
+    {
+        const size_t begin = task.begin;
+        const size_t end = task.end;
+        const size_t count = end - begin;
+
+        float boxMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, boxMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        float centroidMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, centroidMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (size_t i = begin; i < end; i++)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                boxMin[axis] = std::min(boxMin[axis], tris[i].boxMin[axis]);
+                boxMax[axis] = std::max(boxMax[axis], tris[i].boxMax[axis]);
+                centroidMin[axis] = std::min(centroidMin[axis], tris[i].centroid[axis]);
+                centroidMax[axis] = std::max(centroidMax[axis], tris[i].centroid[axis]);
+            }
+        }
+        box = AABB(vec3(boxMin[0], boxMin[1], boxMin[2]), vec3(boxMax[0], boxMax[1], boxMax[2]));
+        if (count <= LEAF_SIZE)
+            return end;
+
+        // Few triangles don't need many bins
+        const int binCount = static_cast<int>(std::min<size_t>(BIN_COUNT, count));
+        float binScale[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float extent = centroidMax[axis] - centroidMin[axis];
+            binScale[axis] = extent > 0.0f ? binCount / extent : 0.0f;
+        }
+        auto binOf = [&](const BuildTriangle& t, int axis) {
+            return std::min(binCount - 1, static_cast<int>((t.centroid[axis] - centroidMin[axis]) * binScale[axis]));
+        };
+
+        float bestCost = FLT_MAX;
+        int bestAxis = -1;
+        int bestSplit = 0;
+
+        if (task.depth < MAX_SAH_DEPTH)
+        {
+            // Bin all three axes in one pass over the triangles
+            Bin bins[3][BIN_COUNT];
+            for (int axis = 0; axis < 3; axis++)
+                for (int b = 0; b < binCount; b++)
+                    bins[axis][b].reset();
+
+            for (size_t i = begin; i < end; i++)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                    bins[axis][binOf(tris[i], axis)].add(tris[i]);
+            }
+
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (binScale[axis] == 0.0f)
+                    continue;
+
+                // Sweep from the right to get suffix areas, then from the left
+                float rightArea[BIN_COUNT];
+                size_t rightCount[BIN_COUNT];
+                Bin running;
+                running.reset();
+                for (int b = binCount - 1; b > 0; b--)
+                {
+                    running.merge(bins[axis][b]);
+                    rightArea[b] = running.area();
+                    rightCount[b] = running.count;
+                }
+
+                running.reset();
+                for (int b = 0; b < binCount - 1; b++)
+                {
+                    running.merge(bins[axis][b]);
+                    if (running.count == 0 || rightCount[b + 1] == 0)
+                        continue;
+                    float cost = running.area() * running.count + rightArea[b + 1] * rightCount[b + 1];
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = b + 1;
+                    }
+                }
+            }
+        }
+
+        if (bestAxis >= 0)
+        {
+            BuildTriangle* mid = std::partition(tris + begin, tris + end, [&](const BuildTriangle& t) {
+                return binOf(t, bestAxis) < bestSplit;
+            });
+            size_t split = static_cast<size_t>(mid - tris);
+            if (split > begin && split < end)
+                return split;
+        }
+
+        // Centroids coincide, binning failed, or the tree is too deep: split in the middle
+        int axis = 0;
+        for (int a = 1; a < 3; a++)
+        {
+            if (centroidMax[a] - centroidMin[a] > centroidMax[axis] - centroidMin[axis])
+                axis = a;
+        }
+        size_t mid = begin + count / 2;
+        std::nth_element(tris + begin, tris + mid, tris + end, [axis](const BuildTriangle& a, const BuildTriangle& b) {
+            return a.centroid[axis] < b.centroid[axis];
+        });
+        return mid;
+    }
+
+    /**
+     * @brief 4-wide Moller-Trumbore against one packet
+     * @return true if a lane is hit closer than maxDistance (hit is updated)
+     */
+    static bool intersectPacket(const TrianglePacket& p,
+                                const float4& ox, const float4& oy, const float4& oz,
+                                const float4& dx, const float4& dy, const float4& dz,
+                                float maxDistance, Hit& hit)
+    {
+        const float4 zero(0.0f);
+        const float4 one(1.0f);
+
+        float4 e1x = float4::load(p.e1x), e1y = float4::load(p.e1y), e1z = float4::load(p.e1z);
+        float4 e2x = float4::load(p.e2x), e2y = float4::load(p.e2y), e2z = float4::load(p.e2z);
+
+        // pvec = dir x e2, det = e1 . pvec
+        float4 px = dy * e2z - dz * e2y;
+        float4 py = dz * e2x - dx * e2z;
+        float4 pz = dx * e2y - dy * e2x;
+        float4 det = e1x * px + e1y * py + e1z * pz;
+        float4 invDet = one / det;
+
+        float4 tx = ox - float4::load(p.v0x);
+        float4 ty = oy - float4::load(p.v0y);
+        float4 tz = oz - float4::load(p.v0z);
+        float4 u = (tx * px + ty * py + tz * pz) * invDet;
+
+        // qvec = tvec x e1
+        float4 qx = ty * e1z - tz * e1y;
+        float4 qy = tz * e1x - tx * e1z;
+        float4 qz = tx * e1y - ty * e1x;
+        float4 v = (dx * qx + dy * qy + dz * qz) * invDet;
+        float4 t = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+
+        float4 valid = (float4::abs(det) > float4(1e-20f)) & (u >= zero) & (v >= zero) &
+                       (u + v <= one) & (t >= zero) & (t < float4(maxDistance));
+        int bits = float4::mask(valid);
+        if (!bits)
+            return false;
+
+        alignas(16) float ts[4], us[4], vs[4];
+        t.store(ts);
+        u.store(us);
+        v.store(vs);
+
+        int best = -1;
+        float bestT = maxDistance;
+        for (int k = 0; k < 4; k++)
+        {
+            if ((bits & (1 << k)) && ts[k] < bestT)
+            {
+                bestT = ts[k];
+                best = k;
+            }
+        }
+        if (best < 0)
+            return false;
+
+        hit.distance = bestT;
+        hit.triangle = p.index[best];
+        hit.u = us[best];
+        hit.v = vs[best];
+        return true;
+    }
+};
+
+/**
+ * @class MeshBVHCache
+ * @brief Shared MeshBVHs keyed by Mesh ID, rebuilt when the mesh changes
+ *
+ * A tree is built on first request and kept until the mesh's version
+ * moves (see Mesh::getVersion) or the mesh is destroyed. Safe to call
+ * from any thread; a returned tree stays valid while it is held, even
+ * if the cache replaces it.
+ */
+class MeshBVHCache
+{
+public:
+    static MeshBVHCache& getInstance()
+    {
+        static MeshBVHCache instance;
+        return instance;
+    }
+
+    /**
+     * @brief Get the tree for a mesh, building it if missing or stale
+     */
+    std::shared_ptr<const MeshBVH> get(const Mesh& mesh)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(mesh.getID());
+            if (it != entries.end() && it->second.version == mesh.getVersion())
+                return it->second.bvh;
+        }
+
+        // Build outside the lock so other meshes can be served meanwhile
+        uint64_t version = mesh.getVersion();
+        auto bvh = std::make_shared<const MeshBVH>(mesh);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry& entry = entries[mesh.getID()];
+        entry.bvh = bvh;
+        entry.version = version;
+        return bvh;
+    }
+
+    /**
+     * @brief Drop the cached tree for one mesh
+     */
+    void invalidate(uint64_t meshID)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.erase(meshID);
+    }
+
+    /**
+     * @brief Drop every cached tree
+     */
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+    }
+
+    /**
+     * @brief Approximate memory held by all cached trees
+     */
+    size_t getByteSize()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t total = 0;
+        for (const auto& entry : entries)
+            total += entry.second.bvh->getByteSize();
+        return total;
+    }
+
+    // Non-copyable
+    MeshBVHCache(const MeshBVHCache&) = delete;
+    MeshBVHCache& operator=(const MeshBVHCache&) = delete;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<const MeshBVH> bvh;
+        uint64_t version = 0;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<uint64_t, Entry> entries;
+    size_t destroyListener;
+
+    MeshBVHCache()
+    {
+        destroyListener = Mesh::addDestroyListener([this](uint64_t meshID) { invalidate(meshID); });
+    }
+
+    ~MeshBVHCache()
+    {
+        Mesh::removeDestroyListener(destroyListener);
+    }
+};
+
+#endif // MESH_BVH_H
@@ -0,0 +1,516 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include "mesh.h"
+#include "../../Math/vec3.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class MeshSimplifier
+ * @brief Quadric error mesh simplification and LOD chain generation
+ *
+ * Uses half-edge collapses (a vertex moves onto a neighbor), so the
+ * output only contains original vertices and their normals, UVs, colors
+ * and tangents survive unchanged. Costs combine the Garland-Heckbert
+ * position quadric with the attribute change each collapse causes, which
+ * keeps UV seams, hard edges and color borders in place. Vertices on open
+ * borders can be locked so silhouettes of open meshes don't shrink.
+ *
+ * Example:
+ * @code
+ * auto lods = MeshSimplifier::buildLODChain(highPolyMesh, 4);
+ * meshRenderer->setLODs(lods);
+ * @endcode
+ */
+class MeshSimplifier
+{
+public:
+    struct Options
+    {
+        float targetError;   // Stop once the error exceeds this fraction of the mesh radius
+        float normalWeight;  // Cost of bending normals (relative)
+        float uvWeight;      // Cost of stretching texture coordinates (relative)
+        float colorWeight;   // Cost of changing vertex colors (relative)
+        bool lockBorders;    // Keep vertices on open edges in place
+
+        Options() : targetError(FLT_MAX), normalWeight(1.0f), uvWeight(1.0f), colorWeight(0.5f), lockBorders(true) {}
+    };
+
+    /**
+     * @brief Simplify a mesh down to (at most) a triangle budget
+     * @param mesh Source mesh
+     * @param targetTriangles Desired triangle count
+     * @param options Error limit and attribute weights
+     * @return New mesh (same usage hint); may keep more triangles than asked
+     *         if the error limit or topology stops the collapse early
+     */
+    static std::shared_ptr<Mesh> simplify(const Mesh& mesh, size_t targetTriangles, const Options& options = Options())
+    {
+        Simplifier simplifier(mesh, options);
+        simplifier.run(targetTriangles);
+        return simplifier.extract();
+    }
+
+    /**
+     * @brief Build a LOD chain, each level simplified from the previous one
+     * @param mesh Full-detail mesh (returned as level 0)
+     * @param levelCount Maximum number of levels including level 0
+     * @param reduction Triangle ratio between consecutive levels
+     * @param minTriangles Stop before going below this many triangles
+     * @return Levels from finest to coarsest (ends early once a level stops shrinking)
+     */
+    static std::vector<std::shared_ptr<Mesh>> buildLODChain(const std::shared_ptr<Mesh>& mesh, int levelCount = 4,
+                                                           float reduction = 0.5f, size_t minTriangles = 32,
+                                                           const Options& options = Options())
+    {
+        std::vector<std::shared_ptr<Mesh>> levels;
+        if (!mesh)
+            return levels;
+
+        levels.push_back(mesh);
+        for (int i = 1; i < levelCount; i++)
+        {
+            const Mesh& previous = *levels.back();
+            size_t target = static_cast<size_t>(previous.triangles.size() * reduction);
+            if (target < minTriangles)
+                break;
+
+            auto next = simplify(previous, target, options);
+            if (next->triangles.size() > previous.triangles.size() * 0.9f)
+                break;  // Barely shrank: further levels would be wasted memory
+            levels.push_back(next);
+        }
+        return levels;
+    }
+
+private:
+    /**
+     * @brief Symmetric 4x4 plane quadric (10 unique terms)
+     */
+    struct Quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+        static Quadric fromPlane(double a, double b, double c, double d, double weight)
+        {
+            Quadric q;
+            q.a2 = weight * a * a; q.ab = weight * a * b; q.ac = weight * a * c; q.ad = weight * a * d;
+            q.b2 = weight * b * b; q.bc = weight * b * c; q.bd = weight * b * d;
+            q.c2 = weight * c * c; q.cd = weight * c * d;
+            q.d2 = weight * d * d;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& o)
+        {
+            a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad; b2 += o.b2;
+            bc += o.bc; bd += o.bd; c2 += o.c2; cd += o.cd; d2 += o.d2;
+            return *this;
+        }
+
+        double evaluate(const vec3& p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+            double r = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                     + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                     + c2 * z * z + 2 * cd * z
+                     + d2;
+            return std::max(r, 0.0);
+        }
+    };
+
+    struct Collapse
+    {
+        double cost;
+        int from, to;          // Position vertices (from is removed)
+        uint32_t stampFrom, stampTo;
+
+        bool operator>(const Collapse& o) const { return cost > o.cost; }
+    };
+
+    /**
+     * @brief Working state for one simplification run
+     *
+     * Original vertices that share a position are welded into one
+     * "position vertex"; the originals become its wedges (one per side of
+     * a seam). Collapses move position vertices, and each triangle corner
+     * is re-pointed at the destination wedge with the closest attributes.
+     */
+    class Simplifier
+    {
+    public:
+        Simplifier(const Mesh& source, const Options& opts)
+            : mesh(source), options(opts), liveTriangles(0)
+        {
+            weldPositions();
+            buildTopology();
+            float radius = mesh.getBoundingSphere().isValid() ? mesh.getBoundingSphere().radius : 1.0f;
+            radiusSq = std::max(radius * radius, 1e-12f);
+
+            // Attribute costs are expressed as equivalent squared displacements:
+            // a 90 degree normal change or a 0.1 UV shift ~ moving 5% of the radius
+            normalScale = 0.00125 * options.normalWeight * radiusSq;
+            uvScale = 0.25 * options.uvWeight * radiusSq;
+            colorScale = 0.0025 * options.colorWeight * radiusSq;
+            maxCost = options.targetError < FLT_MAX
+                ? static_cast<double>(options.targetError) * options.targetError * radiusSq
+                : DBL_MAX;
+        }
+
+        void run(size_t targetTriangles)
+        {
+            for (size_t t = 0; t < triangles.size(); t++)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    int a = positionOf[triangles[t].v[k]];
+                    int b = positionOf[triangles[t].v[(k + 1) % 3]];
+                    pushCollapse(a, b);
+                    pushCollapse(b, a);
+                }
+            }
+
+            while (liveTriangles > targetTriangles && !heap.empty())
+            {
+                Collapse c = heap.top();
+                heap.pop();
+                if (!alive[c.from] || !alive[c.to] ||
+                    stamp[c.from] != c.stampFrom || stamp[c.to] != c.stampTo)
+                    continue;
+                if (c.cost > maxCost)
+                    break;
+                if (!isCollapseValid(c.from, c.to))
+                    continue;
+                applyCollapse(c.from, c.to);
+            }
+        }
+
+        std::shared_ptr<Mesh> extract() const
+        {
+            auto result = std::make_shared<Mesh>(mesh.getUsage());
+            std::vector<int> remap(mesh.vertices.size(), -1);
+            result->triangles.reserve(liveTriangles);
+            for (const auto& tri : triangles)
+            {
+                if (!tri.alive)
+                    continue;
+                int corners[3];
+                for (int k = 0; k < 3; k++)
+                {
+                    int original = tri.v[k];
+                    if (remap[original] < 0)
+                    {
+                        remap[original] = static_cast<int>(result->vertices.size());
+                        result->vertices.push_back(mesh.vertices[original]);
+                    }
+                    corners[k] = remap[original];
+                }
+                result->triangles.emplace_back(corners[0], corners[1], corners[2]);
+            }
+            return result;
+        }
+
+    private:
+        struct WorkTriangle
+        {
+            int v[3];     // Original vertex indices
+            vec3 normal;  // Unit normal of the source triangle
+            bool alive;
+        };
+
+        const Mesh& mesh;
+        Options options;
+        double radiusSq, normalScale, uvScale, colorScale, maxCost;
+
+        std::vector<int> positionOf;                 // Original vertex -> position vertex
+        std::vector<vec3> positions;                 // Per position vertex
+        std::vector<std::vector<int>> wedges;        // Position vertex -> original vertices
+        std::vector<std::vector<int>> vertexTriangles;  // Position vertex -> triangles (may hold dead ones)
+        std::vector<Quadric> quadrics;
+        std::vector<double> areas;                   // Area of the triangles merged into each vertex
+        std::vector<bool> alive;
+        std::vector<bool> locked;
+        std::vector<uint32_t> stamp;                 // Bumped when a vertex's neighborhood changes
+        std::vector<WorkTriangle> triangles;
+        size_t liveTriangles;
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+        std::vector<int> scratch;
+
+        void weldPositions()
+        {
+            struct Key
+            {
+                uint32_t x, y, z;
+                bool operator==(const Key& o) const { return x == o.x && y == o.y && z == o.z; }
+            };
+            struct KeyHash
+            {
+                size_t operator()(const Key& k) const
+                {
+                    return (k.x * 73856093u) ^ (k.y * 19349663u) ^ (k.z * 83492791u);
+                }
+            };
+
+            std::unordered_map<Key, int, KeyHash> lookup;
+            lookup.reserve(mesh.vertices.size());
+            positionOf.resize(mesh.vertices.size());
+            for (size_t i = 0; i < mesh.vertices.size(); i++)
+            {
+                const vec3& p = mesh.vertices[i].position;
+                Key key;
+                std::memcpy(&key.x, &p.x, sizeof(float));
+                std::memcpy(&key.y, &p.y, sizeof(float));
+                std::memcpy(&key.z, &p.z, sizeof(float));
+                auto [it, inserted] = lookup.emplace(key, static_cast<int>(positions.size()));
+                if (inserted)
+                {
+                    positions.push_back(p);
+                    wedges.emplace_back();
+                }
+                positionOf[i] = it->second;
+                wedges[it->second].push_back(static_cast<int>(i));
+            }
+        }
+
+        void buildTopology()
+        {
+            size_t count = positions.size();
+            vertexTriangles.resize(count);
+            quadrics.resize(count);
+            areas.assign(count, 0.0);
+            alive.assign(count, true);
+            locked.assign(count, false);
+            stamp.assign(count, 0);
+
+            // Count uses of each undirected edge to find borders and non-manifold edges
+            std::unordered_map<uint64_t, int> edgeUses;
+            edgeUses.reserve(mesh.triangles.size() * 2);
+            auto edgeKey = [](int a, int b) {
+                return (static_cast<uint64_t>(std::min(a, b)) << 32) | static_cast<uint32_t>(std::max(a, b));
+            };
+
+            triangles.reserve(mesh.triangles.size());
+            for (const auto& tri : mesh.triangles)
+            {
+                WorkTriangle work{ { tri.v0, tri.v1, tri.v2 }, vec3::zero, true };
+                int p[3] = { positionOf[tri.v0], positionOf[tri.v1], positionOf[tri.v2] };
+                if (p[0] == p[1] || p[1] == p[2] || p[0] == p[2])
+                    continue;  // Degenerate after welding
+
+                vec3 e1 = positions[p[1]] - positions[p[0]];
+                vec3 e2 = positions[p[2]] - positions[p[0]];
+                vec3 n = vec3::cross(e1, e2);
+                double length = n.length();
+                double area = 0.5 * length;
+                if (length > 0.0)
+                {
+                    work.normal = n / static_cast<float>(length);
+                    double a = n.x / length, b = n.y / length, c = n.z / length;
+                    double d = -(a * positions[p[0]].x + b * positions[p[0]].y + c * positions[p[0]].z);
+                    Quadric q = Quadric::fromPlane(a, b, c, d, area);
+                    for (int k = 0; k < 3; k++)
+                    {
+                        quadrics[p[k]] += q;
+                        areas[p[k]] += area;
+                    }
+                }
+
+                int index = static_cast<int>(triangles.size());
+                triangles.push_back(work);
+                for (int k = 0; k < 3; k++)
+                {
+                    vertexTriangles[p[k]].push_back(index);
+                    edgeUses[edgeKey(p[k], p[(k + 1) % 3])]++;
+                }
+            }
+            liveTriangles = triangles.size();
+
+            for (const auto& entry : edgeUses)
+            {
+                bool border = entry.second == 1;
+                bool nonManifold = entry.second > 2;
+                if (nonManifold || (border && options.lockBorders))
+                {
+                    locked[static_cast<int>(entry.first >> 32)] = true;
+                    locked[static_cast<int>(entry.first & 0xFFFFFFFFu)] = true;
+                }
+            }
+        }
+
+        double attributeDistance(int a, int b) const
+        {
+            const Vertex& va = mesh.vertices[a];
+            const Vertex& vb = mesh.vertices[b];
+            double dn = (va.normal - vb.normal).lengthSquared();
+            double du = va.uv.x - vb.uv.x, dv = va.uv.y - vb.uv.y;
+            double dc = (va.vertexColor - vb.vertexColor).lengthSquared();
+            return normalScale * dn + uvScale * (du * du + dv * dv) + colorScale * dc;
+        }
+
+        /**
+         * @brief Wedge of `to` whose attributes best replace an original vertex
+         */
+        int closestWedge(int original, int to, double& distance) const
+        {
+            int best = wedges[to][0];
+            distance = DBL_MAX;
+            for (int candidate : wedges[to])
+            {
+                double d = attributeDistance(original, candidate);
+                if (d < distance)
+                {
+                    distance = d;
+                    best = candidate;
+                }
+            }
+            return best;
+        }
+
+        double collapseCost(int from, int to) const
+        {
+            Quadric q = quadrics[from];
+            q += quadrics[to];
+            double cost = q.evaluate(positions[to]);
+
+            // Attribute error of every wedge that gets re-pointed, weighted by the area it covered
+            double attribute = 0.0;
+            for (int wedge : wedges[from])
+            {
+                double d;
+                closestWedge(wedge, to, d);
+                attribute = std::max(attribute, d);
+            }
+            return cost + attribute * areas[from];
+        }
+
+        void pushCollapse(int from, int to)
+        {
+            if (locked[from] || from == to)
+                return;
+            heap.push({ collapseCost(from, to), from, to, stamp[from], stamp[to] });
+        }
+
+        void gatherNeighbors(int vertex, std::vector<int>& out) const
+        {
+            out.clear();
+            for (int t : vertexTriangles[vertex])
+            {
+                if (!triangles[t].alive)
+                    continue;
+                for (int k = 0; k < 3; k++)
+                {
+                    int p = positionOf[triangles[t].v[k]];
+                    if (p != vertex && std::find(out.begin(), out.end(), p) == out.end())
+                        out.push_back(p);
+                }
+            }
+        }
+
+        bool containsPosition(const WorkTriangle& tri, int p) const
+        {
+            return positionOf[tri.v[0]] == p || positionOf[tri.v[1]] == p || positionOf[tri.v[2]] == p;
+        }
+
+        bool isCollapseValid(int from, int to)
+        {
+            // Link condition: shared neighbors must be exactly the triangles on the edge
+            int edgeTriangles = 0;
+            for (int t : vertexTriangles[from])
+            {
+                if (triangles[t].alive && containsPosition(triangles[t], to))
+                    edgeTriangles++;
+            }
+            if (edgeTriangles == 0)
+                return false;
+
+            std::vector<int> neighborsFrom;
+            gatherNeighbors(from, neighborsFrom);
+            gatherNeighbors(to, scratch);
+            int shared = 0;
+            for (int p : neighborsFrom)
+            {
+                if (std::find(scratch.begin(), scratch.end(), p) != scratch.end())
+                    shared++;
+            }
+            if (shared != edgeTriangles)
+                return false;
+
+            // Reject collapses that flip or squash a remaining triangle, either relative
+            // to its current shape or to the source surface (small turns add up)
+            for (int t : vertexTriangles[from])
+            {
+                const WorkTriangle& tri = triangles[t];
+                if (!tri.alive || containsPosition(tri, to))
+                    continue;
+
+                vec3 before[3], after[3];
+                for (int k = 0; k < 3; k++)
+                {
+                    int p = positionOf[tri.v[k]];
+                    before[k] = positions[p];
+                    after[k] = p == from ? positions[to] : positions[p];
+                }
+                vec3 n0 = vec3::cross(before[1] - before[0], before[2] - before[0]);
+                vec3 n1 = vec3::cross(after[1] - after[0], after[2] - after[0]);
+                float len0 = n0.length(), len1 = n1.length();
+                if (len1 <= 1e-12f * radiusSq || vec3::dot(n0, n1) <= 0.2f * len0 * len1 ||
+                    vec3::dot(tri.normal, n1) <= 0.0f)
+                    return false;
+            }
+            return true;
+        }
+
+        void applyCollapse(int from, int to)
+        {
+            for (int t : vertexTriangles[from])
+            {
+                WorkTriangle& tri = triangles[t];
+                if (!tri.alive)
+                    continue;
+                if (containsPosition(tri, to))
+                {
+                    tri.alive = false;
+                    liveTriangles--;
+                    continue;
+                }
+                for (int k = 0; k < 3; k++)
+                {
+                    if (positionOf[tri.v[k]] == from)
+                    {
+                        double d;
+                        tri.v[k] = closestWedge(tri.v[k], to, d);
+                    }
+                }
+                vertexTriangles[to].push_back(t);
+            }
+
+            alive[from] = false;
+            quadrics[to] += quadrics[from];
+            areas[to] += areas[from];
+            vertexTriangles[from].clear();
+
+            auto& list = vertexTriangles[to];
+            list.erase(std::remove_if(list.begin(), list.end(),
+                [this](int t) { return !triangles[t].alive; }), list.end());
+
+            stamp[to]++;
+            gatherNeighbors(to, scratch);
+            std::vector<int> neighbors = scratch;
+            for (int p : neighbors)
+            {
+                pushCollapse(p, to);
+                pushCollapse(to, p);
+            }
+        }
+    };
+};
+
+#endif // MESH_SIMPLIFIER_H
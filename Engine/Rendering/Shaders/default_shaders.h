@@ -6,8 +6,166 @@
 #ifndef DEFAULT_SHADERS_H
 #define DEFAULT_SHADERS_H
 
+#include <string>
+
 namespace DefaultShaders
 {
+    /**
+     * Clustered lighting declarations (see ClusteredLighting)
+     * Not a shader on its own: withClusteredLighting() splices it in after
+     * the #version line. Lights [0, directionalLightCount) apply everywhere;
+     * clusterLightRange() gives the slice of _ClusterIndices holding the
+     * point and spot lights of the fragment's froxel.
+     */
+    const char* CLUSTERED_LIGHTING = R"(
+uniform samplerBuffer _ClusterLights;    // 4 texels per light
+uniform usamplerBuffer _ClusterGrid;     // First index and light count per cluster
+uniform usamplerBuffer _ClusterIndices;  // Light indices grouped by cluster
+uniform vec3 clusterDims;                // Froxel grid size
+uniform float clusterDepthScale;         // Slice = log(depth) * scale + bias
+uniform float clusterDepthBias;
+uniform int directionalLightCount;
+
+struct ClusterLight
+{
+    vec3 position;
+    int type;          // 0 directional, 1 point, 2 spot
+    vec3 direction;
+    float intensity;
+    vec3 color;
+    float range;
+    float cosOuter;    // Spot cone
+    float cosInner;
+};
+
+ClusterLight fetchClusterLight(int index)
+{
+    vec4 t0 = texelFetch(_ClusterLights, index * 4);
+    vec4 t1 = texelFetch(_ClusterLights, index * 4 + 1);
+    vec4 t2 = texelFetch(_ClusterLights, index * 4 + 2);
+    vec4 t3 = texelFetch(_ClusterLights, index * 4 + 3);
+    ClusterLight light;
+    light.position = t0.xyz;
+    light.type = int(t0.w);
+    light.direction = t1.xyz;
+    light.intensity = t1.w;
+    light.color = t2.rgb;
+    light.range = t2.w;
+    light.cosOuter = t3.x;
+    light.cosInner = t3.y;
+    return light;
+}
+
+// First index into _ClusterIndices and number of local lights at worldPos
+uvec2 clusterLightRange(vec3 worldPos, mat4 viewMatrix, mat4 projectionMatrix)
+{
+    vec4 viewPos = viewMatrix * vec4(worldPos, 1.0);
+    vec4 clipPos = projectionMatrix * viewPos;
+    vec2 ndc = clipPos.xy / clipPos.w;
+    ivec3 dims = ivec3(clusterDims);
+    ivec2 tile = clamp(ivec2((ndc * 0.5 + 0.5) * clusterDims.xy), ivec2(0), dims.xy - 1);
+    int slice = clamp(int(log(max(-viewPos.z, 1e-4)) * clusterDepthScale + clusterDepthBias), 0, dims.z - 1);
+    return texelFetch(_ClusterGrid, (slice * dims.y + tile.y) * dims.x + tile.x).xy;
+}
+
+int clusterLightIndex(uint i)
+{
+    return int(texelFetch(_ClusterIndices, int(i)).r);
+}
+
+// Direction to the light (L) and its falloff at worldPos: distance
+// attenuation windowed to zero at the range, times the spot cone
+float clusterLightAttenuation(ClusterLight light, vec3 worldPos, out vec3 L)
+{
+    if (light.type == 0)
+    {
+        L = normalize(-light.direction);
+        return 1.0;
+    }
+
+    vec3 toLight = light.position - worldPos;
+    float distance = length(toLight);
+    L = toLight / max(distance, 1e-4);
+
+    float attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * distance * distance);
+    float fade = clamp(1.0 - pow(distance / light.range, 4.0), 0.0, 1.0);
+    attenuation *= fade * fade;
+    if (light.type == 2)
+        attenuation *= smoothstep(light.cosOuter, light.cosInner, dot(-L, light.direction));
+    return attenuation;
+}
+)";
+
+    /**
+     * Cascaded directional shadow declarations (see CascadedShadowMaps)
+     * Not a shader on its own: withLighting() splices it in after the
+     * #version line. directionalShadow() returns how lit a fragment is by
+     * the first directional light (1 = unshadowed), using a normal-offset
+     * lookup and 3x3 PCF in the fragment's cascade.
+     */
+    const char* SHADOWS = R"(
+uniform sampler2DArrayShadow _ShadowMap;  // One layer per cascade
+uniform mat4 shadowMatrices[4];           // World -> light clip space
+uniform float shadowSplits[4];            // Far view depth of each cascade
+uniform float shadowTexelSizes[4];        // World units per texel
+uniform int shadowCascadeCount;           // 0 = no shadows
+uniform float shadowStrength = 1.0;       // Per draw (0 = doesn't receive)
+
+float directionalShadow(vec3 worldPos, vec3 normal, float viewDepth)
+{
+    if (shadowCascadeCount == 0 || shadowStrength <= 0.0 || viewDepth > shadowSplits[shadowCascadeCount - 1])
+        return 1.0;
+
+    int cascade = 0;
+    while (cascade < shadowCascadeCount - 1 && viewDepth > shadowSplits[cascade])
+        cascade++;
+
+    // Push the lookup off the surface by about a texel against acne
+    vec3 offsetPos = worldPos + normal * shadowTexelSizes[cascade] * 1.5;
+    vec4 clip = shadowMatrices[cascade] * vec4(offsetPos, 1.0);
+    vec3 coord = clip.xyz * 0.5 + 0.5;
+
+    float texel = 1.0 / float(textureSize(_ShadowMap, 0).x);
+    float lit = 0.0;
+    for (int y = -1; y <= 1; y++)
+        for (int x = -1; x <= 1; x++)
+            lit += texture(_ShadowMap, vec4(coord.xy + vec2(x, y) * texel, float(cascade), coord.z));
+    return mix(1.0, lit / 9.0, shadowStrength);
+}
+)";
+
+    /**
+     * Insert a declarations chunk after the #version line of a shader
+     */
+    inline std::string insertAfterVersion(const std::string& source, const char* chunk)
+    {
+        std::string result(source);
+        size_t version = result.find("#version");
+        size_t lineEnd = version == std::string::npos ? 0 : result.find('\n', version);
+        if (lineEnd == std::string::npos)
+            lineEnd = result.size();
+        else if (version != std::string::npos)
+            lineEnd++;
+        result.insert(lineEnd, chunk);
+        return result;
+    }
+
+    /**
+     * Insert CLUSTERED_LIGHTING after the #version line of a shader
+     */
+    inline std::string withClusteredLighting(const char* source)
+    {
+        return insertAfterVersion(source, CLUSTERED_LIGHTING);
+    }
+
+    /**
+     * Insert CLUSTERED_LIGHTING and SHADOWS after the #version line of a shader
+     */
+    inline std::string withLighting(const char* source)
+    {
+        return insertAfterVersion(withClusteredLighting(source), SHADOWS);
+    }
+
     /**
      * Optimized Blinn-Phong Vertex Shader with UBOs
      * Supports packed vertex format and uniform buffers
@@ -82,7 +240,9 @@ void main()
 
     /**
      * Optimized Blinn-Phong Fragment Shader with UBOs
-     * Uses uniform buffers for light data
+     * Directional lights plus the clustered point/spot lights of each
+     * fragment, the first directional light shadowed; compile through
+     * withLighting()
      */
     const char* BLINN_PHONG_FRAGMENT = R"(
 #version 330 core
@@ -96,23 +256,6 @@ in vec4 VertexColor;
 // Output color
 out vec4 FragColor;
 
-// Light structure (std140 layout)
-struct Light {
-    vec3 position;
-    int type;
-    vec3 direction;
-    float intensity;
-    vec3 color;
-    float _pad0;
-};
-
-// Lights UBO (shared across all draws)
-layout (std140) uniform LightData
-{
-    Light lights[8];
-    int numLights;
-};
-
 // Camera UBO (for view position)
 layout (std140) uniform CameraData
 {
@@ -127,6 +270,24 @@ const float ambientStrength = 0.1;
 const float specularStrength = 0.5;
 const float shininess = 32.0;
 
+vec3 diffuse = vec3(0.0);
+vec3 specular = vec3(0.0);
+
+void addLight(ClusterLight light, vec3 norm, vec3 viewDir, float shadow)
+{
+    vec3 lightDir;
+    float attenuation = clusterLightAttenuation(light, FragPos, lightDir);
+    
+    // Diffuse lighting (Lambert's cosine law)
+    float diff = max(dot(norm, lightDir), 0.0);
+    diffuse += light.color * light.intensity * diff * attenuation * shadow * VertexColor.rgb;
+    
+    // Specular lighting (Blinn-Phong)
+    vec3 halfDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfDir), 0.0), shininess);
+    specular += light.color * light.intensity * spec * attenuation * shadow * specularStrength;
+}
+
 void main()
 {
     vec3 norm = normalize(Normal);
@@ -135,39 +296,18 @@ void main()
     // Ambient lighting
     vec3 ambient = ambientStrength * VertexColor.rgb;
     
-    // Accumulate diffuse and specular from all lights
-    vec3 diffuse = vec3(0.0);
-    vec3 specular = vec3(0.0);
-    
-    for (int i = 0; i < numLights && i < 8; i++)
+    // Directional lights reach every fragment; local lights come from the cluster
+    // Only the first directional light casts shadows
+    for (int i = 0; i < directionalLightCount; i++)
     {
-        vec3 lightDir;
-        float attenuation = 1.0;
-        
-        if (lights[i].type == 0) // Directional light
-        {
-            lightDir = normalize(-lights[i].direction);
-        }
-        else // Point light
-        {
-            vec3 toLight = lights[i].position - FragPos;
-            float distance = length(toLight);
-            lightDir = normalize(toLight);
-            
-            // Attenuation: 1 / (constant + linear*d + quadratic*d^2)
-            attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * distance * distance);
-        }
-        
-        // Diffuse lighting (Lambert's cosine law)
-        float diff = max(dot(norm, lightDir), 0.0);
-        diffuse += lights[i].color * lights[i].intensity * diff * attenuation * VertexColor.rgb;
-        
-        // Specular lighting (Blinn-Phong)
-        vec3 halfDir = normalize(lightDir + viewDir);
-        float spec = pow(max(dot(norm, halfDir), 0.0), shininess);
-        specular += lights[i].color * lights[i].intensity * spec * attenuation * specularStrength;
+        float shadow = i == 0 ? directionalShadow(FragPos, norm, -(view * vec4(FragPos, 1.0)).z) : 1.0;
+        addLight(fetchClusterLight(i), norm, viewDir, shadow);
     }
     
+    uvec2 cluster = clusterLightRange(FragPos, view, projection);
+    for (uint i = 0u; i < cluster.y; i++)
+        addLight(fetchClusterLight(clusterLightIndex(cluster.x + i)), norm, viewDir, 1.0);
+    
     // Combine all lighting components
     vec3 result = ambient + diffuse + specular;
     
@@ -238,6 +378,39 @@ void main()
 {
     FragColor = vec4(wireframeColor, 1.0);
 }
+)";
+
+    /**
+     * Depth-Only Vertex Shader
+     * Reads only the position attribute (full vertex or position-only stream).
+     * positionScale/positionOffset undo Snorm16 quantization (identity otherwise).
+     */
+    const char* DEPTH_ONLY_VERTEX = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 depthViewProjection;
+uniform mat4 model;
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+
+void main()
+{
+    vec3 localPos = positionOffset + aPos * positionScale;
+    gl_Position = depthViewProjection * model * vec4(localPos, 1.0);
+}
+)";
+
+    /**
+     * Depth-Only Fragment Shader
+     * No color output - depth is written by fixed function
+     */
+    const char* DEPTH_ONLY_FRAGMENT = R"(
+#version 330 core
+
+void main()
+{
+}
 )";
 }
 
@@ -6,21 +6,18 @@
 #ifndef SHADER_H
 #define SHADER_H
 
-#ifdef __APPLE__
-#define GL_SILENCE_DEPRECATION
-#include <OpenGL/gl3.h>
-#else
-#include <GL/glew.h>
-#endif
+#include "../Core/gl_dispatch.h"
 
 #include "../../Math/vec3.h"
 #include "../../Math/mat4.h"
 #include "../color.h"
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <unordered_map>
+#include <vector>
 
 /**
  * @class Shader
@@ -34,6 +31,8 @@ class Shader
 private:
     GLuint programID;
     std::unordered_map<std::string, GLint> uniformCache;
+    std::unordered_map<std::string, int> samplerUnits;  // Sampler uniform -> texture unit
+    std::vector<std::string> activeSamplers;             // Sampler uniforms found at link time
     bool compiled;
 
     /**
@@ -44,17 +43,17 @@ private:
      */
     GLuint compileShader(GLenum type, const char* source)
     {
-        GLuint shader = glCreateShader(type);
-        glShaderSource(shader, 1, &source, nullptr);
-        glCompileShader(shader);
+        GLuint shader = GL::CreateShader(type);
+        GL::ShaderSource(shader, 1, &source, nullptr);
+        GL::CompileShader(shader);
 
         // Check compilation status
         GLint success;
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        GL::GetShaderiv(shader, GL_COMPILE_STATUS, &success);
         if (!success)
         {
             char infoLog[512];
-            glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+            GL::GetShaderInfoLog(shader, 512, nullptr, infoLog);
             std::cerr << "ERROR: Shader compilation failed (" 
                       << (type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT") 
                       << ")\n" << infoLog << std::endl;
@@ -64,6 +63,49 @@ private:
         return shader;
     }
 
+    /**
+     * Whether a uniform type is a sampler (takes a texture unit)
+     */
+    static bool isSamplerType(GLenum type)
+    {
+        switch (type)
+        {
+            case GL_SAMPLER_2D:
+            case GL_SAMPLER_3D:
+            case GL_SAMPLER_CUBE:
+            case GL_SAMPLER_2D_SHADOW:
+            case GL_SAMPLER_2D_ARRAY:
+            case GL_SAMPLER_2D_ARRAY_SHADOW:
+            case GL_SAMPLER_BUFFER:
+            case GL_INT_SAMPLER_BUFFER:
+            case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * Record the program's active sampler uniforms so each gets its own unit
+     * (a sampler2D and a sampler2DArray must never share one)
+     */
+    void findActiveSamplers()
+    {
+        activeSamplers.clear();
+        GLint uniformCount = 0;
+        GL::GetProgramiv(programID, GL_ACTIVE_UNIFORMS, &uniformCount);
+        for (GLint i = 0; i < uniformCount; i++)
+        {
+            char uniformName[256];
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            GL::GetActiveUniform(programID, static_cast<GLuint>(i), sizeof(uniformName), &length, &size, &type, uniformName);
+            if (length > 0 && isSamplerType(type))
+                activeSamplers.emplace_back(uniformName, length);
+        }
+    }
+
     /**
      * Get uniform location with caching (avoids string hashing)
      * @param name Uniform variable name in shader
@@ -75,7 +117,7 @@ private:
         if (it != uniformCache.end())
             return it->second;
         
-        GLint location = glGetUniformLocation(programID, name.c_str());
+        GLint location = GL::GetUniformLocation(programID, name.c_str());
         // Cache even -1 locations to avoid repeated lookups
         uniformCache[name] = location;
         return location;
@@ -91,7 +133,7 @@ public:
     {
         if (programID != 0)
         {
-            glDeleteProgram(programID);
+            GL::DeleteProgram(programID);
         }
     }
     
@@ -102,7 +144,7 @@ public:
      */
     GLuint getUniformBlockIndex(const std::string& name)
     {
-        return glGetUniformBlockIndex(programID, name.c_str());
+        return GL::GetUniformBlockIndex(programID, name.c_str());
     }
     
     /**
@@ -115,7 +157,7 @@ public:
         GLuint blockIndex = getUniformBlockIndex(blockName);
         if (blockIndex != GL_INVALID_INDEX)
         {
-            glUniformBlockBinding(programID, blockIndex, bindingPoint);
+            GL::UniformBlockBinding(programID, blockIndex, bindingPoint);
         }
     }
 
@@ -132,34 +174,35 @@ public:
 
         if (vertexShader == 0 || fragmentShader == 0)
         {
-            if (vertexShader) glDeleteShader(vertexShader);
-            if (fragmentShader) glDeleteShader(fragmentShader);
+            if (vertexShader) GL::DeleteShader(vertexShader);
+            if (fragmentShader) GL::DeleteShader(fragmentShader);
             return false;
         }
 
         // Link program
-        programID = glCreateProgram();
-        glAttachShader(programID, vertexShader);
-        glAttachShader(programID, fragmentShader);
-        glLinkProgram(programID);
+        programID = GL::CreateProgram();
+        GL::AttachShader(programID, vertexShader);
+        GL::AttachShader(programID, fragmentShader);
+        GL::LinkProgram(programID);
 
         // Check linking status
         GLint success;
-        glGetProgramiv(programID, GL_LINK_STATUS, &success);
+        GL::GetProgramiv(programID, GL_LINK_STATUS, &success);
         if (!success)
         {
             char infoLog[512];
-            glGetProgramInfoLog(programID, 512, nullptr, infoLog);
+            GL::GetProgramInfoLog(programID, 512, nullptr, infoLog);
             std::cerr << "ERROR: Shader program linking failed\n" << infoLog << std::endl;
-            glDeleteShader(vertexShader);
-            glDeleteShader(fragmentShader);
+            GL::DeleteShader(vertexShader);
+            GL::DeleteShader(fragmentShader);
             return false;
         }
 
         // Cleanup individual shaders (no longer needed after linking)
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+        GL::DeleteShader(vertexShader);
+        GL::DeleteShader(fragmentShader);
 
+        findActiveSamplers();
         compiled = true;
         return true;
     }
@@ -204,7 +247,7 @@ public:
     {
         if (compiled)
         {
-            glUseProgram(programID);
+            GL::UseProgram(programID);
         }
     }
 
@@ -224,42 +267,85 @@ public:
     {
         GLint location = getUniformLocation(name);
         if (location != -1)
-            glUniform1i(location, value);
+            GL::Uniform1i(location, value);
     }
 
     void setFloat(const std::string& name, float value)
     {
         GLint location = getUniformLocation(name);
         if (location != -1)
-            glUniform1f(location, value);
+            GL::Uniform1f(location, value);
     }
 
     void setBool(const std::string& name, bool value)
     {
         GLint location = getUniformLocation(name);
         if (location != -1)
-            glUniform1i(location, value ? 1 : 0);
+            GL::Uniform1i(location, value ? 1 : 0);
     }
 
     void setVec3(const std::string& name, const vec3& value)
     {
         GLint location = getUniformLocation(name);
         if (location != -1)
-            glUniform3f(location, value.x, value.y, value.z);
+            GL::Uniform3f(location, value.x, value.y, value.z);
     }
 
     void setVec3(const std::string& name, float x, float y, float z)
     {
         GLint location = getUniformLocation(name);
         if (location != -1)
-            glUniform3f(location, x, y, z);
+            GL::Uniform3f(location, x, y, z);
     }
 
     void setColor(const std::string& name, const color& value)
     {
         GLint location = getUniformLocation(name);
         if (location != -1)
-            glUniform3f(location, value.x, value.y, value.z);
+            GL::Uniform3f(location, value.x, value.y, value.z);
+    }
+
+    /**
+     * Whether the linked program has an active uniform of this name (cached)
+     */
+    bool hasUniform(const std::string& name)
+    {
+        return getUniformLocation(name) != -1;
+    }
+
+    /**
+     * Whether the linked program uses a sampler uniform of this name
+     */
+    bool hasSampler(const std::string& name) const
+    {
+        return std::find(activeSamplers.begin(), activeSamplers.end(), name) != activeSamplers.end();
+    }
+
+    /**
+     * Texture unit for a sampler uniform, fixed for the program's lifetime
+     * The first call assigns units to all active samplers and sets their
+     * uniforms (the shader must be in use); later calls are a lookup only.
+     */
+    int getSamplerUnit(const std::string& name)
+    {
+        if (samplerUnits.empty())
+        {
+            for (const auto& sampler : activeSamplers)
+            {
+                int unit = static_cast<int>(samplerUnits.size());
+                samplerUnits[sampler] = unit;
+                setInt(sampler, unit);
+            }
+        }
+
+        auto it = samplerUnits.find(name);
+        if (it != samplerUnits.end())
+            return it->second;
+
+        int unit = static_cast<int>(samplerUnits.size());
+        samplerUnits[name] = unit;
+        setInt(name, unit);
+        return unit;
     }
 
     void setMat4(const std::string& name, const mat4& matrix, bool transpose = true)
@@ -267,7 +353,7 @@ public:
         GLint location = getUniformLocation(name);
         if (location != -1) {
             // transpose=true because our matrices are row-major, OpenGL expects column-major
-            glUniformMatrix4fv(location, 1, transpose ? GL_TRUE : GL_FALSE, &matrix.m[0][0]);
+            GL::UniformMatrix4fv(location, 1, transpose ? GL_TRUE : GL_FALSE, &matrix.m[0][0]);
         }
     }
 };
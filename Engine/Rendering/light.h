@@ -7,6 +7,7 @@
 
 #include "../Math/vec3.h"
 #include "color.h"
+#include <cstdint>
 
 class Light
 {
@@ -81,4 +82,53 @@ public:
     }
 };
 
+/**
+ * @struct LightSet
+ * @brief Lights affecting one object, as indices into the frame's light list
+ *
+ * Filled by Scene::getObjectLights and carried by each RenderCommand, so a
+ * backend only shades an object with its most influential lights. The
+ * default set means "all of the frame's lights".
+ */
+struct LightSet
+{
+    static constexpr int MAX_LIGHTS = 8;
+
+    int count;                      // -1: all frame lights
+    uint16_t indices[MAX_LIGHTS];
+
+    LightSet() : count(-1), indices{} {}
+
+    static LightSet none()
+    {
+        LightSet set;
+        set.count = 0;
+        return set;
+    }
+
+    bool isAll() const { return count < 0; }
+
+    void add(uint16_t index)
+    {
+        if (count < 0)
+            count = 0;
+        if (count < MAX_LIGHTS)
+            indices[count++] = index;
+    }
+
+    bool operator==(const LightSet& other) const
+    {
+        if (count != other.count)
+            return false;
+        for (int i = 0; i < count; i++)
+        {
+            if (indices[i] != other.indices[i])
+                return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const LightSet& other) const { return !(*this == other); }
+};
+
 #endif //LIGHT_H
@@ -5,15 +5,12 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
-#ifdef __APPLE__
-#define GL_SILENCE_DEPRECATION
-#include <OpenGL/gl3.h>
-#else
-#include <GL/glew.h>
-#endif
+#include "Core/gl_dispatch.h"
 
 #include <string>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
 
 /**
  * @class Texture
@@ -21,14 +18,19 @@
  * 
  * Loads and manages 2D textures for use in materials.
  * Supports various formats and filtering modes.
+ * 
+ * Filter/wrap are baked into the texture for plain bind(); the renderer
+ * binds a shared sampler object (SamplerCache) that overrides them.
  */
 class Texture
 {
 private:
     GLuint textureID;
+    GLenum target;      // GL_TEXTURE_2D, or GL_TEXTURE_2D_ARRAY for layered textures
     int width;
     int height;
     int channels;
+    int layers;
     bool loaded;
 
 public:
@@ -47,8 +49,52 @@ public:
         Mirror
     };
 
+private:
+    FilterMode filterMode;  // Kept for the renderer's shared samplers
+    WrapMode wrapMode;
+
+    /**
+     * Bake filter/wrap into the bound texture (used by plain bind())
+     */
+    void setParameters(GLenum bindTarget)
+    {
+        // Set wrap mode
+        GLint wrap = GL_REPEAT;
+        switch (wrapMode)
+        {
+            case WrapMode::Repeat: wrap = GL_REPEAT; break;
+            case WrapMode::Clamp: wrap = GL_CLAMP_TO_EDGE; break;
+            case WrapMode::Mirror: wrap = GL_MIRRORED_REPEAT; break;
+        }
+        GL::TexParameteri(bindTarget, GL_TEXTURE_WRAP_S, wrap);
+        GL::TexParameteri(bindTarget, GL_TEXTURE_WRAP_T, wrap);
+
+        // Set filter mode
+        switch (filterMode)
+        {
+            case FilterMode::Nearest:
+                GL::TexParameteri(bindTarget, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                GL::TexParameteri(bindTarget, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                break;
+            case FilterMode::Linear:
+                GL::TexParameteri(bindTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                GL::TexParameteri(bindTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                break;
+            case FilterMode::Bilinear:
+                GL::TexParameteri(bindTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+                GL::TexParameteri(bindTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                break;
+            case FilterMode::Trilinear:
+                GL::TexParameteri(bindTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                GL::TexParameteri(bindTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                break;
+        }
+    }
+
+public:
     Texture()
-        : textureID(0), width(0), height(0), channels(0), loaded(false)
+        : textureID(0), target(GL_TEXTURE_2D), width(0), height(0), channels(0), layers(1), loaded(false),
+          filterMode(FilterMode::Bilinear), wrapMode(WrapMode::Repeat)
     {
     }
 
@@ -56,7 +102,7 @@ public:
     {
         if (textureID != 0)
         {
-            glDeleteTextures(1, &textureID);
+            GL::DeleteTextures(1, &textureID);
         }
     }
 
@@ -76,53 +122,73 @@ public:
         width = w;
         height = h;
         channels = ch;
+        filterMode = filter;
+        wrapMode = wrap;
 
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GL::GenTextures(1, &textureID);
+        GL::BindTexture(GL_TEXTURE_2D, textureID);
+        setParameters(GL_TEXTURE_2D);
 
-        // Set wrap mode
-        GLenum wrapMode = GL_REPEAT;
-        switch (wrap)
+        // Upload texture data
+        GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
+        GL::TexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        
+        // Generate mipmaps if using mipmap filtering
+        if (filter == FilterMode::Bilinear || filter == FilterMode::Trilinear)
         {
-            case WrapMode::Repeat: wrapMode = GL_REPEAT; break;
-            case WrapMode::Clamp: wrapMode = GL_CLAMP_TO_EDGE; break;
-            case WrapMode::Mirror: wrapMode = GL_MIRRORED_REPEAT; break;
+            GL::GenerateMipmap(GL_TEXTURE_2D);
         }
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
 
-        // Set filter mode
-        switch (filter)
+        GL::BindTexture(GL_TEXTURE_2D, 0);
+        loaded = true;
+        return true;
+    }
+
+    /**
+     * Create a 2D array texture (GL_TEXTURE_2D_ARRAY) from same-sized layers
+     * @param layerData One pointer per layer, each w * h * ch bytes (nullptr = leave undefined)
+     * @param w Layer width in pixels
+     * @param h Layer height in pixels
+     * @param ch Number of channels (3 for RGB, 4 for RGBA)
+     * @param filter Filtering mode
+     * @param wrap Wrap mode
+     * 
+     * Shaders sample it as sampler2DArray with vec3(uv, layer), so
+     * materials that differ only in the layer can share all GL state.
+     */
+    bool createArray(const std::vector<const unsigned char*>& layerData, int w, int h, int ch,
+                     FilterMode filter = FilterMode::Bilinear,
+                     WrapMode wrap = WrapMode::Repeat)
+    {
+        if (layerData.empty())
+            return false;
+
+        target = GL_TEXTURE_2D_ARRAY;
+        width = w;
+        height = h;
+        channels = ch;
+        layers = static_cast<int>(layerData.size());
+        filterMode = filter;
+        wrapMode = wrap;
+
+        GL::GenTextures(1, &textureID);
+        GL::BindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+        setParameters(GL_TEXTURE_2D_ARRAY);
+
+        GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
+        GL::TexImage3D(GL_TEXTURE_2D_ARRAY, 0, format, width, height, layers, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        for (int layer = 0; layer < layers; layer++)
         {
-            case FilterMode::Nearest:
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-                break;
-            case FilterMode::Linear:
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-                break;
-            case FilterMode::Bilinear:
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-                break;
-            case FilterMode::Trilinear:
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-                break;
+            if (layerData[layer])
+                GL::TexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, format, GL_UNSIGNED_BYTE, layerData[layer]);
         }
 
-        // Upload texture data
-        GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        
-        // Generate mipmaps if using mipmap filtering
         if (filter == FilterMode::Bilinear || filter == FilterMode::Trilinear)
         {
-            glGenerateMipmap(GL_TEXTURE_2D);
+            GL::GenerateMipmap(GL_TEXTURE_2D_ARRAY);
         }
 
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GL::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
         loaded = true;
         return true;
     }
@@ -151,8 +217,8 @@ public:
      */
     void bind(unsigned int unit = 0) const
     {
-        glActiveTexture(GL_TEXTURE0 + unit);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GL::ActiveTexture(GL_TEXTURE0 + unit);
+        GL::BindTexture(target, textureID);
     }
 
     /**
@@ -160,14 +226,98 @@ public:
      */
     void unbind() const
     {
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GL::BindTexture(target, 0);
     }
 
     GLuint getID() const { return textureID; }
+    GLenum getTarget() const { return target; }
+    bool isArray() const { return target == GL_TEXTURE_2D_ARRAY; }
+    int getLayerCount() const { return layers; }
     bool isLoaded() const { return loaded; }
     int getWidth() const { return width; }
     int getHeight() const { return height; }
     int getChannels() const { return channels; }
+    FilterMode getFilterMode() const { return filterMode; }
+    WrapMode getWrapMode() const { return wrapMode; }
+};
+
+/**
+ * @class SamplerCache
+ * @brief GL sampler objects shared by every texture with the same filter and wrap
+ * 
+ * One sampler per (FilterMode, WrapMode) pair, created on first use.
+ * Must be used on the thread that owns the GL context.
+ */
+class SamplerCache
+{
+private:
+    std::unordered_map<int, GLuint> samplers;
+
+    static int key(Texture::FilterMode filter, Texture::WrapMode wrap)
+    {
+        return static_cast<int>(filter) * 8 + static_cast<int>(wrap);
+    }
+
+public:
+    ~SamplerCache()
+    {
+        clear();
+    }
+
+    /**
+     * Get (or create) the sampler for a filter/wrap combination
+     */
+    GLuint get(Texture::FilterMode filter, Texture::WrapMode wrap)
+    {
+        auto it = samplers.find(key(filter, wrap));
+        if (it != samplers.end())
+            return it->second;
+
+        GLuint sampler = 0;
+        GL::GenSamplers(1, &sampler);
+
+        GLint wrapMode = GL_REPEAT;
+        switch (wrap)
+        {
+            case Texture::WrapMode::Repeat: wrapMode = GL_REPEAT; break;
+            case Texture::WrapMode::Clamp: wrapMode = GL_CLAMP_TO_EDGE; break;
+            case Texture::WrapMode::Mirror: wrapMode = GL_MIRRORED_REPEAT; break;
+        }
+        GL::SamplerParameteri(sampler, GL_TEXTURE_WRAP_S, wrapMode);
+        GL::SamplerParameteri(sampler, GL_TEXTURE_WRAP_T, wrapMode);
+
+        GLint minFilter = GL_LINEAR;
+        GLint magFilter = GL_LINEAR;
+        switch (filter)
+        {
+            case Texture::FilterMode::Nearest: minFilter = GL_NEAREST; magFilter = GL_NEAREST; break;
+            case Texture::FilterMode::Linear: minFilter = GL_LINEAR; break;
+            case Texture::FilterMode::Bilinear: minFilter = GL_LINEAR_MIPMAP_NEAREST; break;
+            case Texture::FilterMode::Trilinear: minFilter = GL_LINEAR_MIPMAP_LINEAR; break;
+        }
+        GL::SamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, minFilter);
+        GL::SamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, magFilter);
+
+        samplers[key(filter, wrap)] = sampler;
+        return sampler;
+    }
+
+    GLuint get(const Texture& texture)
+    {
+        return get(texture.getFilterMode(), texture.getWrapMode());
+    }
+
+    /**
+     * Delete all sampler objects
+     */
+    void clear()
+    {
+        for (auto& pair : samplers)
+            GL::DeleteSamplers(1, &pair.second);
+        samplers.clear();
+    }
+
+    size_t size() const { return samplers.size(); }
 };
 
 #endif //TEXTURE_H
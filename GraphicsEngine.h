@@ -17,33 +17,57 @@
 #include "Engine/Core/Components/cameraComponent.h"
 #include "Engine/Core/Components/meshFilter.h"
 #include "Engine/Core/Components/meshRenderer.h"
+#include "Engine/Core/Components/lightComponent.h"
 #include "Engine/Core/gameObject.h"
 #include "Engine/Core/scene.h"
 #include "Engine/Core/Systems/sceneSerializer.h"
 #include "Engine/Core/gameEngine.h"
 #include "Engine/Core/Systems/input.h"
+#include "Engine/Core/Systems/jobSystem.h"
+#include "Engine/Core/Systems/dynamicBVH.h"
+#include "Engine/Core/Systems/sceneView.h"
+#include "Engine/Core/Systems/shadowView.h"
+#include "Engine/Core/Systems/staticBatcher.h"
+#include "Engine/Core/Systems/retainedDrawList.h"
 
 // Math
 #include "Engine/Math/vec2.h"
 #include "Engine/Math/vec3.h"
 #include "Engine/Math/mat4.h"
+#include "Engine/Math/simd.h"
+#include "Engine/Math/bounds.h"
+#include "Engine/Math/frustum.h"
 
 // Rendering
 #include "Engine/Rendering/color.h"
 #include "Engine/Rendering/Primitives/mesh.h"
+#include "Engine/Rendering/Primitives/meshBVH.h"
+#include "Engine/Rendering/Primitives/meshSimplifier.h"
 #include "Engine/Rendering/camera.h"
 #include "Engine/Rendering/light.h"
 #include "Engine/Rendering/Core/framebuffer.h"
 #include "Engine/Rendering/texture.h"
 #include "Engine/Rendering/Loaders/textureLoader.h"
+#include "Engine/Rendering/Loaders/textureArrayPacker.h"
 #include "Engine/Rendering/Materials/material.h"
+#include "Engine/Rendering/Materials/materialPropertyBlock.h"
 #include "Engine/Rendering/Materials/builtin_materials.h"
 #include "Engine/Rendering/Materials/materialSerializer.h"
 #include "Engine/Rendering/Loaders/modelLoader.h"
 #include "Engine/Rendering/Core/rasterizer.h"
+#include "Engine/Rendering/Core/occlusion_culler.h"
+#include "Engine/Rendering/Core/render_backend.h"
+#include "Engine/Rendering/Core/shadow_frame.h"
+#include "Engine/Rendering/Core/cascaded_shadow_maps.h"
+#include "Engine/Rendering/Core/software_renderer.h"
 #include "Engine/Rendering/Core/window.h"
+#include "Engine/Rendering/Core/gl_dispatch.h"
+#include "Engine/Rendering/Core/gl_recorder.h"
 #include "Engine/Rendering/Core/opengl_window.h"
 #include "Engine/Rendering/Core/opengl_renderer.h"
+#include "Engine/Rendering/Core/render_target.h"
+#include "Engine/Rendering/Core/frame_capture.h"
+#include "Engine/Rendering/Core/render_thread.h"
 #include "Engine/Rendering/Shaders/shader.h"
 #include "Engine/Rendering/Shaders/default_shaders.h"
 
@@ -83,6 +107,51 @@ namespace Engine
         engine.run();
     }
 
+    /**
+     * @brief Simulate one frame and hand its packet to the render thread
+     * @return false if the scene has no camera (the frame is only cleared)
+     */
+    inline bool renderFrame(Scene& scene, SceneView& sceneView, ShadowView& shadowView,
+                            RenderThread& renderThread, int width, int height, float deltaTime)
+    {
+        // Update scene
+        scene.update(deltaTime);
+        scene.lateUpdate(deltaTime);
+        scene.updateSpatialIndex();
+
+        // Build this frame's packet for the render thread
+        FramePacket& packet = renderThread.beginPacket();
+        packet.clearColor = color(0.1f, 0.1f, 0.15f);
+        packet.viewportWidth = width;
+        packet.viewportHeight = height;
+
+        if (!sceneView.gather(scene)) {
+            // No camera found, just clear and present
+            renderThread.submitPacket();
+            return false;
+        }
+        const Camera& camera = *sceneView.getCamera();
+        packet.hasCamera = true;
+        packet.camera = camera;
+        packet.lights = sceneView.getLights();
+
+        // Record draw commands for the visible objects across worker threads
+        // (culling above already refreshed the lazy transform and bounds caches)
+        packet.recordDraws(sceneView.getVisibleCount(), [&](size_t i, FramePacket::DrawItem& draw) {
+            auto* meshRenderer = sceneView.getVisible(i);
+            draw.mesh = meshRenderer->selectLOD(camera);
+            draw.material = renderThread.snapshotMaterial(meshRenderer->getMaterial());
+            draw.modelMatrix = meshRenderer->gameObject->transform.getModelMatrix();
+            draw.properties = meshRenderer->getPropertyBlock();
+            draw.lights = scene.getObjectLights(*meshRenderer);
+            draw.receiveShadows = meshRenderer->getReceiveShadows();
+        });
+        if (shadowView.gather(scene, camera, packet.lights))
+            packet.shadows = shadowView.getFrame();
+        renderThread.submitPacket();
+        return true;
+    }
+
     /**
      * @brief Run with OpenGL hardware rendering
      * @param scene Scene to run
@@ -90,9 +159,16 @@ namespace Engine
      * @param height Window height
      * @param title Window title
      * @param targetFPS Target FPS (0 = unlimited)
+     * @param useRenderThread Issue GL calls from a dedicated render thread
+     *        so simulation of the next frame overlaps drawing this one
+     * 
+     * Setup (onOpenGLReady, awake, start) runs with the context on the
+     * calling thread. Afterwards GL resources must be created through
+     * runOnRenderThread().
      */
     inline void runOpenGL(Scene& scene, int width = 1280, int height = 720, 
-                         const std::string& title = "Graphics Engine", int targetFPS = 60)
+                         const std::string& title = "Graphics Engine", int targetFPS = 60,
+                         bool useRenderThread = true)
     {
         OpenGLWindow window(width, height, title);
         if (!window.isOpen) {
@@ -113,6 +189,15 @@ namespace Engine
         scene.awake();
         scene.start();
 
+        // Camera, lights and culling, shared with the software renderer
+        SceneView sceneView;
+        ShadowView shadowView;  // Cascades of the main directional light
+
+        // From here on GL calls happen on the render thread (or inline if disabled)
+        RenderThread renderThread(window, renderer);
+        if (useRenderThread)
+            renderThread.start();
+
         // Main loop
         Uint32 lastTime = SDL_GetTicks();
         int frameCount = 0;
@@ -138,52 +223,9 @@ namespace Engine
             // Update input AFTER polling events
             Input::getInstance().update();
 
-            // Update scene
-            scene.update(deltaTime);
-            scene.lateUpdate(deltaTime);
-
-            // Render
-            renderer.clear(0.1f, 0.1f, 0.15f);
-
-            // Find main camera
-            Camera* camera = nullptr;
-            for (auto* obj : scene.getAllGameObjects()) {
-                if (auto* camComp = obj->getComponent<CameraComponent>()) {
-                    camera = camComp->getCamera();
-                    break;
-                }
-            }
-
-            if (!camera) {
-                // No camera found, skip rendering
-                window.swapBuffers();
+            // Simulate and hand the frame to the render thread
+            if (!renderFrame(scene, sceneView, shadowView, renderThread, window.width, window.height, deltaTime))
                 continue;
-            }
-
-            // Collect lights (TODO: LightComponent)
-            std::vector<Light> lights;
-            lights.push_back(Light::directional(vec3(-1, -1, -1), color(1, 1, 1), 0.8f));
-
-            // Render all mesh objects
-            for (auto* obj : scene.getAllGameObjects()) {
-                auto meshRenderer = obj->getComponent<MeshRenderer>();
-                auto meshFilter = obj->getComponent<MeshFilter>();
-                
-                if (meshRenderer && meshFilter && meshRenderer->canRender()) {
-                    mat4 transform = obj->transform.getModelMatrix();
-                    if (camera) {
-                        renderer.drawMesh(
-                            *meshFilter->getMeshPtr(),
-                            meshRenderer->getMaterialPtr(),
-                            transform,
-                            *camera,
-                            lights
-                        );
-                    }
-                }
-            }
-
-            window.swapBuffers();
 
             // FPS counter
             frameCount++;
@@ -197,9 +239,105 @@ namespace Engine
             }
         }
 
-        // Cleanup
+        // Cleanup (the context is back on this thread after stop)
         // Note: Scene cleanup is automatic via destructors
+        renderThread.stop();
+        renderer.cleanup();
+    }
+
+    /**
+     * @brief Render a scene offscreen and read every frame back
+     * @param scene Scene to run
+     * @param width Image width
+     * @param height Image height
+     * @param frameCount Frames to simulate and render
+     * @param onFrame Called with each frame's pixels in order, on the thread
+     *        that owns the context (the render thread while it runs)
+     * @param deltaTime Fixed simulation step
+     * @param useRenderThread Issue GL calls from a dedicated render thread
+     * @return false if no context, renderer or render target could be created
+     * 
+     * The window is hidden and only provides the context: frames are drawn
+     * into a RenderTarget and read back through FrameCapture, whose pixel
+     * buffer ring reads frame N while N+2 renders. See OpenGLWindow for
+     * running without a display (Xvfb, SDL_VIDEODRIVER=offscreen, llvmpipe).
+     * 
+     * Example:
+     * @code
+     * Engine::renderOffscreen(scene, 640, 360, 120, [](const CapturedFrame& frame) {
+     *     frame.saveToPPM("frame_" + std::to_string(frame.frameIndex) + ".ppm");
+     * });
+     * @endcode
+     */
+    inline bool renderOffscreen(Scene& scene, int width, int height, int frameCount,
+                                std::function<void(const CapturedFrame&)> onFrame, float deltaTime = 1.0f / 60.0f,
+                                bool useRenderThread = true)
+    {
+        OpenGLWindow window(width, height, "Graphics Engine (offscreen)", false);
+        if (!window.isOpen) {
+            std::cerr << "Failed to create OpenGL context!" << std::endl;
+            return false;
+        }
+
+        OpenGLRenderer renderer;
+        if (!renderer.initialize()) {
+            std::cerr << "Failed to initialize renderer!" << std::endl;
+            return false;
+        }
+
+        RenderTarget target;
+        if (!target.create(width, height)) {
+            std::cerr << "Failed to create render target!" << std::endl;
+            return false;
+        }
+        FrameCapture capture;
+        capture.initialize();
+        capture.setCallback(std::move(onFrame));
+
+        scene._invokeOpenGLReady();
+        scene.awake();
+        scene.start();
+
+        SceneView sceneView;
+        ShadowView shadowView;
+
+        RenderThread renderThread(window, renderer);
+        renderThread.setRenderTarget(&target);
+        renderThread.setFrameCapture(&capture);
+        if (useRenderThread)
+            renderThread.start();
+
+        for (int frame = 0; frame < frameCount; frame++) {
+            if (!window.pollEvents()) break;
+            Input::getInstance().update();
+            renderFrame(scene, sceneView, shadowView, renderThread, width, height, deltaTime);
+        }
+
+        // The context is back on this thread after stop; deliver what's still in flight
+        renderThread.stop();
+        capture.finish();
+        capture.cleanup();
+        target.destroy();
         renderer.cleanup();
+        return true;
+    }
+
+    /**
+     * @brief Run GL work (texture/shader creation) on the thread that owns the context
+     * @param command Work to run
+     * @param wait Block until it has run (needed if the caller uses the result)
+     * 
+     * Runs immediately when no render thread is active.
+     */
+    inline void runOnRenderThread(std::function<void()> command, bool wait = false)
+    {
+        RenderThread* renderThread = RenderThread::getActive();
+        if (!renderThread)
+            command();
+        else if (wait)
+            renderThread->invoke(std::move(command));
+        else
+            renderThread->enqueue(std::move(command));
     }
 }
 